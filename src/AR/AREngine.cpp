@@ -20,14 +20,14 @@
 
 std::vector<Direction*> AREngine::__get_directions(const std::vector<Expr::Var>& vars) {
     std::vector<Direction*> result(vars.size(), nullptr);
-    for (int i=0; i<vars.size(); i++) {
+    for (std::size_t i=0; i<vars.size(); i++) {
         result[i] = __get_direction(vars[i]);
     }
     return result;
 }
 std::vector<Length*> AREngine::__get_lengths(const std::vector<Expr::Var>& vars) {
     std::vector<Length*> result(vars.size(), nullptr);
-    for (int i=0; i<vars.size(); i++) {
+    for (std::size_t i=0; i<vars.size(); i++) {
         result[i] = __get_length(vars[i]);
     }
     return result;
@@ -99,11 +99,12 @@ void AREngine::add_eqratio(
 
 
 void AREngine::update_point_merger(Point* dest, Point* src, Predicate* pred) {
-    for (auto& [var, disp] : var_to_displacement) {
-        if (disp.p != src) continue;
-        disp.p = dest;
+    // Index-based, as new displacement variables may be appended during the loop
+    for (Expr::Var var = 1; var < (int)var_to_displacement.size(); var++) {
+        if (var_to_displacement[var].p != src) continue;
+        var_to_displacement[var].p = dest;
 
-        Expr::Var new_var = __get_var(disp);
+        Expr::Var new_var = __get_var(Displacement(var_to_displacement[var]));
         if (var == new_var) continue;
 
         LOG("AR: Point merger: Updating displacement variable " << var << " to " << new_var);
@@ -111,11 +112,12 @@ void AREngine::update_point_merger(Point* dest, Point* src, Predicate* pred) {
     }
 }
 void AREngine::update_line_merger(Line* dest, Line* src, Predicate* pred) {
-    for (auto& [var, disp] : var_to_displacement) {
-        if (disp.l != src) continue;
-        disp.l = dest;
+    // Index-based, as new displacement variables may be appended during the loop
+    for (Expr::Var var = 1; var < (int)var_to_displacement.size(); var++) {
+        if (var_to_displacement[var].l != src) continue;
+        var_to_displacement[var].l = dest;
 
-        Expr::Var new_var = __get_var(disp);
+        Expr::Var new_var = __get_var(Displacement(var_to_displacement[var]));
         if (var == new_var) continue;
 
         LOG("AR: Line merger: Updating displacement variable " << var << " to " << new_var);
@@ -311,21 +313,18 @@ void AREngine::derive(GeometricGraph& ggraph, DDEngine& dd, Profiler& profiler)
         while (f >= 180) f -= 180;
         if (NumUtils::is_close(f, 90)) {
             dd.insert_new_predicate(
-                std::make_unique<Predicate>(
-                    pred_t::PERP, std::vector<Node*>{d1, d2}, 
-                    std::move(why), pred_src::AR)
+                pred_t::PERP, {d1, d2}, 
+                std::move(why), pred_src::AR
             );
         } else if (NumUtils::is_close(f, 0) || NumUtils::is_close(f, 180)) {
             dd.insert_new_predicate(
-                std::make_unique<Predicate>(
-                    pred_t::PARA, std::vector<Node*>{d1, d2}, 
-                    std::move(why), pred_src::AR)
+                pred_t::PARA, {d1, d2}, 
+                std::move(why), pred_src::AR
             );
         } else {
             dd.insert_new_predicate(
-                std::make_unique<Predicate>(
-                    pred_t::CONSTANGLE, std::vector<Node*>{d1, d2}, f, 
-                    std::move(why), pred_src::AR)
+                pred_t::CONSTANGLE, {d1, d2}, f, 
+                std::move(why), pred_src::AR
             );
         }
     }
@@ -336,21 +335,18 @@ void AREngine::derive(GeometricGraph& ggraph, DDEngine& dd, Profiler& profiler)
         auto [d1, d2, d3, d4, why] = gen_eqangle();
         if (d1 == d2) {
             dd.insert_new_predicate(
-                std::make_unique<Predicate>(
-                    pred_t::PARA, std::vector<Node*>{d3, d4}, 
-                    std::move(why), pred_src::AR)
+                pred_t::PARA, {d3, d4}, 
+                std::move(why), pred_src::AR
             );
         } else if (d3 == d4) {
             dd.insert_new_predicate(
-                std::make_unique<Predicate>(
-                    pred_t::PARA, std::vector<Node*>{d1, d2}, 
-                    std::move(why), pred_src::AR)
+                pred_t::PARA, {d1, d2}, 
+                std::move(why), pred_src::AR
             );
         } else {
             dd.insert_new_predicate(
-                std::make_unique<Predicate>(
-                    pred_t::EQANGLE, std::vector<Node*>{d1, d2, d3, d4}, 
-                    std::move(why), pred_src::AR)
+                pred_t::EQANGLE, {d1, d2, d3, d4}, 
+                std::move(why), pred_src::AR
             );
         }
     }
@@ -360,9 +356,8 @@ void AREngine::derive(GeometricGraph& ggraph, DDEngine& dd, Profiler& profiler)
         angle_table_eqs++;
         auto [d1, d2, why] = gen_para();
         dd.insert_new_predicate(
-            std::make_unique<Predicate>(
-                pred_t::PARA, std::vector<Node*>{d1, d2}, 
-                std::move(why), pred_src::AR)
+            pred_t::PARA, {d1, d2}, 
+            std::move(why), pred_src::AR
         );
     }
 
@@ -379,9 +374,8 @@ void AREngine::derive(GeometricGraph& ggraph, DDEngine& dd, Profiler& profiler)
         ratio_table_eqs++;
         auto [l1, l2, why] = gen_cong_1();
         dd.insert_new_predicate(
-            std::make_unique<Predicate>(
-                pred_t::CONG, std::vector<Node*>{l1, l2}, 
-                std::move(why), pred_src::AR)
+            pred_t::CONG, {l1, l2}, 
+            std::move(why), pred_src::AR
         );
     }
 
@@ -390,9 +384,8 @@ void AREngine::derive(GeometricGraph& ggraph, DDEngine& dd, Profiler& profiler)
         ratio_table_eqs++;
         auto [l1, l2, f, why] = gen_const_ratio();
         dd.insert_new_predicate(
-            std::make_unique<Predicate>(
-                pred_t::CONSTRATIO, std::vector<Node*>{l1, l2}, f, 
-                std::move(why), pred_src::AR)
+            pred_t::CONSTRATIO, {l1, l2}, f, 
+            std::move(why), pred_src::AR
         );
     }
 
@@ -402,21 +395,18 @@ void AREngine::derive(GeometricGraph& ggraph, DDEngine& dd, Profiler& profiler)
         auto [l1, l2, l3, l4, why] = gen_eqratio();
         if (l1 == l2) {
             dd.insert_new_predicate(
-                std::make_unique<Predicate>(
-                    pred_t::CONG, std::vector<Node*>{l3, l4}, 
-                    std::move(why), pred_src::AR)
+                pred_t::CONG, {l3, l4}, 
+                std::move(why), pred_src::AR
             );
         } else if (l3 == l4) {
             dd.insert_new_predicate(
-                std::make_unique<Predicate>(
-                    pred_t::CONG, std::vector<Node*>{l1, l2}, 
-                    std::move(why), pred_src::AR)
+                pred_t::CONG, {l1, l2}, 
+                std::move(why), pred_src::AR
             );
         } else {
             dd.insert_new_predicate(
-                std::make_unique<Predicate>(
-                    pred_t::EQRATIO, std::vector<Node*>{l1, l2, l3, l4}, 
-                    std::move(why), pred_src::AR)
+                pred_t::EQRATIO, {l1, l2, l3, l4}, 
+                std::move(why), pred_src::AR
             );
         }
     }
@@ -434,9 +424,8 @@ void AREngine::derive(GeometricGraph& ggraph, DDEngine& dd, Profiler& profiler)
         displacement_table_eqs++;
         auto [p1, p2, p3, p4, why] = gen_cong_2();
         dd.insert_new_predicate(
-            std::make_unique<Predicate>(
-                pred_t::CONG, std::vector<Node*>{p1, p2, p3, p4}, 
-                std::move(why), pred_src::AR)
+            pred_t::CONG, {p1, p2, p3, p4}, 
+            std::move(why), pred_src::AR
         );
     }
 
@@ -457,7 +446,10 @@ void AREngine::reset_problem() {
     ratio_table.reset();
     displacement_table.reset();
 
-    var_to_direction.clear();
-    var_to_length.clear();
-    var_to_displacement.clear();
+    direction_to_var.clear();
+    length_to_var.clear();
+    displacement_to_var.clear();
+    var_to_direction = {nullptr};
+    var_to_length = {nullptr};
+    var_to_displacement = {{nullptr, nullptr}};
 }
\ No newline at end of file
@@ -48,7 +48,7 @@ class AREngine {
         Line* l;
         Point* p;
     };
-    inline constexpr std::string __get_disp_name(Displacement disp) { 
+    inline constexpr std::string __get_disp_name(const Displacement& disp) { 
         return "disp_" + disp.l->name + "_" + disp.p->name; 
     }
 public:
@@ -56,36 +56,42 @@ public:
     Table ratio_table;
     Table displacement_table;
 
-    std::map<Expr::Var, Direction*> var_to_direction;
-    std::map<Expr::Var, Length*> var_to_length;
-    std::map<Expr::Var, Displacement> var_to_displacement;
+    /* Variables are dense IDs local to each table, with `Expr::ONE` reserved for the table's
+    constant term. Node names are only used here, to look up the variable of a node. */
+    std::map<std::string, Expr::Var> direction_to_var;
+    std::map<std::string, Expr::Var> length_to_var;
+    std::map<std::string, Expr::Var> displacement_to_var;
+    std::vector<Direction*> var_to_direction = {nullptr};
+    std::vector<Length*> var_to_length = {nullptr};
+    std::vector<Displacement> var_to_displacement = {{nullptr, nullptr}};
 
-    AREngine() : angle_table(Constants::PI), ratio_table(Constants::ONE), displacement_table() {};
+    AREngine() : angle_table(true), ratio_table(), displacement_table() {};
 
     inline constexpr Expr::Var __get_var(Direction* d) {
-        return var_to_direction.insert({d->name, d}).first->first;
+        auto [it, inserted] = direction_to_var.try_emplace(d->name, var_to_direction.size());
+        if (inserted) var_to_direction.emplace_back(d);
+        return it->second;
     }
     inline constexpr Expr::Var __get_var(Length* l) {
-        return var_to_length.insert({l->name, l}).first->first;
+        auto [it, inserted] = length_to_var.try_emplace(l->name, var_to_length.size());
+        if (inserted) var_to_length.emplace_back(l);
+        return it->second;
     }
-    inline constexpr Expr::Var __get_var(Displacement&& disp) {
-        return var_to_displacement.insert({ __get_disp_name(disp), std::move(disp) }).first->first;
-    }
-    inline constexpr Expr::Var __get_var(Displacement& disp) {
-        return var_to_displacement.insert({ __get_disp_name(disp), disp }).first->first;
+    inline constexpr Expr::Var __get_var(const Displacement& disp) {
+        auto [it, inserted] = displacement_to_var.try_emplace(__get_disp_name(disp), var_to_displacement.size());
+        if (inserted) var_to_displacement.emplace_back(disp);
+        return it->second;
     }
     inline constexpr Direction* __get_direction(const Expr::Var& var) {
-        Direction* d = var_to_direction.at(var);
-        var_to_direction.at(var) = NodeUtils::get_root(d);
-        return var_to_direction.at(var);
+        var_to_direction[var] = NodeUtils::get_root(var_to_direction[var]);
+        return var_to_direction[var];
     }
     inline constexpr Length* __get_length(const Expr::Var& var) {
-        Length* l = var_to_length.at(var);
-        var_to_length.at(var) = NodeUtils::get_root(l);
-        return var_to_length.at(var);
+        var_to_length[var] = NodeUtils::get_root(var_to_length[var]);
+        return var_to_length[var];
     }
     inline constexpr Displacement __get_displacement(const Expr::Var& var) {
-        Displacement disp = var_to_displacement.at(var);
+        Displacement disp = var_to_displacement[var];
         disp.l = NodeUtils::get_root(disp.l);
         disp.p = NodeUtils::get_root(disp.p);
         return disp;
@@ -7,11 +7,9 @@
 
 LinProg::LinProg(
     bool verbose
-) : last(0) {
+) : last(0), last_row(0) {
     highs.setOptionValue("log_to_console", verbose);
-    model.lp_.a_matrix_.start_ = {0};
-    model.lp_.a_matrix_.format_ = MatrixFormat::kColwise;
-    model.lp_.sense_ = ObjSense::kMinimize;
+    highs.changeObjectiveSense(ObjSense::kMinimize);
 }
 
 void LinProg::populate(
@@ -27,34 +25,55 @@ void LinProg::populate(
 void LinProg::populate_matrix_A(
     const SparseMatrix& A
 ) {
-    model.lp_.num_col_ = A.n;
-    model.lp_.num_row_ = A.m;
-    
-    model.lp_.col_lower_ = std::vector<double>(A.n, 0.0);
-    model.lp_.col_upper_ = std::vector<double>(A.n, 1.0e30);
+    if (last_row < A.m) {
+        // New rows are added empty: their entries are set by the columns which use them
+        std::vector<double> zeroes(A.m - last_row, 0.0);
+        highs.addRows(A.m - last_row, zeroes.data(), zeroes.data(), 0, nullptr, nullptr, nullptr);
+        last_row = A.m;
+    }
+    if (last >= A.n) {
+        return;
+    }
 
-    while (last < A.n) {
+    std::vector<HighsInt> start, index;
+    std::vector<double> value;
+    while (last + (int)start.size() < A.n) {
+        int j = last + start.size();
+        start.emplace_back(value.size());
         for (int k=0; k<A.s; k++) {
-            if (A.row_indices[last][k] >= 0) {
-                model.lp_.a_matrix_.index_.emplace_back(A.row_indices[last][k]);
-                model.lp_.a_matrix_.value_.emplace_back(A.values[last][k]);
+            if (A.row_indices[j][k] >= 0) {
+                index.emplace_back(A.row_indices[j][k]);
+                value.emplace_back(A.values[j][k]);
             }
         }
-        model.lp_.a_matrix_.start_.emplace_back(model.lp_.a_matrix_.value_.size());
-        last++;
     }
+    int num_new_col = start.size();
+    std::vector<double> zeroes(num_new_col, 0.0), infs(num_new_col, 1.0e30);
+    highs.addCols(
+        num_new_col, zeroes.data(), zeroes.data(), infs.data(), 
+        value.size(), start.data(), index.data(), value.data()
+    );
+    cost.resize(A.n, 0.0);
+    last = A.n;
 }
 void LinProg::populate_target(
     const std::vector<double>& b
 ) {
-    model.lp_.row_lower_ = b;
-    model.lp_.row_upper_ = b;
+    if (b.empty()) return;
+    highs.changeRowsBounds(0, b.size() - 1, b.data(), b.data());
 }
 
 void LinProg::populate_cost(
     const std::vector<double>& c
 ) {
-    model.lp_.col_cost_ = c;
+    // Only pass on the costs which changed, to keep the previous basis optimal where possible
+    int i = 0, j = (int)c.size() - 1;
+    while (i <= j && i < (int)cost.size() && cost[i] == c[i]) i++;
+    while (j >= i && j < (int)cost.size() && cost[j] == c[j]) j--;
+    if (i <= j) {
+        highs.changeColsCost(i, j, c.data() + i);
+    }
+    cost = c;
 }
 
 bool LinProg::solve(
@@ -62,11 +81,6 @@ bool LinProg::solve(
     bool verbose
 ) {
     HighsStatus status;
-    status = highs.passModel(model);
-    if (status != HighsStatus::kOk) {
-        if (verbose) std::cout << "LinProg::solve: passModel failed with status " << static_cast<int>(status) << "\n";
-        return false;
-    }
     status = highs.run();
     if (status != HighsStatus::kOk) {
         if (verbose) std::cout << "LinProg::solve: run failed with status " << static_cast<int>(status) << "\n";
@@ -81,17 +95,18 @@ bool LinProg::solve(
         }
         return false;
     }
-    HighsSolution sol = highs.getSolution();
+    const HighsSolution& sol = highs.getSolution();
     result = sol.col_value;
     return true;
 }
 
 std::string LinProg::__print_matrix_A() const {
+    const HighsLp& lp = highs.getLp();
     std::string s = "-";
-    for (int k=0; k<model.lp_.num_col_; k++) {
-        int i = model.lp_.a_matrix_.start_[k], j = model.lp_.a_matrix_.start_[k+1];
+    for (int k=0; k<lp.num_col_; k++) {
+        int i = lp.a_matrix_.start_[k], j = lp.a_matrix_.start_[k+1];
         while (i < j) {
-            s += "A[" + std::to_string(model.lp_.a_matrix_.index_[i]) + "," + std::to_string(k) + "] = " + std::to_string(model.lp_.a_matrix_.value_[i]) + "; ";
+            s += "A[" + std::to_string(lp.a_matrix_.index_[i]) + "," + std::to_string(k) + "] = " + std::to_string(lp.a_matrix_.value_[i]) + "; ";
             i++;
         }
         s += "\n";
@@ -99,10 +114,11 @@ std::string LinProg::__print_matrix_A() const {
     return s;
 }
 std::string LinProg::__print_target() const {
+    const HighsLp& lp = highs.getLp();
     std::string s;
-    for (size_t i = 0; i < model.lp_.row_lower_.size(); i++) {
-        if (model.lp_.row_lower_[i] > 0.05 || model.lp_.row_lower_[i] < -0.05) {
-            s += "b[" + std::to_string(i) + "] = " + std::to_string(model.lp_.row_lower_[i]) + "; ";
+    for (size_t i = 0; i < lp.row_lower_.size(); i++) {
+        if (lp.row_lower_[i] > 0.05 || lp.row_lower_[i] < -0.05) {
+            s += "b[" + std::to_string(i) + "] = " + std::to_string(lp.row_lower_[i]) + "; ";
         }
     }
     return s;
@@ -123,5 +139,9 @@ std::string LinProg::__print_result(
 }
 
 void LinProg::reset() {
-    model.lp_.a_matrix_.start_ = {0};
+    highs.clearModel();
+    highs.changeObjectiveSense(ObjSense::kMinimize);
+    last = 0;
+    last_row = 0;
+    cost.clear();
 }
\ No newline at end of file
@@ -1,4 +1,3 @@
-
 #pragma once
 
 #include "Highs.h"
@@ -10,15 +9,24 @@
 
 Solve the linear program `min c^T * x` subject to `A * x = b, x >= 0`.
 
+The model held by `highs` persists across calls to `solve()`. Calling `populate()` again
+with an extended `A` only adds the new rows and columns, and otherwise only changes the row
+bounds `b` (and any changed costs `c`), so that HiGHS can warm-start from the previous basis.
+Note: The entries of previously populated columns of `A` are assumed never to change.
+
 Documentation: 
 - https://ergo-code.github.io/HiGHS/dev/ 
 - https://github.com/ERGO-Code/HiGHS/blob/master/examples/call_highs_from_cpp.cpp */
 class LinProg {
 public:
     Highs highs;
-    HighsModel model;
 
+    /* Number of columns of `A` already passed to `highs` */
     int last;
+    /* Number of rows of `A` already passed to `highs` */
+    int last_row;
+    /* Costs already passed to `highs` */
+    std::vector<double> cost;
 
     LinProg(
         bool verbose=false
@@ -30,6 +38,8 @@ public:
         const std::vector<double>& c
     );
 
+    /* Adds the rows and columns of `A` not yet passed to `highs`. New columns have zero cost
+    until `populate_cost()` is called. */
     void populate_matrix_A(
         const SparseMatrix& A
     );
@@ -55,4 +65,4 @@ public:
     );
 
     void reset();
-};
\ No newline at end of file
+};
@@ -1,5 +1,6 @@
 
 #include <numeric>
+#include <algorithm>
 
 #include "Table.hh"
 #include "Common/Exceptions.hh"
@@ -13,6 +14,28 @@
     #define LOG(x)
 #endif
 
+Expr::Expr::Expr(std::initializer_list<Term> terms) : std::vector<Term>(terms) {
+    std::stable_sort(begin(), end(), [](const Term& t1, const Term& t2) { return t1.first < t2.first; });
+    // Add up the coefficients of repeated variables
+    auto out = begin();
+    for (auto it = begin(); it != end(); ++it) {
+        if (out != begin() && std::prev(out)->first == it->first) {
+            std::prev(out)->second += it->second;
+        } else {
+            *(out++) = *it;
+        }
+    }
+    erase(out, end());
+}
+bool Expr::Expr::contains(const Var var) const {
+    auto it = std::lower_bound(begin(), end(), var, [](const Term& t, const Var v) { return t.first < v; });
+    return (it != end()) && (it->first == var);
+}
+double Expr::Expr::at(const Var var) const {
+    auto it = std::lower_bound(begin(), end(), var, [](const Term& t, const Var v) { return t.first < v; });
+    return ((it != end()) && (it->first == var)) ? it->second : 0.0;
+}
+
 double Expr::fix_v(const double d) {
     return Frac(d).to_double();
 }
@@ -22,20 +45,15 @@ void Expr::fix(Expr& expr) {
     }
 }
 void Expr::strip(Expr& expr) {
-    for (auto it = expr.cbegin(); it != expr.cend(); ) {
-        if (NumUtils::is_close_2(it->second, 0.0)) {
-            it = expr.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    std::erase_if(expr, [](const Term& t) { return NumUtils::is_close_2(t.second, 0.0); });
 }
 int Expr::mod_pi(Expr& expr, const Var pi) {
     int ret = 0;
-    if (expr.contains(pi)) {
-        double coeff = expr[pi];
+    for (auto& [var, coeff] : expr) {
+        if (var != pi) continue;
         ret = std::floor(coeff);
-        expr[pi] = coeff - std::floor(coeff);
+        coeff = coeff - std::floor(coeff);
+        break;
     }
     return ret;
 }
@@ -47,24 +65,43 @@ bool Expr::all_zeroes(const Expr& expr) {
     }
     return true;
 }
-void Expr::__add(Expr& expr1, const Expr& expr2) {
-    for (const auto& [var, coeff] : expr2) {
-        if (expr1.contains(var)) {
-            expr1[var] += coeff;
+void Expr::__add_mult(Expr& expr1, const Expr& expr2, const double c) {
+    if (expr2.empty()) return;
+    if (expr2.size() == 1) {
+        // Common case: a single term can be inserted in place
+        const auto& [var, coeff] = expr2.front();
+        auto it = std::lower_bound(expr1.begin(), expr1.end(), var, [](const Term& t, const Var v) { return t.first < v; });
+        if (it != expr1.end() && it->first == var) {
+            it->second += coeff * c;
         } else {
-            expr1[var] = coeff;
+            expr1.insert(it, {var, coeff * c});
+        }
+        return;
+    }
+    Expr result;
+    result.reserve(expr1.size() + expr2.size());
+    auto it1 = expr1.cbegin(), it2 = expr2.cbegin();
+    while (it1 != expr1.cend() && it2 != expr2.cend()) {
+        if (it1->first < it2->first) {
+            result.emplace_back(*(it1++));
+        } else if (it2->first < it1->first) {
+            result.emplace_back(it2->first, it2->second * c);
+            ++it2;
+        } else {
+            result.emplace_back(it1->first, it1->second + it2->second * c);
+            ++it1; ++it2;
         }
     }
+    for (; it1 != expr1.cend(); ++it1) result.emplace_back(*it1);
+    for (; it2 != expr2.cend(); ++it2) result.emplace_back(it2->first, it2->second * c);
+    expr1.swap(result);
+}
+void Expr::__add(Expr& expr1, const Expr& expr2) {
+    __add_mult(expr1, expr2, 1.0);
 }
 Expr::Expr Expr::add(const Expr& expr1, const Expr& expr2) {
     Expr result = expr1;    // copy-construction
-    for (const auto& [var, coeff] : expr2) {
-        if (result.contains(var)) {
-            result[var] += coeff;
-        } else {
-            result[var] = coeff;
-        }
-    }
+    __add_mult(result, expr2, 1.0);
     return result;
 }
 void Expr::__mult(Expr& expr, const double c) {
@@ -80,23 +117,11 @@ Expr::Expr Expr::mult(const Expr& expr, const double c) {
     return result;
 }
 void Expr::__minus(Expr& expr1, const Expr& expr2) {
-    for (const auto& [var, coeff] : expr2) {
-        if (expr1.contains(var)) {
-            expr1[var] -= coeff;
-        } else {
-            expr1[var] = -coeff;
-        }
-    }
+    __add_mult(expr1, expr2, -1.0);
 }
 Expr::Expr Expr::minus(const Expr& expr1, const Expr& expr2) {
     Expr result = expr1;    // copy-construction
-    for (const auto& [var, coeff] : expr2) {
-        if (result.contains(var)) {
-            result[var] -= coeff;
-        } else {
-            result[var] = -coeff;
-        }
-    }
+    __add_mult(result, expr2, -1.0);
     return result;
 }
 void Expr::__div(Expr& expr, const double c) {
@@ -111,26 +136,25 @@ Expr::Expr Expr::div(const Expr& expr, const double c) {
     }
     return result;
 }
-void Expr::__replace(Expr& expr, const Var& var, const Expr& sub_expr) {
-    if (expr.contains(var)) {
-        double coeff = expr[var];
-        expr.erase(var);
-        __add(expr, mult(sub_expr, coeff));
+bool Expr::__replace(Expr& expr, const Var& var, const Expr& sub_expr) {
+    auto it = std::lower_bound(expr.begin(), expr.end(), var, [](const Term& t, const Var v) { return t.first < v; });
+    if (it == expr.end() || it->first != var) {
+        return false;
     }
+    double coeff = it->second;
+    expr.erase(it);
+    __add_mult(expr, sub_expr, coeff);
+    return true;
 }
 Expr::Expr Expr::replace(const Expr& expr, const Var& var, const Expr& sub_expr) {
     Expr result = expr;    // copy-construction
-    if (result.contains(var)) {
-        double coeff = result[var];
-        result.erase(var);
-        __add(result, mult(sub_expr, coeff));
-    }
+    __replace(result, var, sub_expr);
     return result;
 }
 std::pair<Expr::Var, Expr::Expr> Expr::get_subject(const Expr& expr, const Var c) {
     Expr result = expr;   // copy-construction
     strip(result);
-    Var subject = "";
+    Var subject = NONE;
     double subject_c;
     for (const auto& [var, coeff] : result) {
         if (var != c) {
@@ -139,10 +163,10 @@ std::pair<Expr::Var, Expr::Expr> Expr::get_subject(const Expr& expr, const Var c
             break;
         }
     }
-    if (subject.empty()) {
-        return {"", {}};
+    if (subject == NONE) {
+        return {NONE, {}};
     }
-    result.erase(subject);
+    std::erase_if(result, [subject](const Term& t) { return t.first == subject; });
     __div(result, -subject_c);
     return {subject, result};
 }
@@ -152,15 +176,15 @@ Expr::Expr Expr::int_ify(const Expr& expr) {
         Frac f = Frac(d);
         lcm = std::lcm(lcm, f.den);
     }
-    Expr res;
-    for (auto& [var, d] : expr) {
+    Expr res = expr;
+    for (auto& [var, d] : res) {
         Frac f = Frac(d);
-        __add(res, {{var, f.num * (lcm / f.den)}});
+        d = f.num * (lcm / f.den);
     }
     return res;
 }
 std::string Expr::to_string(const Var& var) {
-    return var;
+    return (var == ONE) ? "1" : "v" + std::to_string(var);
 }
 int Expr::len(const Expr& expr) {
     return expr.size();
@@ -201,15 +225,25 @@ std::string Expr::to_string(const Expr& expr) {
 
 
 
+Expr::Expr& Table::__get_M(const Expr::Var var) {
+    if (var >= (int)M_contains.size()) {
+        M_var_to_expr.resize(var + 1);
+        M_contains.resize(var + 1, false);
+    }
+    M_contains[var] = true;
+    dirty_vars.insert(var);
+    return M_var_to_expr[var];
+}
+
 bool Table::add_free(const Expr::Var& var_name) {
-    M_var_to_expr[var_name] = {{var_name, 1.0}};
+    __get_M(var_name) = {{var_name, 1.0}};
     return true;
 }
 bool Table::is_free(const Expr::Var& var_name) const {
-    if (!M_var_to_expr.contains(var_name)) {
+    if (!in_M(var_name)) {
         return false;
     }
-    const Expr::Expr& expr = M_var_to_expr.at(var_name);
+    const Expr::Expr& expr = M_var_to_expr[var_name];
     return (expr.size() == 1) && (expr.contains(var_name)) && (NumUtils::is_close(expr.at(var_name), 1.0));
 }
 bool Table::add_expr(const Expr::Expr& expr) {
@@ -221,8 +255,8 @@ bool Table::add_expr(const Expr::Expr& expr) {
 
     for (const auto& [var, d] : expr) {
         if (NumUtils::is_close_2(d, 0.0)) continue;
-        if (M_var_to_expr.contains(var)) {
-            Expr::__add(result, Expr::mult(M_var_to_expr[var], d));
+        if (in_M(var)) {
+            Expr::__add_mult(result, M_var_to_expr[var], d);
             // By the invariant, result only contains free variables
         } else {
             new_vars.push_back({var, d});
@@ -238,7 +272,7 @@ bool Table::add_expr(const Expr::Expr& expr) {
             return false; // Expression already known
         }
         auto [subject, expr_subj] = Expr::get_subject(result, one);
-        if (subject.empty()) {
+        if (subject == Expr::NONE) {
             // LOG("Table::add_expr(): No subject found in " << Expr::to_string(result) << "!");
             return false;
         }
@@ -250,16 +284,18 @@ bool Table::add_expr(const Expr::Expr& expr) {
 
     } else if (new_vars.size() == 1) {
         auto [var, d] = new_vars[0];
-        M_var_to_expr[var] = Expr::div(result, -d);
+        Expr::Expr& expr_var = __get_M(var);
+        expr_var = Expr::div(result, -d);
+        Expr::fix(expr_var);
         // Invariant maintained: M_var_to_expr[var] only contains free variables
         
         LOG("Added the expression " << Expr::to_string(var) << " = " << Expr::to_string(M_var_to_expr[var]));
 
     } else {
-        Expr::Var dependent_var = "";
+        Expr::Var dependent_var = Expr::NONE;
         double dependent_d = 0;
         for (auto& [var, d] : new_vars) {
-            if (dependent_var.empty() && (var != one)) {
+            if ((dependent_var == Expr::NONE) && (var != one)) {
                 dependent_var = var;
                 dependent_d = d;
                 continue;
@@ -267,7 +303,9 @@ bool Table::add_expr(const Expr::Expr& expr) {
             add_free(var);
             Expr::__add(result, {{var, d}});
         }
-        M_var_to_expr[dependent_var] = Expr::div(result, -dependent_d);
+        Expr::Expr& expr_var = __get_M(dependent_var);
+        expr_var = Expr::div(result, -dependent_d);
+        Expr::fix(expr_var);
         // Invariant maintained: M_var_to_expr[var] only contains free variables
 
         LOG("Added the expression " << Expr::to_string(dependent_var) << " = " << Expr::to_string(M_var_to_expr[dependent_var]));
@@ -277,10 +315,13 @@ bool Table::add_expr(const Expr::Expr& expr) {
 
 void Table::replace(const Expr::Var& var, const Expr::Expr& sub_expr) {
     // Invariant: This function is only ever invoked with var being a free variable.
-    for (auto& [_, expr] : M_var_to_expr) {
-        Expr::__replace(expr, var, sub_expr);
+    // Rows not containing var are already stripped and fixed, so they are left alone
+    for (Expr::Var v = 0; v < (int)M_var_to_expr.size(); v++) {
+        Expr::Expr& expr = M_var_to_expr[v];
+        if (!Expr::__replace(expr, var, sub_expr)) continue;
         Expr::strip(expr);
         Expr::fix(expr);
+        dirty_vars.insert(v);
     }
     return;
 
@@ -302,7 +343,10 @@ bool Table::register_expr(const Expr::Expr& expr, Predicate* pred) {
         return false;
     }
     for (const auto& [var, _] : expr) {
-        if (!var_to_idx.contains(var)) {
+        if (var >= (int)var_to_idx.size()) {
+            var_to_idx.resize(var + 1, -1);
+        }
+        if (var_to_idx[var] < 0) {
             var_to_idx[var] = num_vars++;
         }
     }
@@ -364,8 +408,9 @@ bool Table::add_eq(const Expr::Expr& expr, Predicate* pred) {
 #if DEBUG_ARTABLE
     bool res = add_expr(expr) && register_expr(expr, pred);
     if (res) {
-        for (auto [var_, expr_] : M_var_to_expr) {
-            Expr::Expr expr_to_check = Expr::minus(expr_, {{var_, 1}});
+        for (Expr::Var var_ = 0; var_ < (int)M_var_to_expr.size(); var_++) {
+            if (!in_M(var_)) continue;
+            Expr::Expr expr_to_check = Expr::minus(M_var_to_expr[var_], {{var_, 1}});
             Expr::strip(expr_to_check);
             if (Expr::all_zeroes(expr_to_check)) continue;
             if (why(expr_to_check).size() == 0) {
@@ -423,15 +468,14 @@ std::set<Predicate*> Table::why(const Expr::Expr& expr) {
     // Convert the target expr into a std::vector<double> b
     std::vector<double> b_vec(num_vars, 0.0);
     for (const auto& [var, coeff] : target) {
-        b_vec[var_to_idx.at(var)] = coeff;
+        b_vec[var_to_idx[var]] = coeff;
     }
-    LinProg lp_solver;
-    lp_solver.populate(A, b_vec, c);
+    lp.populate(A, b_vec, c);
 
     // Solve the linear program min c^T * x subject to A * x = b, x >= 0
     std::vector<double> solution;
 
-    bool solved = lp_solver.solve(solution);
+    bool solved = lp.solve(solution);
     if (!solved) {
         throw ARInternalError("Failed to solve LP For expression " + Expr::to_string(expr));
     }
@@ -451,44 +495,140 @@ std::set<Predicate*> Table::why(const Expr::Expr& expr) {
 
 
 Generator<Expr::VarPair> Table::all_varpairs() const {
-    for (const auto& [var1, _] : M_var_to_expr) {
-        if (var1 == one) continue;
-        for (const auto& [var2, _] : M_var_to_expr) {
-            if (var2 == one || var2 == var1) continue;
+    for (Expr::Var var1 = 0; var1 < (int)M_contains.size(); var1++) {
+        if (var1 == one || !M_contains[var1]) continue;
+        for (Expr::Var var2 = 0; var2 < (int)M_contains.size(); var2++) {
+            if (var2 == one || var2 == var1 || !M_contains[var2]) continue;
             co_yield {var1, var2};
         }
     }
     co_return;
 }
 
+int Table::__get_bucket(const Expr::ExprHash& key) {
+    auto [it, inserted] = key_to_bucket.try_emplace(key, buckets.size());
+    if (!inserted) {
+        return it->second;
+    }
+    int b = it->second;
+    buckets.push_back({key, {}});
+
+    // Bucket keys never change, so the differences to all other buckets are computed once
+    for (const auto& [_, b2] : key_to_bucket) {
+        if (b2 == b) continue;
+        Expr::Expr d12 = Expr::minus(key, buckets[b2].key);
+        Expr::strip(d12);
+        Expr::fix(d12);
+        bucket_diffs[d12].insert({b, b2});
+        Expr::Expr d21 = Expr::minus(buckets[b2].key, key);
+        Expr::strip(d21);
+        Expr::fix(d21);
+        bucket_diffs[d21].insert({b2, b});
+    }
+    return b;
+}
+
+void Table::__remove_bucket(int b) {
+    key_to_bucket.erase(buckets[b].key);
+    for (const auto& [_, b2] : key_to_bucket) {
+        for (const auto& [k1, k2] : {std::pair{b, b2}, std::pair{b2, b}}) {
+            Expr::Expr d = Expr::minus(buckets[k1].key, buckets[k2].key);
+            Expr::strip(d);
+            Expr::fix(d);
+            auto it = bucket_diffs.find(d);
+            if (it == bucket_diffs.end()) continue;
+            it->second.erase({k1, k2});
+            if (it->second.empty()) bucket_diffs.erase(it);
+        }
+    }
+    buckets[b].key.clear();
+}
+
+void Table::__add_bucket_pair(const Expr::Var v1, const Expr::Var v2) {
+    // Variables sharing a bucket differ only by their constant terms
+    double f = M_var_to_expr[v1].at(one) - M_var_to_expr[v2].at(one);
+
+    // For the angle table specifically, since we take modulo pi, we can
+    // remove all integer multiples of pi from f
+    int i = 0;
+    if (mod_one) {
+        i = std::floor(f);
+        f = f - std::floor(f);
+    }
+    if (i) pi_offsets[{v1, v2}] = i;
+    else pi_offsets.erase({v1, v2});
+
+    if (NumUtils::is_close_2(f, 0.0)) {
+        eq_2s[{}].insert({v1, v2});
+    } else {
+        eq_3s[{{one, Expr::fix_v(f)}}].insert({v1, v2});
+    }
+}
+
 void Table::generate_all_eqs() {
-    eq_2s.clear();
-    eq_3s.clear();
     eq_4s.clear();
-    pi_offsets.clear();
 
-    auto all_varpairs_gen = all_varpairs();
-    while (all_varpairs_gen) {
-        auto [var1, var2] = all_varpairs_gen();
-        Expr::Expr e1 = M_var_to_expr[var1], e2 = M_var_to_expr[var2];
-        Expr::Expr e12 = Expr::minus(e1, e2);
+    // Take the variables whose expressions changed out of their old buckets
+    for (const Expr::Var var : dirty_vars) {
+        if (var == one || var >= (int)var_to_bucket.size() || var_to_bucket[var] < 0) continue;
+        int b = var_to_bucket[var];
+        buckets[b].vars.erase(var);
+        var_to_bucket[var] = -1;
+        if (buckets[b].vars.empty()) {
+            __remove_bucket(b);
+        }
+    }
+    // and file them under the non-constant part of their new expressions
+    for (const Expr::Var var : dirty_vars) {
+        if (var == one || !in_M(var)) continue;
+        Expr::ExprHash key = M_var_to_expr[var];
+        std::erase_if(key, [this](const Expr::Term& t) { return t.first == one; });
 
-        // For the angle table specifically, since we take modulo pi, we can
-        // remove all integer multiples of pi from e12
-        int i = Expr::mod_pi(e12);
-        if (i) pi_offsets[{var1, var2}] = i;
+        int b = __get_bucket(key);
+        buckets[b].vars.insert(var);
+        if (var >= (int)var_to_bucket.size()) {
+            var_to_bucket.resize(var + 1, -1);
+        }
+        var_to_bucket[var] = b;
+    }
 
-        Expr::strip(e12);
-        Expr::fix(e12);
-        Expr::ExprHash eh = Expr::hash(e12);    // eh == e12
-        
-        int l = Expr::hashlen(eh);
-        if (l == 0) {
-            eq_2s[eh].insert({var1, var2});
-        } else if ((l == 1) && (e12.contains(one))) {
-            eq_3s[eh].insert({var1, var2});
-        } else {
-            eq_4s[eh].insert({var1, var2});
+    // Only buckets which gained variables can have new equal or constant-offset pairs
+    for (const Expr::Var var : dirty_vars) {
+        if (var == one || !in_M(var)) continue;
+        for (const Expr::Var other : buckets[var_to_bucket[var]].vars) {
+            if (other == var) continue;
+            __add_bucket_pair(var, other);
+            __add_bucket_pair(other, var);
+        }
+    }
+    dirty_vars.clear();
+
+    // Pairs across buckets (b1, b2) differ by the bucket difference plus a constant
+    for (const auto& [d, bucket_pairs] : bucket_diffs) {
+        int num_pairs = 0;
+        for (const auto& [b1, b2] : bucket_pairs) {
+            num_pairs += buckets[b1].vars.size() * buckets[b2].vars.size();
+        }
+        if (num_pairs < 2) continue;
+
+        std::map<Expr::ExprHash, EqualGroup> groups;
+        for (const auto& [b1, b2] : bucket_pairs) {
+            for (const Expr::Var var1 : buckets[b1].vars) {
+                for (const Expr::Var var2 : buckets[b2].vars) {
+                    double f = M_var_to_expr[var1].at(one) - M_var_to_expr[var2].at(one);
+                    if (mod_one) f = f - std::floor(f);
+
+                    Expr::ExprHash eh = d;
+                    if (!NumUtils::is_close_2(f, 0.0)) {
+                        eh.insert(eh.begin(), {one, Expr::fix_v(f)});
+                    }
+                    groups[eh].insert({var1, var2});
+                }
+            }
+        }
+        for (auto& [eh, varpairs] : groups) {
+            if (varpairs.size() < 2) continue;
+            eq_4s[eh] = std::move(varpairs);
         }
     }
 }
@@ -571,7 +711,9 @@ std::string Table::__print_A() const {
     while (gen) {
         std::vector<double> col = gen();
         Expr::Expr col_expr;
-        for (auto [var, i] : var_to_idx) {
+        for (Expr::Var var = 0; var < (int)var_to_idx.size(); var++) {
+            int i = var_to_idx[var];
+            if (i < 0) continue;
             Frac f = Frac(col[i]);
             if (f.num != 0) {
                 Expr::__add(col_expr, Expr::Expr{{var, f.to_double()}});
@@ -584,8 +726,9 @@ std::string Table::__print_A() const {
 
 std::string Table::__print_M() const {
     std::string s = "M_var_to_expr:\n";
-    for (const auto& [var, expr] : M_var_to_expr) {
-        s += "  " + Expr::to_string(var) + " = " + Expr::to_string(expr) + "\n";
+    for (Expr::Var var = 0; var < (int)M_var_to_expr.size(); var++) {
+        if (!in_M(var)) continue;
+        s += "  " + Expr::to_string(var) + " = " + Expr::to_string(M_var_to_expr[var]) + "\n";
     }
     return s;
 }
@@ -597,7 +740,9 @@ void Table::reset() {
     var_to_idx.clear();
     c.clear();
     deps.clear();
+    lp.reset();
     M_var_to_expr.clear();
+    M_contains.clear();
     equal_groups.clear();
     eq_2s_seen.clear();
     eq_3s_seen.clear();
@@ -606,4 +751,9 @@ void Table::reset() {
     eq_3s.clear();
     eq_4s.clear();
     pi_offsets.clear();
+    buckets.clear();
+    key_to_bucket.clear();
+    var_to_bucket.clear();
+    bucket_diffs.clear();
+    dirty_vars.clear();
 }
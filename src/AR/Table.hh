@@ -11,16 +11,35 @@
 #include "DD/Predicate.hh"
 
 namespace Expr {
-    typedef std::string Var;
+    /* Dense variable ID, local to each `Table`. The ID `ONE` is reserved for the constant 
+    term of the table (`pi` for the angle table and `1` for the others), and `NONE` is used 
+    as a null value. */
+    typedef int Var;
     typedef std::pair<Var, Var> VarPair;
-    typedef std::map<Var, double> Expr;
+    typedef std::pair<Var, double> Term;
+    constexpr Var ONE = 0;
+    constexpr Var NONE = -1;
+
+    /* Sparse expression `v0*c0 + v1*c1 + ... + vn*cn`, stored as a vector of terms 
+    `(vi, ci)` sorted by `vi`. Every variable appears at most once; the initializer list 
+    constructor sorts its terms and adds up duplicates. */
+    struct Expr : public std::vector<Term> {
+        Expr() = default;
+        Expr(std::initializer_list<Term> terms);
+
+        bool contains(const Var var) const;
+        /* Returns the coefficient of `var`, or 0 if `var` does not appear. */
+        double at(const Var var) const;
+    };
     typedef Expr ExprHash;
 
     double fix_v(const double d);
     void fix(Expr& expr);
     void strip(Expr& expr);
-    int mod_pi(Expr& expr, const Var pi = Constants::PI);
+    int mod_pi(Expr& expr, const Var pi = ONE);
     bool all_zeroes(const Expr& expr);
+    /* Performs `expr1 += expr2 * c` in a single merge pass. */
+    void __add_mult(Expr& expr1, const Expr& expr2, const double c);
     void __add(Expr& expr1, const Expr& expr2);
     Expr add(const Expr& expr1, const Expr& expr2);
     template <typename... T>
@@ -36,14 +55,17 @@ namespace Expr {
     Expr minus(const Expr& expr1, const Expr& expr2);
     void __div(Expr& expr, const double c);
     Expr div(const Expr& expr, const double c);
-    void __replace(Expr& expr, const Var& var, const Expr& sub_expr);
+    /* Substitutes `sub_expr` for `var` in `expr`. Returns `false` if `var` does not occur
+    in `expr`, in which case `expr` is left untouched. */
+    bool __replace(Expr& expr, const Var& var, const Expr& sub_expr);
     Expr replace(const Expr& expr, const Var& var, const Expr& sub_expr);
     /* Given an expression of the form `v0*c0 + v1*c1 + ... + vn*cn = 0`, extracts
     a random variable `vn` as the subject of the equivalent expression 
     `vn = -(v0*c0 + ... + v[n-1]*c[n-1]) / cn`.
     No variable ordering is necessary as we are working with a reduced row-echelon
     form of the matrix M. See documentation of Table class for more info.
-    The variable `c` is "ignored during extraction". */
+    The variable `c` is "ignored during extraction". If no subject is found, `NONE` is
+    returned. */
     std::pair<Var, Expr> get_subject(const Expr& expr, const Var c);
 
     /* Scales up the expression so that all coefficients are integers. */
@@ -75,9 +97,13 @@ column corresponds to a zero-equality between the variables, of the
 form `v0*c0 + v1*c1 + ... + vn*cn = 0`, where `vi` are variables and `ci` are `Frac`s.
 Columns are stored in pairs, with one positive and one negative version.
 
-- `var_to_idx : std::map<Var, int>`: 
-Stores the mapping from variable names to their corresponding row indices in the 
-matrix `A`.
+Variables are dense integer IDs handed out by the owner of the `Table` (see `AREngine::__get_var()`),
+so that no strings are handled by the `Table` itself. The ID `Expr::ONE` is reserved for the
+constant term.
+
+- `var_to_idx : std::vector<int>`: 
+Stores the mapping from variables to their corresponding row indices in the matrix `A`, or -1
+if the variable has not been registered yet.
 
 - `c : std::vector<float>`:
 A vector storing either 1 or -1, indicating whether each column is positive or negative.
@@ -90,10 +116,10 @@ deduce the predicate dependencies of expressions. As a result, the entries of `A
 need to be mutated, and we also don't need to care about variable ordering etc.
 See the `why()` method for details on how this is implemented.
 
-- `M_var_to_expr : std::map<Var, Expr>`:
+- `M_var_to_expr : std::vector<Expr>`:
 Stores expressions representing each variable as a linear combination of other 
-variables. Variables are stored in the format `v: {v0: c0, v1: c1, ...}` and 
-indicate that `v = v0*c0 + v1*c1 + ...`.
+variables, indexed by variable. Variables are stored in the format `v: {v0: c0, v1: c1, ...}` 
+and indicate that `v = v0*c0 + v1*c1 + ...`. Only entries flagged in `M_contains` are valid.
 
 - `equal_groups : list of std::set<VarPair>`: 
 Every set stores ordered pairs `(vi, vj)` of variables which are known to have the 
@@ -136,11 +162,20 @@ When an expression is added to the `Table` via `add_eq_N()`,
 
 ## Fetching equalities
 
-When `get_all_eqs()` is called, we iterate through all ordered distinct variable pairs 
-`(v1, v2)`, storing them in:
+When `generate_all_eqs()` is called, we sort ordered distinct variable pairs `(v1, v2)` into:
 - `eq_2s` if they satisfy `v1 - v2 = 0`, otherwise
 - `eq_3s` if they satisfy `v1 - v2 = f`, otherwise
-- `eq_4s` in the general case
+- `eq_4s` in the general case.
+
+Rather than subtracting the expressions of every pair of variables, variables are kept in 
+`buckets` keyed by the non-constant part of their expression in `M_var_to_expr`:
+- two variables satisfy `v1 - v2 = 0` or `v1 - v2 = f` iff they share a bucket, so only pairs
+  within buckets which gained variables since the last call are added to `eq_2s` and `eq_3s`;
+- for two variables in different buckets, `v1 - v2` is the difference of the bucket keys plus
+  a constant. These differences are cached per pair of buckets in `bucket_diffs`, and are only
+  computed when a bucket is created, so `eq_4s` can be rebuilt by hashing.
+Since the equalities known to the `Table` only ever grow, the entries of `eq_2s` and `eq_3s` 
+never go stale and are kept across calls.
 
 We then call each of `get_all_eq_Ns_and_why()`, which returns all newly derived, unordered 
 variable pairs (or quadruples) satisfying each of the three equality types above. This is
@@ -159,13 +194,19 @@ public:
     int num_vars;
     int num_eqs;
     const Expr::Var one;
+    /* Whether constants are taken modulo `one` (i.e. modulo pi in the angle table). */
+    const bool mod_one;
 
     SparseMatrix A;
-    std::map<Expr::Var, int> var_to_idx;
+    std::vector<int> var_to_idx;
     std::vector<double> c;
     std::vector<Predicate*> deps;
+    /* Persistent LP over `A` and `c`, extended as equations are added and warm-started
+    across calls to `why()`. */
+    LinProg lp;
 
-    std::map<Expr::Var, Expr::Expr> M_var_to_expr;
+    std::vector<Expr::Expr> M_var_to_expr;
+    std::vector<bool> M_contains;
     std::set<EqualGroup> equal_groups;
 
     std::set<Expr::VarPair> eq_2s_seen;
@@ -177,10 +218,31 @@ public:
     
     std::map<Expr::VarPair, int> pi_offsets;
 
-    Table(Expr::Var one_var = Constants::ONE) : num_vars(0), num_eqs(0), one(one_var), A(0, 0, 5) {
+    /* A set of variables whose expressions share the non-constant part `key`. */
+    struct Bucket {
+        Expr::ExprHash key;
+        std::set<Expr::Var> vars;
+    };
+    std::vector<Bucket> buckets;
+    std::map<Expr::ExprHash, int> key_to_bucket;
+    std::vector<int> var_to_bucket;
+    /* Maps the difference of two bucket keys to all ordered pairs of buckets with that difference. */
+    std::map<Expr::ExprHash, std::set<std::pair<int, int>>> bucket_diffs;
+    /* Variables whose expressions changed since the last call to `generate_all_eqs()`. */
+    std::set<Expr::Var> dirty_vars;
+
+    Table(bool mod_one = false) : num_vars(0), num_eqs(0), one(Expr::ONE), mod_one(mod_one), A(0, 0, 5) {
         add_free(one);
     }
 
+    /* Check if a variable has an expression in `M_var_to_expr`. */
+    inline bool in_M(const Expr::Var var) const {
+        return var < (int)M_contains.size() && M_contains[var];
+    }
+    /* Returns a reference to the expression of `var` in `M_var_to_expr`, making room for it
+    if necessary. */
+    Expr::Expr& __get_M(const Expr::Var var);
+
     /* Add a free variable. */
     bool add_free(const Expr::Var& var_name);
 
@@ -326,14 +388,25 @@ public:
     /* Figure out why an expression holds.
     This is done by finding a linear combination of expressions, as recorded in `A`, that 
     corresponds to `expr`. To find the smallest such linear combination, we use linear
-    optimisation. 
+    optimisation. The LP `lp` is reused across calls, so that only the target `b` changes
+    between solves.
     Called by `get_all_eq_Ns_and_why()`. */
     std::set<Predicate*> why(const Expr::Expr& expr);
 
     /* Gets all ordered pairs of distinct variables `(v1, v2)`. */
     Generator<Expr::VarPair> all_varpairs() const;
 
-    /* Populate the `eq_Ns` maps. 
+    /* Returns the bucket for the non-constant part `key`, creating it (and its entries in 
+    `bucket_diffs`) if necessary. */
+    int __get_bucket(const Expr::ExprHash& key);
+    /* Removes an empty bucket, together with its entries in `bucket_diffs`. */
+    void __remove_bucket(int b);
+    /* Files the ordered pair `(v1, v2)` of variables sharing a bucket under `eq_2s` or `eq_3s`. */
+    void __add_bucket_pair(const Expr::Var v1, const Expr::Var v2);
+
+    /* Populate the `eq_Ns` maps. Only the buckets of variables in `dirty_vars` are re-examined
+    for `eq_2s` and `eq_3s`. `eq_4s` is rebuilt from `bucket_diffs`, keeping only groups with at
+    least two pairs (as singleton groups carry no equalities).
 
     Note: All ordered pairs will be populated. This is necessary as some `eh` might have
     two variable pairs `(v1, v2)` and `(v4, v3)` corresponding to it, satisfying the
@@ -64,6 +64,10 @@ const std::string PI = "pi";
 const int MIN_LEVEL = 1;
 const int MAX_LEVEL = 512;
 
+// For DDEngine::__plan_steps(): the factor by which a reordering of the preconditions of a theorem must
+// be estimated to be cheaper than their original order to be used
+const double PLAN_REORDER_GAIN = 4;
+
 template <typename T>
 inline constexpr bool is_std_map_v = false;
 template <typename K, typename V, typename Comp, typename Alloc>
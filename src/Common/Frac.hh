@@ -14,6 +14,7 @@ typedef struct Frac {
 	Frac(int n): num(n), den(1) {};
 	Frac(int num, int den);
 	Frac(double d);
+	Frac(const Frac &other) = default;
 
 	Frac operator+(const Frac &other) const;
 	Frac operator-(const Frac &other) const;
@@ -1,13 +1,107 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <coroutine>
 #include <exception>
+#include <new>
+
+/* Thread-local free lists of coroutine frames, by size class.
+
+Generators are created at very high rates (often one per candidate binding during matching), so their
+frames are recycled instead of going through `operator new` every time. Frame sizes are rounded up to a
+multiple of `GRANULE` bytes; frames larger than `MAX_POOLED` bytes are not pooled. A frame freed on
+another thread than the one that allocated it simply joins the free list of that thread. The free lists
+of a thread are released when it exits.
+
+`stats()` returns the number of frames allocated so far, and how many of them needed a fresh
+allocation, summed over all threads that have exited and the calling thread. */
+class FramePool {
+public:
+    const static std::size_t GRANULE = 64;
+    const static std::size_t MAX_POOLED = 2048;
+
+    struct Stats {
+        std::uint64_t allocated = 0;
+        std::uint64_t fresh = 0;
+    };
+
+    static void* allocate(std::size_t size) {
+        if (destroyed) return ::operator new(size);
+        std::size_t c = (size - 1) / GRANULE;
+        Lists& l = lists();
+        l.stats.allocated++;
+        if (c < NUM_CLASSES) {
+            if (Block* b = l.heads[c]) {
+                l.heads[c] = b->next;
+                return b;
+            }
+            size = (c + 1) * GRANULE;
+        }
+        l.stats.fresh++;
+        return ::operator new(size);
+    }
+
+    static void deallocate(void* p, std::size_t size) noexcept {
+        std::size_t c = (size - 1) / GRANULE;
+        if (c >= NUM_CLASSES || destroyed) {
+            ::operator delete(p);
+            return;
+        }
+        Lists& l = lists();
+        Block* b = static_cast<Block*>(p);
+        b->next = l.heads[c];
+        l.heads[c] = b;
+    }
+
+    static Stats stats() {
+        if (destroyed) return {total_allocated.load(), total_fresh.load()};
+        const Stats& s = lists().stats;
+        return {total_allocated.load() + s.allocated, total_fresh.load() + s.fresh};
+    }
+
+private:
+    const static std::size_t NUM_CLASSES = MAX_POOLED / GRANULE;
+
+    struct Block {
+        Block* next;
+    };
+    struct Lists {
+        Block* heads[NUM_CLASSES] = {};
+        Stats stats;
+
+        ~Lists() {
+            for (Block*& head : heads) {
+                while (head) {
+                    Block* next = head->next;
+                    ::operator delete(head);
+                    head = next;
+                }
+            }
+            total_allocated += stats.allocated;
+            total_fresh += stats.fresh;
+            // Frames destroyed after this point (e.g. by other thread-local objects) bypass the pool
+            destroyed = true;
+        }
+    };
+
+    static Lists& lists() {
+        thread_local Lists l;
+        return l;
+    }
+
+    inline static thread_local bool destroyed = false;
+    inline static std::atomic<std::uint64_t> total_allocated = 0;
+    inline static std::atomic<std::uint64_t> total_fresh = 0;
+};
 
 /* Lazy generator functions.
 
 Usage: Functions may be declared as `Generator<T>`. They should use the keywords `co_yield` to yield values 
 of type `T` (these are known as an intermediate suspend point), and `co_return` to end the generator, optionally
-yielding a final value (this is known as the final suspend point.) 
+yielding a final value (this is known as the final suspend point.) Their coroutine frames are recycled through
+the `FramePool`.
 
 ## Usage
 
@@ -37,6 +131,10 @@ struct Generator {
         T current_value;
         std::exception_ptr exception;
 
+        /* Coroutine frames are allocated from the `FramePool`. */
+        static void* operator new(std::size_t size) { return FramePool::allocate(size); }
+        static void operator delete(void* p, std::size_t size) noexcept { FramePool::deallocate(p, size); }
+
         Generator get_return_object() {
             return Generator{
                 std::coroutine_handle<promise_type>::from_promise(*this)
@@ -67,6 +165,11 @@ struct Generator {
     Generator(handle_type h) : coro(h) {}
     ~Generator() { if (coro) coro.destroy(); }
 
+    /* Generators own their coroutine frame, so they may be moved (e.g. into a container) but not copied. */
+    Generator(Generator&& other) noexcept : coro(other.coro), ready_(other.ready_) { other.coro = nullptr; }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+
     /* Conversion operator to bool: returns `true` as long as there are more values to
     generate, allows use of the idiom `(if generator) { ... }`
 
@@ -10,8 +10,22 @@ namespace NumUtils {
         return {true, {(-b - sqrtD) / a, (-b + sqrtD) / a}};
     }
 
-    double urand(double lower, double upper) {
+    double urand(std::mt19937& gen, double lower, double upper) {
         std::uniform_real_distribution<> dis(lower, upper);
         return dis(gen);
     }
+
+    std::uint64_t mix_seed(std::uint64_t seed, std::uint64_t v) {
+        // splitmix64 finaliser
+        std::uint64_t z = seed + 0x9e3779b97f4a7c15ULL * (v + 1);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    std::uint64_t mix_seed(std::uint64_t seed, std::string_view s) {
+        for (char c : s) {
+            seed = mix_seed(seed, static_cast<unsigned char>(c));
+        }
+        return seed;
+    }
 } // namespace NumUtils
\ No newline at end of file
@@ -1,12 +1,12 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 #include <random>
+#include <string_view>
 
 #include "Constants.hh"
 
-extern std::mt19937 gen; // defined properly in GTPEngine.cpp
-
 namespace NumUtils {
 	inline bool is_close(double a, double b, double tol = TOL)  {
 		return std::abs(a - b) < tol;
@@ -16,5 +16,10 @@ namespace NumUtils {
 	}
 	std::pair<bool, std::pair<double, double>> solve_quadratic(double a, double b, double c);
 
-	double urand(double lower, double upper);
+	double urand(std::mt19937& gen, double lower, double upper);
+
+	/* Deterministically derives a child seed from `seed` and `v`, so that independent random
+	streams (one per problem, one per draw) can be split off a single user-provided seed. */
+	std::uint64_t mix_seed(std::uint64_t seed, std::uint64_t v);
+	std::uint64_t mix_seed(std::uint64_t seed, std::string_view s);
 } // namespace NumUtils
\ No newline at end of file
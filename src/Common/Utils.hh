@@ -61,13 +61,13 @@ namespace Utils {
         );
     }
 
-    template <typename T>
-    std::set<T> intersect_sets(const std::set<T>& s1, const std::set<T>& s2) {
-        std::set<T> result;
+    template <typename T, typename Compare>
+    std::set<T, Compare> intersect_sets(const std::set<T, Compare>& s1, const std::set<T, Compare>& s2) {
+        std::set<T, Compare> result;
         std::set_intersection(
             s1.begin(), s1.end(),
             s2.begin(), s2.end(),
-            std::inserter(result, result.begin())
+            std::inserter(result, result.begin()), s1.key_comp()
         );
         return result;
     }
@@ -96,7 +96,7 @@ std::tuple<std::string, std::string, std::string> Construction::parse_decl_strin
     return std::make_tuple(name, args_new, args_existing);
 }
 
-Generator<std::unique_ptr<Predicate>> Construction::__instantiate_preds(
+Generator<Predicate> Construction::__instantiate_preds(
     DDEngine &dd
 ) {
     // Not implemented
@@ -110,23 +110,22 @@ bool Construction::__instantiation_check(
     return true;
 }
 
-Generator<std::unique_ptr<Predicate>> Construction::__instantiate_preds_no_checks(
+Generator<Predicate> Construction::__instantiate_preds_no_checks(
     Predicate* base_pred
 ) {
-    auto preconditions_ = preconditions.instantiate();
-    while (preconditions_) {
-        auto pre = std::move(preconditions_());
-        pre.get()->why = {base_pred};
-        pre.get()->source = pred_src::BASE;
-        pre.get()->level = Constants::MIN_LEVEL + 1;
+    for (auto& preptr : preconditions.predicates) {
+        Predicate pre(*preptr);
+        pre.why = {base_pred};
+        pre.source = pred_src::BASE;
+        pre.set_level(Constants::MIN_LEVEL + 1);
         co_yield std::move(pre);
     }
 
     for (auto& postptr : postconditions) {
-        auto post = std::move(postptr.get()->instantiate());
-        post.get()->why = {base_pred};
-        post.get()->source = pred_src::BASE;
-        post.get()->level = Constants::MIN_LEVEL + 1;
+        Predicate post(*postptr);
+        post.why = {base_pred};
+        post.source = pred_src::BASE;
+        post.set_level(Constants::MIN_LEVEL + 1);
         co_yield std::move(post);
     }
 }
@@ -153,7 +152,7 @@ void Construction::construct_no_checks(
 
     std::vector<std::string> c_new_nodes_all = StrUtils::split(_ps, " ");
     for (std::string obj_ : c_new_nodes_all) {
-        if (ggraph.points.contains(obj_)) {
+        if (ggraph.points_by_name.contains(obj_)) {
             throw InvalidTextualInputError("Error: Invalid construction stage string [" + cstage_string 
                 + "]: Construction stage new node " + obj_ + " already exists");
         }
@@ -179,7 +178,7 @@ void Construction::construct_no_checks(
         std::vector<Node*> nodes_existing;
         std::vector<Node*> nodes_new;
         for (std::string obj_ : c_existing_nodes) {
-            if (!ggraph.points.contains(obj_)) {
+            if (!ggraph.points_by_name.contains(obj_)) {
                 throw InvalidTextualInputError("Error: Invalid construction stage string [" + cstage_string 
                     + "]: Construction stage argument " + obj_ + " does not exist");
             }
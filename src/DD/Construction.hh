@@ -49,7 +49,7 @@ class Construction {
 
     /* Perform a construction according to the template given in `cstage_string`.
     Lazily returns all new predicates generated during the construction. */
-    Generator<std::unique_ptr<Predicate>> __instantiate_preds(DDEngine &dd);
+    Generator<Predicate> __instantiate_preds(DDEngine &dd);
 
     bool __instantiation_check(DDEngine &dd);
 
@@ -57,7 +57,7 @@ class Construction {
     Lazily returns all new predicates generated during the construction. 
     This variant of the instantiation method does not perform any precondition checks. Rather, it also instantiates
     the preconditions themselves as new predicates. */
-    Generator<std::unique_ptr<Predicate>> __instantiate_preds_no_checks(Predicate* base_pred);
+    Generator<Predicate> __instantiate_preds_no_checks(Predicate* base_pred);
 
     /* Perform a construction according to the template given in `cstage_string`.
     Lazily returns all new numerics generated during the construction. */
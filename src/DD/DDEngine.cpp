@@ -4,6 +4,17 @@
 #include <iostream>
 #include <ostream>
 #include <string>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <deque>
+#include <set>
+#include <array>
 
 #include "DD/DDEngine.hh"
 #include "Common/Exceptions.hh"
@@ -21,12 +32,15 @@
     #define LOG(x)
 #endif
 
+thread_local PredicateTemplate* DDEngine::delta_template = nullptr;
+
 
 /* Initialisation and adding theorems from rules.txt */
 
 DDEngine::DDEngine() {
+    pred_sets.activate();
     base_pred = std::make_unique<Predicate>();
-    base_pred->level = Constants::MIN_LEVEL;
+    base_pred->set_level(Constants::MIN_LEVEL);
     int i = 0;
     pred_t pt;
     while (pt != pred_t::LAST) {
@@ -35,6 +49,10 @@ DDEngine::DDEngine() {
     }
 }
 
+DDEngine::~DDEngine() {
+    pred_sets.deactivate();
+}
+
 void DDEngine::add_theorem_template_from_text(const std::string s) { 
 
     std::unique_ptr<Theorem> _thr = std::make_unique<Theorem>(s);
@@ -45,9 +63,320 @@ void DDEngine::add_theorem_template_from_text(const std::string s) {
         i++;
         cache_name = name + "_" + std::to_string(i);
     }
+    plans.insert({cache_name, __compile_theorem(_thr.get())});
     theorems.insert({cache_name, std::move(_thr)});
 }
 
+DDEngine::JoinPlan DDEngine::__compile_theorem(Theorem* theorem) {
+    JoinPlan plan{.theorem = theorem};
+    if (theorem->args.size() > 64) {
+        throw DDInternalError("Theorem " + theorem->name + " has more than 64 arguments");
+    }
+    std::map<Arg*, int> arg_index;
+    for (int i = 0; i < (int)theorem->args.size(); i++) arg_index[theorem->args[i].get()] = i;
+
+    std::vector<JoinStep> steps;
+    for (auto& pred_template : theorem->preconditions.predicates) {
+        pred_t name = pred_template->name;
+        if (!match_function_map.contains(name)) return plan;
+        std::uint64_t args = 0;
+        for (Arg* arg : pred_template->args) {
+            if (arg_index.contains(arg)) args |= std::uint64_t(1) << arg_index[arg];
+        }
+        steps.push_back({pred_template.get(), match_function_map.at(name), args});
+        plan.triggers |= __trigger_kinds(name);
+    }
+    plan.steps = std::move(steps);
+
+    // Until the graph is known, every precondition is estimated to have the same number of candidates
+    plan.full = __plan_steps(plan.steps, 0, {});
+    __plan_delta(plan, {});
+    for (const JoinStep& step : plan.steps) plan.planned_candidates.push_back(__step_candidates(step, {}));
+    plan.symmetries = __theorem_symmetries(theorem);
+    return plan;
+}
+
+std::vector<std::vector<int>> DDEngine::__arg_symmetries(pred_t name, int size) {
+    std::vector<int> id(size);
+    for (int i = 0; i < size; i++) id[i] = i;
+    // Generators of the group, as products of transpositions of argument positions
+    std::vector<std::vector<std::pair<int, int>>> generators;
+    auto any_order = [&](int from) {
+        for (int i = from; i + 1 < size; i++) generators.push_back({{i, i+1}});
+    };
+    switch (name) {
+        case pred_t::COLL:
+        case pred_t::CYCLIC:
+        case pred_t::DIFF:
+        case pred_t::NCOLL: any_order(0); break;
+        case pred_t::CIRCLE: any_order(1); break;
+        case pred_t::MIDP: generators = {{{1, 2}}}; break;
+        case pred_t::PARA:
+        case pred_t::PERP:
+        case pred_t::CONG:
+        case pred_t::NPARA:
+        case pred_t::NPERP:
+        case pred_t::NCONG: generators = {{{0, 1}}, {{2, 3}}, {{0, 2}, {1, 3}}}; break;
+        case pred_t::EQANGLE:
+        case pred_t::EQRATIO: generators = {{{0, 1}}, {{2, 3}}, {{4, 5}}, {{6, 7}}, {{0, 4}, {1, 5}, {2, 6}, {3, 7}}}; break;
+        case pred_t::CONTRI:
+        case pred_t::SIMTRI: generators = {{{0, 3}, {1, 4}, {2, 5}}}; break;
+        case pred_t::SAMECLOCK:
+        case pred_t::DIFFCLOCK: generators = {{{0, 3}, {1, 4}, {2, 5}}, {{0, 1}, {3, 4}}, {{1, 2}, {4, 5}}}; break;
+        case pred_t::SAMESIDE_P:
+        case pred_t::DIFFSIDE_P: generators = {{{1, 2}}}; break;
+        default: break;
+    }
+    for (auto& generator : generators) {
+        for (auto [i, j] : generator) {
+            if (i >= size || j >= size) return {id};
+        }
+    }
+
+    // Close the generators under composition
+    std::vector<std::vector<int>> group{id};
+    std::set<std::vector<int>> seen{id};
+    for (int k = 0; k < (int)group.size(); k++) {
+        for (auto& generator : generators) {
+            std::vector<int> perm = group[k];
+            for (auto [i, j] : generator) std::swap(perm[i], perm[j]);
+            if (seen.insert(perm).second) group.push_back(std::move(perm));
+        }
+    }
+    return group;
+}
+
+std::vector<std::vector<int>> DDEngine::__theorem_symmetries(Theorem* theorem) {
+    int n = theorem->args.size();
+    std::map<Arg*, int> arg_index;
+    for (int i = 0; i < n; i++) arg_index[theorem->args[i].get()] = i;
+
+    // Every predicate template, with its arguments given by their indices (and anything other than a
+    // theorem argument by a distinct negative code, which no symmetry moves), and its symmetries
+    struct Clause {
+        pred_t name;
+        std::vector<int> args;
+        std::vector<std::vector<int>> group;
+    };
+    std::map<Arg*, int> constants;
+    auto to_clause = [&](PredicateTemplate* pred_template) {
+        Clause clause{pred_template->name, {}, {}};
+        for (Arg* arg : pred_template->args) {
+            if (arg_index.contains(arg)) clause.args.push_back(arg_index[arg]);
+            else clause.args.push_back(-1 - (int)constants.try_emplace(arg, constants.size()).first->second);
+        }
+        clause.group = __arg_symmetries(clause.name, clause.args.size());
+        return clause;
+    };
+    std::vector<Clause> preconditions;
+    for (auto& pred_template : theorem->preconditions.predicates) {
+        preconditions.push_back(to_clause(pred_template.get()));
+    }
+    Clause postcondition = to_clause(theorem->postcondition.get());
+
+    // The canonical form of a clause with its arguments renamed by `sigma`: the least of its forms
+    auto canonical = [](const Clause &clause, const std::vector<int> &sigma) {
+        std::vector<int> renamed;
+        for (int a : clause.args) renamed.push_back(a >= 0 ? sigma[a] : a);
+        std::vector<int> best;
+        for (auto& perm : clause.group) {
+            std::vector<int> form;
+            for (int i : perm) form.push_back(renamed[i]);
+            if (best.empty() || form < best) best = std::move(form);
+        }
+        best.insert(best.begin(), static_cast<int>(clause.name));
+        return best;
+    };
+    auto canonical_all = [&](const std::vector<int> &sigma) {
+        std::vector<std::vector<int>> forms;
+        for (auto& clause : preconditions) forms.push_back(canonical(clause, sigma));
+        std::sort(forms.begin(), forms.end());
+        return forms;
+    };
+    std::vector<int> id(n);
+    for (int i = 0; i < n; i++) id[i] = i;
+    const auto forms = canonical_all(id);
+    const auto post_form = canonical(postcondition, id);
+
+    // Arguments can only be exchanged with arguments appearing as often in the same kinds of clauses
+    std::vector<std::vector<int>> signatures(n);
+    for (auto& clause : preconditions) {
+        for (int a : clause.args) if (a >= 0) signatures[a].push_back(static_cast<int>(clause.name));
+    }
+    for (int a : postcondition.args) if (a >= 0) signatures[a].push_back(-1);
+    for (auto& signature : signatures) std::sort(signature.begin(), signature.end());
+
+    std::vector<std::vector<int>> symmetries;
+    std::vector<int> sigma(n, -1);
+    std::vector<bool> used(n, false);
+    std::function<void(int)> extend = [&](int i) {
+        if ((int)symmetries.size() >= MAX_SYMMETRIES) return;
+        if (i == n) {
+            if (sigma != id && canonical(postcondition, sigma) == post_form && canonical_all(sigma) == forms) {
+                symmetries.push_back(sigma);
+            }
+            return;
+        }
+        for (int j = 0; j < n; j++) {
+            if (used[j] || signatures[j] != signatures[i]) continue;
+            used[j] = true;
+            sigma[i] = j;
+            extend(i + 1);
+            used[j] = false;
+        }
+        sigma[i] = -1;
+    };
+    extend(0);
+    return symmetries;
+}
+
+bool DDEngine::__breaks_symmetry(Theorem* theorem, const std::vector<std::vector<int>> &symmetries) {
+    // Point ids of the bound arguments, or -1 for arguments not bound yet
+    std::array<long, 64> ids;
+    int n = theorem->args.size();
+    for (int i = 0; i < n; i++) {
+        Arg* arg = theorem->args[i].get();
+        Point* p = arg->filled() ? arg->get_point() : nullptr;
+        ids[i] = p ? (long)p->id : -1;
+    }
+    for (auto& sigma : symmetries) {
+        // Compare the binding with its image under `sigma`, up to the first argument where they differ
+        for (int i = 0; i < n; i++) {
+            long a = ids[i], b = ids[sigma[i]];
+            if (a < 0 || b < 0) break;
+            if (a == b) continue;
+            if (a > b) return true;
+            break;
+        }
+    }
+    return false;
+}
+
+void DDEngine::__plan_delta(JoinPlan &plan, const std::map<pred_t, double> &candidates) {
+    /* Semi-naive plans: every new match must have some precondition witnessed by a changed node, so
+    there is one plan per geometric precondition (numerical preconditions, from DIFF onwards, never change
+    between passes). The remaining preconditions are planned with the arguments of the pivot bound. */
+    auto& steps = plan.steps;
+    plan.delta.clear();
+    for (int j = 0; j < (int)steps.size(); j++) {
+        if (steps[j].pred_template->name >= pred_t::DIFF) continue;
+
+        std::vector<JoinStep> rest;
+        for (int k = 0; k < (int)steps.size(); k++) {
+            if (k != j) rest.push_back(steps[k]);
+        }
+        std::vector<JoinStep> delta{steps[j]};
+        for (JoinStep& step : __plan_steps(rest, steps[j].args, candidates)) delta.push_back(step);
+        plan.delta.emplace_back(std::move(delta));
+    }
+}
+
+bool DDEngine::__refresh_plans(JoinPlan &plan, const std::map<pred_t, double> &candidates) {
+    std::vector<double> current;
+    bool drifted = false;
+    for (int i = 0; i < (int)plan.steps.size(); i++) {
+        double n = __step_candidates(plan.steps[i], candidates);
+        double planned = plan.planned_candidates[i];
+        if (std::max(n, planned) > Constants::PLAN_REORDER_GAIN * std::min(n, planned)) drifted = true;
+        current.push_back(n);
+    }
+    if (!drifted) return false;
+
+    plan.full = __plan_steps(plan.steps, 0, candidates);
+    __plan_delta(plan, candidates);
+    plan.planned_candidates = std::move(current);
+    return true;
+}
+
+std::uint32_t DDEngine::__trigger_kinds(pred_t name) {
+    switch (name) {
+        case pred_t::COLL: return GeometricGraph::DELTA_LINES;
+        case pred_t::CYCLIC:
+        case pred_t::CIRCLE: return GeometricGraph::DELTA_CIRCLES;
+        case pred_t::PARA:
+        case pred_t::PERP: return GeometricGraph::DELTA_DIRECTIONS;
+        case pred_t::CONG: return GeometricGraph::DELTA_LENGTHS;
+        case pred_t::EQANGLE: return GeometricGraph::DELTA_MEASURES;
+        case pred_t::EQRATIO: return GeometricGraph::DELTA_FRACTIONS;
+        case pred_t::MIDP: return GeometricGraph::DELTA_LINES | GeometricGraph::DELTA_LENGTHS;
+        default: return 0;
+    }
+}
+
+DDEngine::StepEstimate DDEngine::__estimate_step(const JoinStep &step, double candidates, std::uint64_t bound) {
+    int unbound = std::popcount(step.args & ~bound);
+    if (unbound == 0) return {1, 1};
+
+    // Assume that binding some of the arguments of a precondition narrows its candidates geometrically
+    double matches = std::pow(candidates, (double)unbound / std::popcount(step.args));
+    pred_t name = step.pred_template->name;
+    if (name == pred_t::EQANGLE || name == pred_t::EQRATIO) {
+        // Eqangles and eqratios scan all their candidates unless all their arguments are bound
+        return {candidates, matches};
+    }
+    return {matches, matches};
+}
+
+double DDEngine::__step_candidates(const JoinStep &step, const std::map<pred_t, double> &candidates) {
+    auto it = candidates.find(step.pred_template->name);
+    return it == candidates.end() ? 1.0 : std::max(1.0, it->second);
+}
+
+std::vector<DDEngine::JoinStep> DDEngine::__plan_steps(
+    const std::vector<JoinStep> &steps, std::uint64_t bound, const std::map<pred_t, double> &candidates) {
+
+    std::vector<JoinStep> geometric, numerical;
+    for (const JoinStep& step : steps) {
+        (step.pred_template->name >= pred_t::DIFF ? numerical : geometric).push_back(step);
+    }
+    std::vector<double> candidates_;
+    for (const JoinStep& step : geometric) candidates_.push_back(__step_candidates(step, candidates));
+
+    /* Branch and bound over the orders of the geometric preconditions. The original order is tried first,
+    and is only replaced by an order estimated to be several times cheaper, since the estimates are rough
+    and the rules are usually written with a sensible order already. */
+    int n = geometric.size();
+    std::vector<int> order, best_order;
+    std::vector<bool> used(n, false);
+    double best_cost = std::numeric_limits<double>::infinity();
+    std::function<void(std::uint64_t, double, double)> search_orders = [&](std::uint64_t bound_, double cost, double partial_matches) {
+        if (cost >= best_cost) return;
+        if ((int)order.size() == n) {
+            best_cost = best_order.empty() ? cost / Constants::PLAN_REORDER_GAIN : cost;
+            best_order = order;
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            if (used[i]) continue;
+            StepEstimate estimate = __estimate_step(geometric[i], candidates_[i], bound_);
+            used[i] = true;
+            order.push_back(i);
+            search_orders(bound_ | geometric[i].args, cost + partial_matches * estimate.work, partial_matches * estimate.matches);
+            order.pop_back();
+            used[i] = false;
+        }
+    };
+    search_orders(bound, 0, 1);
+
+    // Push each numerical precondition down to right after the arguments it checks are bound
+    std::vector<JoinStep> ordered;
+    auto push_down = [&]() {
+        std::erase_if(numerical, [&](const JoinStep& step) {
+            if (step.args & ~bound) return false;
+            ordered.push_back(step);
+            return true;
+        });
+    };
+    push_down();
+    for (int i : best_order) {
+        ordered.push_back(geometric[i]);
+        bound |= geometric[i].args;
+        push_down();
+    }
+    for (JoinStep& step : numerical) ordered.push_back(step);
+    return ordered;
+}
+
 void DDEngine::add_construction_template_from_texts(const std::tuple<std::string, std::string, std::string, std::string> v) { 
 
     std::unique_ptr<Construction> _c = std::make_unique<Construction>(v);
@@ -64,41 +393,48 @@ void DDEngine::set_conclusion(std::unique_ptr<Predicate> predicate) {
 
     conclusion = std::move(conclusion_.get()->instantiate());
     conclusion.get()->source = pred_src::DD;
-    conclusion.get()->level = Constants::MAX_LEVEL - 1;
+    conclusion.get()->set_level(Constants::MAX_LEVEL - 1);
 }
 
 
 
 
-Predicate* DDEngine::insert_predicate(std::unique_ptr<Predicate> &&predicate) {
-    Predicate* p = predicate.get();
-    std::string hash = p->hash;
-    if (has_predicate_by_hash(hash)) {
-        predicate.reset();
+Predicate* DDEngine::insert_predicate(Predicate &&predicate) {
+    PredKey key = predicate.key();
+    if (Predicate* existing = predicate_table.find(key)) {
         new_predicate = false;
-        return predicates.at(hash).get();
+        return existing;
     }
-    predicates.insert({hash, std::move(predicate)});
+    Predicate* p = predicates.emplace(std::move(predicate));
+    predicate_table.insert(p, key);
     new_predicate = true;
     return p;
 }
 
+Predicate* DDEngine::insert_new_predicate(Predicate &&predicate) {
+    Predicate* p = insert_predicate(std::move(predicate));
+    if (new_predicate) recent_predicates.emplace_back(p);
+    return p;
+}
+
+Predicate* DDEngine::insert_predicate(std::unique_ptr<Predicate> &&predicate) {
+    Predicate* p = insert_predicate(std::move(*predicate));
+    predicate.reset();
+    return p;
+}
+
 Predicate* DDEngine::insert_new_predicate(std::unique_ptr<Predicate> &&predicate) {
-    Predicate* p = predicate.get();
-    std::string hash = p->hash;
-    if (has_predicate_by_hash(hash)) {
-        predicate.reset();
-        new_predicate = false;
-        return predicates.at(hash).get();
-    }
-    predicates.insert({hash, std::move(predicate)});
-    new_predicate = true;
-    recent_predicates.emplace_back(p);
+    Predicate* p = insert_new_predicate(std::move(*predicate));
+    predicate.reset();
     return p;
 }
 
-bool DDEngine::has_predicate_by_hash(const std::string hash) {
-    return predicates.contains(hash);
+bool DDEngine::has_predicate(const PredKey &key) {
+    return predicate_table.contains(key);
+}
+
+Predicate* DDEngine::get_predicate(const std::string pred_string, std::map<std::string, Point*> &global_point_map) {
+    return predicate_table.find(Predicate::from_global_point_map(pred_string, global_point_map)->key());
 }
 
 Generator<Predicate*> DDEngine::get_recent_predicates() {
@@ -158,7 +494,7 @@ Generator<bool> DDEngine::match_coll(PredicateTemplate* pred_template, Geometric
     // Split cases based on how many args are set
     switch(k) {
         case 0b111: { // All args are set
-            if (ggraph.check_coll(p1, p2, p3)) {
+            if (p1 != p2 && p2 != p3 && p1 != p3 && ggraph.check_coll(p1, p2, p3)) {
                 co_yield true;
             }
             co_return;
@@ -168,9 +504,7 @@ Generator<bool> DDEngine::match_coll(PredicateTemplate* pred_template, Geometric
         case 0b110: { // Two args are set
             l1 = ggraph.try_get_line(p1, p2);
             if (l1) {
-                auto gen_point_l1 = l1->all_points();
-                while (gen_point_l1) {
-                    Point* pt = gen_point_l1();
+                for (Point* pt : NodeUtils::get_root(l1)->points) {
                     if (pt != p1 && pt != p2) {
                         pred_template->set_arg(unsets[0], pt);
                         co_yield true;
@@ -183,12 +517,8 @@ Generator<bool> DDEngine::match_coll(PredicateTemplate* pred_template, Geometric
         case 0b001:
         case 0b010:
         case 0b100: { // One arg is set
-            auto gen_lines = p1->on_lines();
-            while (gen_lines) {
-                l1 = gen_lines();
-                auto gen_point_pairs = l1->all_point_pairs_ordered();
-                while (gen_point_pairs) {
-                    auto [pt1, pt2] = gen_point_pairs();
+            for (Line* l1 : NodeUtils::get_root(p1)->on_root_line) {
+                for (auto [pt1, pt2] : NodeUtils::ordered_pairs(NodeUtils::get_root(l1)->points)) {
                     if (pt1 != p1 && pt2 != p1) {
                         pred_template->set_arg(unsets[0], pt1);
                         pred_template->set_arg(unsets[1], pt2);
@@ -201,13 +531,11 @@ Generator<bool> DDEngine::match_coll(PredicateTemplate* pred_template, Geometric
             co_return;
         } break;
         case 0b000: { // No args are set
-            for (Line* l1 : ggraph.root_lines) {
+            for (Line* l1 : (pred_template == delta_template) ? ggraph.delta_lines : ggraph.root_lines) {
                 if (l1->points.size() < 3) {
                     continue;
                 }
-                auto gen_point_triples = l1->all_point_triples_ordered();
-                while (gen_point_triples) {
-                    auto [pt1, pt2, pt3] = gen_point_triples();
+                for (auto [pt1, pt2, pt3] : NodeUtils::ordered_triples(NodeUtils::get_root(l1)->points)) {
                     pred_template->set_arg(0, pt1);
                     pred_template->set_arg(1, pt2);
                     pred_template->set_arg(2, pt3);
@@ -246,6 +574,11 @@ Generator<bool> DDEngine::match_cyclic(PredicateTemplate* pred_template, Geometr
     // Split cases based on how many args are set
     switch(k) {
         case 0: { // All args are set
+            for (int i1=0; i1<4; i1++) {
+                for (int i2=i1+1; i2<4; i2++) {
+                    if (points[i1] == points[i2]) co_return;
+                }
+            }
             if (ggraph.check_cyclic(points[0], points[1], points[2], points[3])) {
                 co_yield true;
             }
@@ -254,9 +587,7 @@ Generator<bool> DDEngine::match_cyclic(PredicateTemplate* pred_template, Geometr
         case 1: { // Three args are set
             c1 = ggraph.try_get_circle(points[0], points[1], points[2]);
             if (c1) {
-                auto gen_points = c1->all_points();
-                while (gen_points) {
-                    Point* pt = gen_points();
+                for (Point* pt : NodeUtils::get_root(c1)->points) {
                     if (pt != points[0] && pt != points[1] && pt != points[2]) {
                         pred_template->set_arg(unsets[0], pt);
                         co_yield true;
@@ -270,9 +601,7 @@ Generator<bool> DDEngine::match_cyclic(PredicateTemplate* pred_template, Geometr
             auto gen_circles = Circle::all_circles_through(points[0], points[1]);
             while (gen_circles) {
                 c1 = gen_circles();
-                auto gen_points = c1->all_point_pairs_ordered();
-                while (gen_points) {
-                    auto [pt2, pt3] = gen_points();
+                for (auto [pt2, pt3] : NodeUtils::ordered_pairs(NodeUtils::get_root(c1)->points)) {
                     if (pt2 != points[0] && pt2 != points[1] && pt3 != points[0] && pt3 != points[1]) {
                         pred_template->set_arg(unsets[0], pt2);
                         pred_template->set_arg(unsets[1], pt3);
@@ -285,12 +614,8 @@ Generator<bool> DDEngine::match_cyclic(PredicateTemplate* pred_template, Geometr
             co_return;
         } break;
         case 3: { // One arg is set
-            auto gen_circles = points[0]->on_circles();
-            while (gen_circles) {
-                c1 = gen_circles();
-                auto gen_points = c1->all_point_triples_ordered();
-                while (gen_points) {
-                    auto [pt1, pt2, pt3] = gen_points();
+            for (Circle* c1 : NodeUtils::get_root(points[0])->on_root_circle) {
+                for (auto [pt1, pt2, pt3] : NodeUtils::ordered_triples(NodeUtils::get_root(c1)->points)) {
                     if (pt1 != points[0] && pt2 != points[0] && pt3 != points[0]) {
                         pred_template->set_arg(unsets[0], pt1);
                         pred_template->set_arg(unsets[1], pt2);
@@ -305,13 +630,11 @@ Generator<bool> DDEngine::match_cyclic(PredicateTemplate* pred_template, Geometr
             co_return;
         } break;
         case 4: {
-            for (Circle* c1 : ggraph.root_circles) {
+            for (Circle* c1 : (pred_template == delta_template) ? ggraph.delta_circles : ggraph.root_circles) {
                 if (c1->points.size() < 4) {
                     continue;
                 }
-                auto gen_point_quads = c1->all_point_quads_ordered();
-                while (gen_point_quads) {
-                    auto [pt1, pt2, pt3, pt4] = gen_point_quads();
+                for (auto [pt1, pt2, pt3, pt4] : NodeUtils::ordered_quads(NodeUtils::get_root(c1)->points)) {
                     pred_template->set_arg(0, pt1);
                     pred_template->set_arg(1, pt2);
                     pred_template->set_arg(2, pt3);
@@ -378,13 +701,9 @@ Generator<bool> DDEngine::match_para(PredicateTemplate* pred_template, Geometric
         case 0b00: {
             switch(k2) {
                 case 0b00: {
-                    for (Direction* dir : ggraph.root_directions) {
-                        auto gen_lines = dir->all_para_pairs_ordered();
-                        while (gen_lines) {
-                            auto [l1, l2] = gen_lines();
-                            auto gen_point_pairs1 = l1->all_point_pairs_ordered();
-                            while (gen_point_pairs1) {
-                                auto [pt1, pt2] = gen_point_pairs1();
+                    for (Direction* dir : (pred_template == delta_template) ? ggraph.delta_directions : ggraph.root_directions) {
+                        for (auto [l1, l2] : NodeUtils::ordered_pairs(NodeUtils::get_root(dir)->root_objs)) {
+                            for (auto [pt1, pt2] : NodeUtils::ordered_pairs(NodeUtils::get_root(l1)->points)) {
                                 pred_template->set_arg(0, pt1);
                                 pred_template->set_arg(1, pt2);
 
@@ -393,9 +712,7 @@ Generator<bool> DDEngine::match_para(PredicateTemplate* pred_template, Geometric
                                 // `pred_template->get_arg_point()` to skip redundant cases. For clarity of 
                                 // code, we leave this out for now.
 
-                                auto gen_point_pairs2 = l2->all_point_pairs_ordered();
-                                while (gen_point_pairs2) {
-                                    auto [pt3, pt4] = gen_point_pairs2();
+                                for (auto [pt3, pt4] : NodeUtils::ordered_pairs(NodeUtils::get_root(l2)->points)) {
                                     char c2 = pred_template->set_arg(2, pt3);
                                     if (c2 != Arg::UNSUCCESSFUL_SET) {
                                         char c3 = pred_template->set_arg(3, pt4);
@@ -414,21 +731,16 @@ Generator<bool> DDEngine::match_para(PredicateTemplate* pred_template, Geometric
                 } break;
                 case 0b01:
                 case 0b10: {
-                    auto gen_l2 = p3->on_lines();
-                    while (gen_l2) {
-                        l2 = gen_l2();
-                        Direction* d2 = l2->direction;
+                    for (Line* l2 : NodeUtils::get_root(p3)->on_root_line) {
+                        if (!l2->has_direction()) continue;
+                        Direction* d2 = l2->get_direction();
                         for (Line* l1 : d2->root_objs) {
                             if (l1 == l2) continue;
-                            auto gen_point_pairs1 = l1->all_point_pairs_ordered();
-                            while (gen_point_pairs1) {
-                                auto [pt1, pt2] = gen_point_pairs1();
+                            for (auto [pt1, pt2] : NodeUtils::ordered_pairs(NodeUtils::get_root(l1)->points)) {
                                 pred_template->set_arg(0, pt1);
                                 pred_template->set_arg(1, pt2);
                                 
-                                auto gen_point_2 = l2->all_points();
-                                while (gen_point_2) {
-                                    auto pt3 = gen_point_2();
+                                for (auto pt3 : NodeUtils::get_root(l2)->points) {
                                     if (pt3 != p3) {
                                         char c2 = pred_template->set_arg(unsets[2], pt3);
                                         if (c2 != Arg::UNSUCCESSFUL_SET) co_yield true;
@@ -445,13 +757,11 @@ Generator<bool> DDEngine::match_para(PredicateTemplate* pred_template, Geometric
                 } break;
                 case 0b11: {
                     l2 = ggraph.try_get_line(p3, p4);
-                    if (l2) {
-                        Direction* d2 = l2->direction;
+                    if (l2 && l2->has_direction()) {
+                        Direction* d2 = l2->get_direction();
                         for (Line* l1 : d2->root_objs) {
                             if (l1 == l2) continue;
-                            auto gen_point_pairs1 = l1->all_point_pairs_ordered();
-                            while (gen_point_pairs1) {
-                                auto [pt1, pt2] = gen_point_pairs1();
+                            for (auto [pt1, pt2] : NodeUtils::ordered_pairs(NodeUtils::get_root(l1)->points)) {
                                 pred_template->set_arg(0, pt1);
                                 pred_template->set_arg(1, pt2);
                                 co_yield true;
@@ -466,12 +776,8 @@ Generator<bool> DDEngine::match_para(PredicateTemplate* pred_template, Geometric
         } break;
         case 0b01:
         case 0b10: {
-            auto gen_l1 = p1->on_lines();
-            while (gen_l1) {
-                l1 = gen_l1();
-                auto gen_point_1 = l1->all_points();
-                while (gen_point_1) {
-                    auto pt2 = gen_point_1();
+            for (Line* l1 : NodeUtils::get_root(p1)->on_root_line) {
+                for (auto pt2 : NodeUtils::get_root(l1)->points) {
                     if (pt2 == p1) continue;
                     pred_template->set_arg(unsets[0], pt2);
 
@@ -487,9 +793,7 @@ Generator<bool> DDEngine::match_para(PredicateTemplate* pred_template, Geometric
                             case 0b00: {
                                 for (Line* l2 : d1->root_objs) {
                                     if (l2 == l1) continue;
-                                    auto gen_point_pairs2 = l2->all_point_pairs_ordered();
-                                    while (gen_point_pairs2) {
-                                        auto [pt3, pt4] = gen_point_pairs2();
+                                    for (auto [pt3, pt4] : NodeUtils::ordered_pairs(NodeUtils::get_root(l2)->points)) {
                                         char c2 = pred_template->set_arg(2, pt3);
                                         if (c2 != Arg::UNSUCCESSFUL_SET) {
                                             char c3 = pred_template->set_arg(3, pt4);
@@ -502,13 +806,9 @@ Generator<bool> DDEngine::match_para(PredicateTemplate* pred_template, Geometric
                             } break;
                             case 0b01:
                             case 0b10: {
-                                auto gen_l2 = p3->on_lines();
-                                while (gen_l2) {
-                                    l2 = gen_l2();
+                                for (Line* l2 : NodeUtils::get_root(p3)->on_root_line) {
                                     if (ggraph.check_para(l1, l2) && l1 != l2) {
-                                        auto gen_point_2 = l2->all_points();
-                                        while (gen_point_2) {
-                                            auto pt3 = gen_point_2();
+                                        for (auto pt3 : NodeUtils::get_root(l2)->points) {
                                             if (pt3 != p3) {
                                                 char c2 = pred_template->set_arg(unsets[2], pt3);
                                                 if (c2 != Arg::UNSUCCESSFUL_SET) co_yield true;
@@ -550,9 +850,7 @@ Generator<bool> DDEngine::match_para(PredicateTemplate* pred_template, Geometric
                     switch(k2) {
                         case 0b00: {
                             for (Line* l2 : d1->root_objs) {
-                                auto gen_point_pairs2 = l2->all_point_pairs_ordered();
-                                while (gen_point_pairs2) {
-                                    auto [pt1, pt2] = gen_point_pairs2();
+                                for (auto [pt1, pt2] : NodeUtils::ordered_pairs(NodeUtils::get_root(l2)->points)) {
                                     pred_template->set_arg(2, pt1);
                                     pred_template->set_arg(3, pt2);
                                     co_yield true;
@@ -563,13 +861,9 @@ Generator<bool> DDEngine::match_para(PredicateTemplate* pred_template, Geometric
                         } break;
                         case 0b01:
                         case 0b10: {
-                            auto gen_l2 = p3->on_lines();
-                            while (gen_l2) {
-                                l2 = gen_l2();
+                            for (Line* l2 : NodeUtils::get_root(p3)->on_root_line) {
                                 if (ggraph.check_para(l1, l2)) {
-                                    auto gen_point_2 = l2->all_points();
-                                    while (gen_point_2) {
-                                        auto pt3 = gen_point_2();
+                                    for (auto pt3 : NodeUtils::get_root(l2)->points) {
                                         if (pt3 != p3) {
                                             pred_template->set_arg(unsets[2], pt3);
                                             co_yield true;
@@ -644,18 +938,14 @@ Generator<bool> DDEngine::match_perp(PredicateTemplate* pred_template, Geometric
         case 0b00: {
             switch(k2) {
                 case 0b00: {
-                    for (Direction* dir : ggraph.root_directions) {
+                    for (Direction* dir : (pred_template == delta_template) ? ggraph.delta_directions : ggraph.root_directions) {
                         auto gen_lines = dir->all_perp_pairs_ordered();
                         while (gen_lines) {
                             auto [l1, l2] = gen_lines();
-                            auto gen_point_pairs1 = l1->all_point_pairs_ordered();
-                            while (gen_point_pairs1) {
-                                auto [pt1, pt2] = gen_point_pairs1();
+                            for (auto [pt1, pt2] : NodeUtils::ordered_pairs(NodeUtils::get_root(l1)->points)) {
                                 pred_template->set_arg(0, pt1);
                                 pred_template->set_arg(1, pt2);
-                                auto gen_point_pairs2 = l2->all_point_pairs_ordered();
-                                while (gen_point_pairs2) {
-                                    auto [pt3, pt4] = gen_point_pairs2();
+                                for (auto [pt3, pt4] : NodeUtils::ordered_pairs(NodeUtils::get_root(l2)->points)) {
                                     char c2 = pred_template->set_arg(2, pt3);
                                     if (c2 != Arg::UNSUCCESSFUL_SET) {
                                         char c3 = pred_template->set_arg(3, pt4);
@@ -673,21 +963,16 @@ Generator<bool> DDEngine::match_perp(PredicateTemplate* pred_template, Geometric
                 } break;
                 case 0b01:
                 case 0b10: {
-                    auto gen_l2 = p3->on_lines();
-                    while (gen_l2) {
-                        l2 = gen_l2();
-                        Direction* d2 = l2->direction;
+                    for (Line* l2 : NodeUtils::get_root(p3)->on_root_line) {
+                        if (!l2->has_direction()) continue;
+                        Direction* d2 = l2->get_direction();
                         if (!d2->has_perp()) continue;
                         d2 = d2->get_perp();
                         for (Line* l1 : d2->root_objs) {
-                            auto gen_point_pairs1 = l1->all_point_pairs_ordered();
-                            while (gen_point_pairs1) {
-                                auto [pt1, pt2] = gen_point_pairs1();
+                            for (auto [pt1, pt2] : NodeUtils::ordered_pairs(NodeUtils::get_root(l1)->points)) {
                                 pred_template->set_arg(0, pt1);
                                 pred_template->set_arg(1, pt2);
-                                auto gen_point_2 = l2->all_points();
-                                while (gen_point_2) {
-                                    auto pt3 = gen_point_2();
+                                for (auto pt3 : NodeUtils::get_root(l2)->points) {
                                     if (pt3 != p3) {
                                         char c2 = pred_template->set_arg(unsets[2], pt3);
                                         if (c2 != Arg::UNSUCCESSFUL_SET) co_yield true;
@@ -703,13 +988,10 @@ Generator<bool> DDEngine::match_perp(PredicateTemplate* pred_template, Geometric
                 } break;
                 case 0b11: {
                     l2 = ggraph.try_get_line(p3, p4);
-                    if (l2) {
-                        Direction* d2 = l2->direction;
+                    if (l2 && l2->has_direction() && l2->get_direction()->has_perp()) {
+                        Direction* d2 = l2->get_direction()->get_perp();
                         for (Line* l1 : d2->root_objs) {
-                            if (l1 == l2) continue;
-                            auto gen_point_pairs1 = l1->all_point_pairs_ordered();
-                            while (gen_point_pairs1) {
-                                auto [pt1, pt2] = gen_point_pairs1();
+                            for (auto [pt1, pt2] : NodeUtils::ordered_pairs(NodeUtils::get_root(l1)->points)) {
                                 pred_template->set_arg(0, pt1);
                                 pred_template->set_arg(1, pt2);
                                 co_yield true;
@@ -724,24 +1006,18 @@ Generator<bool> DDEngine::match_perp(PredicateTemplate* pred_template, Geometric
         } break;
         case 0b01:
         case 0b10: {
-            auto gen_l1 = p1->on_lines();
-            while (gen_l1) {
-                l1 = gen_l1();
+            for (Line* l1 : NodeUtils::get_root(p1)->on_root_line) {
                 if (!l1->has_direction()) continue;
                 Direction* d1 = l1->get_direction();
-                auto gen_point_1 = l1->all_points();
-                while (gen_point_1) {
-                    auto pt1 = gen_point_1();
+                for (auto pt1 : NodeUtils::get_root(l1)->points) {
                     if (pt1 == p1) continue;
                     pred_template->set_arg(unsets[0], pt1);
                     
                     switch(k2) {
                         case 0b00: {
-                            for (Line* l2 : d1->root_objs) {
-                                if (l2 == l1) continue;
-                                auto gen_point_pairs2 = l2->all_point_pairs_ordered();
-                                while (gen_point_pairs2) {
-                                    auto [pt3, pt4] = gen_point_pairs2();
+                            if (!d1->has_perp()) break;
+                            for (Line* l2 : d1->get_perp()->root_objs) {
+                                for (auto [pt3, pt4] : NodeUtils::ordered_pairs(NodeUtils::get_root(l2)->points)) {
                                     char c2 = pred_template->set_arg(2, pt3);
                                     if (c2 != Arg::UNSUCCESSFUL_SET) {
                                         char c3 = pred_template->set_arg(3, pt4);
@@ -754,13 +1030,9 @@ Generator<bool> DDEngine::match_perp(PredicateTemplate* pred_template, Geometric
                         } break;
                         case 0b01:
                         case 0b10: {
-                            auto gen_l2 = p3->on_lines();
-                            while (gen_l2) {
-                                l2 = gen_l2();
+                            for (Line* l2 : NodeUtils::get_root(p3)->on_root_line) {
                                 if (ggraph.check_perp(l1, l2) && l1 != l2) {
-                                    auto gen_point_2 = l2->all_points();
-                                    while (gen_point_2) {
-                                        auto pt3 = gen_point_2();
+                                    for (auto pt3 : NodeUtils::get_root(l2)->points) {
                                         if (pt3 != p3) {
                                             char c2 = pred_template->set_arg(unsets[2], pt3);
                                             if (c2 != Arg::UNSUCCESSFUL_SET) co_yield true;
@@ -795,9 +1067,7 @@ Generator<bool> DDEngine::match_perp(PredicateTemplate* pred_template, Geometric
                         if (!d1->has_perp()) break;
                         d1 = d1->get_perp();
                         for (Line* l2 : d1->root_objs) {
-                            auto gen_point_pairs2 = l2->all_point_pairs_ordered();
-                            while (gen_point_pairs2) {
-                                auto [pt3, pt4] = gen_point_pairs2();
+                            for (auto [pt3, pt4] : NodeUtils::ordered_pairs(NodeUtils::get_root(l2)->points)) {
                                 pred_template->set_arg(2, pt3);
                                 pred_template->set_arg(3, pt4);
                                 co_yield true;
@@ -808,13 +1078,9 @@ Generator<bool> DDEngine::match_perp(PredicateTemplate* pred_template, Geometric
                     } break;
                     case 0b01:
                     case 0b10: {
-                        auto gen_l2 = p3->on_lines();
-                        while (gen_l2) {
-                            l2 = gen_l2();
+                        for (Line* l2 : NodeUtils::get_root(p3)->on_root_line) {
                             if (ggraph.check_perp(l1, l2) && l1 != l2) {
-                                auto gen_point_2 = l2->all_points();
-                                while (gen_point_2) {
-                                    auto pt3 = gen_point_2();
+                                for (auto pt3 : NodeUtils::get_root(l2)->points) {
                                     if (pt3 != p3) {
                                         pred_template->set_arg(unsets[2], pt3);
                                         co_yield true;
@@ -885,10 +1151,8 @@ Generator<bool> DDEngine::match_cong(PredicateTemplate* pred_template, Geometric
         case 0b00: {
             switch(k2) {
                 case 0b00: {
-                    for (Length* l : ggraph.root_lengths) {
-                        auto gen_cong_pairs = l->all_cong_pairs_ordered();
-                        while (gen_cong_pairs) {
-                            auto [s1, s2] = gen_cong_pairs();
+                    for (Length* l : (pred_template == delta_template) ? ggraph.delta_lengths : ggraph.root_lengths) {
+                        for (auto [s1, s2] : NodeUtils::ordered_pairs(NodeUtils::get_root(l)->root_objs)) {
                             auto [p1, p2] = s1->endpoints;
                             auto [p3, p4] = s2->endpoints;
 
@@ -918,9 +1182,7 @@ Generator<bool> DDEngine::match_cong(PredicateTemplate* pred_template, Geometric
                 } break;
                 case 0b01:
                 case 0b10: {
-                    auto gen_s2 = p3->endpoint_of_segments();
-                    while (gen_s2) {
-                        Segment* s2 = gen_s2();
+                    for (Segment* s2 : NodeUtils::get_root(p3)->endpoint_of_root_segment) {
                         if (!s2->has_length()) continue;
                         Point* pt4 = s2->other_endpoint(p3);
                         Length* l = s2->get_length();
@@ -964,9 +1226,7 @@ Generator<bool> DDEngine::match_cong(PredicateTemplate* pred_template, Geometric
         } break;
         case 0b01:
         case 0b10: {
-            auto gen_s1 = p1->endpoint_of_segments();
-            while (gen_s1) {
-                Segment* s1 = gen_s1();
+            for (Segment* s1 : NodeUtils::get_root(p1)->endpoint_of_root_segment) {
                 Point* pt2 = s1->other_endpoint(p1);
                 pred_template->set_arg(unsets[0], pt2);
 
@@ -1058,7 +1318,7 @@ Generator<bool> DDEngine::match_cong(PredicateTemplate* pred_template, Geometric
                         case 0b11: {
                             Segment* s2 = ggraph.try_get_segment(p3, p4);
                             if (s2) {
-                                if (s2 != s1 && ggraph.check_cong(s1, s2)) {
+                                if (ggraph.check_cong(s1, s2)) {
                                     co_yield true;
                                 }
                             }
@@ -1100,9 +1360,7 @@ Generator<bool> DDEngine::__match_eqangle(PredicateTemplate* pred_template, Geom
         case 0b10: {
             for (auto l : d->root_objs) {
                 if (l->contains(p1)) {
-                    auto gen_points = l->all_points();
-                    while (gen_points) {
-                        Point* pt = gen_points();
+                    for (Point* pt : NodeUtils::get_root(l)->points) {
                         if (pt != p1) {
                             pred_template->set_arg(i*2 + 1, pt);
                             auto rec = __match_eqangle(pred_template, ggraph, i + 1, ds);
@@ -1122,9 +1380,7 @@ Generator<bool> DDEngine::__match_eqangle(PredicateTemplate* pred_template, Geom
         case 0b01: {
             for (auto l : d->root_objs) {
                 if (l->contains(p2)) {
-                    auto gen_points = l->all_points();
-                    while (gen_points) {
-                        Point* pt = gen_points();
+                    for (Point* pt : NodeUtils::get_root(l)->points) {
                         if (pt != p2) {
                             pred_template->set_arg(i*2, pt);
                             auto rec = __match_eqangle(pred_template, ggraph, i + 1, ds);
@@ -1142,9 +1398,7 @@ Generator<bool> DDEngine::__match_eqangle(PredicateTemplate* pred_template, Geom
         } break;
         case 0b00: {
             for (auto l : d->root_objs) {
-                auto gen_point_pairs = l->all_point_pairs_ordered();
-                while (gen_point_pairs) {
-                    auto [pt1, pt2] = gen_point_pairs();
+                for (auto [pt1, pt2] : NodeUtils::ordered_pairs(NodeUtils::get_root(l)->points)) {
                     pred_template->set_arg(i*2, pt1);
                     pred_template->set_arg(i*2 + 1, pt2);   
                     auto rec = __match_eqangle(pred_template, ggraph, i + 1, ds);
@@ -1210,11 +1464,9 @@ Generator<bool> DDEngine::match_eqangle(PredicateTemplate* pred_template, Geomet
     } else {
 
         if (ggraph.root_measures.size() > 0) {
-            for (Measure* m : ggraph.root_measures) {
+            for (Measure* m : (pred_template == delta_template) ? ggraph.delta_measures : ggraph.root_measures) {
                 if (m->val == Frac(0)) continue;
-                auto gen_angle_pairs = m->all_eq_pairs_ordered();
-                while (gen_angle_pairs) {
-                    auto [angle1, angle2] = gen_angle_pairs();
+                for (auto [angle1, angle2] : NodeUtils::ordered_pairs(NodeUtils::get_root(m)->root_obj2s)) {
 
                     // Match points for the first angle
                     Direction* d1 = angle1->direction1, *d2 = angle1->direction2, *d3 = angle2->direction1, *d4 = angle2->direction2;
@@ -1382,11 +1634,9 @@ Generator<bool> DDEngine::match_eqratio(PredicateTemplate* pred_template, Geomet
 
     } else {
 
-        for (Fraction* f : ggraph.root_fractions) {
+        for (Fraction* f : (pred_template == delta_template) ? ggraph.delta_fractions : ggraph.root_fractions) {
             if (f->val == Frac(0)) continue;
-            auto gen_segment_pairs = f->all_eq_pairs_ordered();
-            while (gen_segment_pairs) {
-                auto [ratio1, ratio2] = gen_segment_pairs();
+            for (auto [ratio1, ratio2] : NodeUtils::ordered_pairs(NodeUtils::get_root(f)->root_obj2s)) {
 
                 // Match points for the first ratio
                 Length* l1 = ratio1->length1, *l2 = ratio1->length2, *l3 = ratio2->length1, *l4 = ratio2->length2;
@@ -1439,9 +1689,7 @@ Generator<bool> DDEngine::match_midp(PredicateTemplate* pred_template, Geometric
     if (a) {
         switch(k) {
             case 0b00: {
-                auto gen_seg_pairs = m->endpoint_of_segment_pairs_ordered();
-                while (gen_seg_pairs) {
-                    auto [s1, s2] = gen_seg_pairs();
+                for (auto [s1, s2] : NodeUtils::ordered_pairs(NodeUtils::get_root(m)->endpoint_of_root_segment)) {
                     if (!ggraph.check_coll(s1, s2)) continue;
                     if (!ggraph.check_cong(s1, s2)) continue;
                     Point* pt1 = s1->other_endpoint(m);
@@ -1482,9 +1730,7 @@ Generator<bool> DDEngine::match_midp(PredicateTemplate* pred_template, Geometric
         switch(k) {
             case 0b00: {
                 for (Length* l : ggraph.root_lengths) {
-                    auto gen_seg_pairs = l->all_cong_pairs_ordered();
-                    while (gen_seg_pairs) {
-                        auto [s1, s2] = gen_seg_pairs();
+                    for (auto [s1, s2] : NodeUtils::ordered_pairs(NodeUtils::get_root(l)->root_objs)) {
                         if (!ggraph.check_coll(s1, s2)) continue;
                         auto [pt1, pt2] = s1->endpoints;
                         if (Point* pt3 = s2->other_endpoint(pt2)) {
@@ -1509,9 +1755,7 @@ Generator<bool> DDEngine::match_midp(PredicateTemplate* pred_template, Geometric
                 }
             } break;
             case 0b10: {
-                auto gen_seg_1 = p1->endpoint_of_segments();
-                while (gen_seg_1) {
-                    s1 = gen_seg_1();
+                for (Segment* s1 : NodeUtils::get_root(p1)->endpoint_of_root_segment) {
                     if (!s1->has_length()) continue;
                     Point* pm = s1->other_endpoint(p1);
                     Length* l1 = s1->get_length();
@@ -1529,9 +1773,7 @@ Generator<bool> DDEngine::match_midp(PredicateTemplate* pred_template, Geometric
                 }
             } break;
             case 0b11: {
-                auto gen_seg_1 = p1->endpoint_of_segments();
-                while (gen_seg_1) {
-                    s1 = gen_seg_1();
+                for (Segment* s1 : NodeUtils::get_root(p1)->endpoint_of_root_segment) {
                     Point* pm = s1->other_endpoint(p1);
                     s2 = ggraph.try_get_segment(pm, p2);
                     if (!s2) continue;
@@ -1613,15 +1855,13 @@ Generator<bool> DDEngine::match_circle(PredicateTemplate* pred_template, Geometr
     } else {
         switch(k) {
             case 0b000: {
-                for (Circle* c : ggraph.root_circles) {
+                for (Circle* c : (pred_template == delta_template) ? ggraph.delta_circles : ggraph.root_circles) {
                     if (!c->has_center()) continue;
                     if (c->points.size() < 3) continue;
                     cp = c->get_center();
                     pred_template->set_arg(0, cp);
 
-                    auto gen_point_triples = c->all_point_triples_ordered();
-                    while (gen_point_triples) {
-                        auto [pt1, pt2, pt3] = gen_point_triples();
+                    for (auto [pt1, pt2, pt3] : NodeUtils::ordered_triples(NodeUtils::get_root(c)->points)) {
                         pred_template->set_arg(1, pt1);
                         pred_template->set_arg(2, pt2);
                         pred_template->set_arg(3, pt3);
@@ -1636,15 +1876,11 @@ Generator<bool> DDEngine::match_circle(PredicateTemplate* pred_template, Geometr
             case 0b001:
             case 0b010:
             case 0b100: {
-                auto gen_circ = p1->on_circles();
-                while (gen_circ) {
-                    Circle* c = gen_circ();
+                for (Circle* c : NodeUtils::get_root(p1)->on_root_circle) {
                     cp = c->get_center();
                     pred_template->set_arg(0, cp);
 
-                    auto gen_point_pairs = c->all_point_pairs_ordered();
-                    while (gen_point_pairs) {
-                        auto [pt2, pt3] = gen_point_pairs();
+                    for (auto [pt2, pt3] : NodeUtils::ordered_pairs(NodeUtils::get_root(c)->points)) {
                         if (pt2 != p1 && pt3 != p1) {
                             pred_template->set_arg(unsets[0], pt2);
                             pred_template->set_arg(unsets[1], pt3);
@@ -1659,17 +1895,13 @@ Generator<bool> DDEngine::match_circle(PredicateTemplate* pred_template, Geometr
             case 0b011:
             case 0b101:
             case 0b110: {
-                auto gen_circ = p1->on_circles();
-                while (gen_circ) {
-                    Circle* c = gen_circ();
+                for (Circle* c : NodeUtils::get_root(p1)->on_root_circle) {
                     if (!c->has_center()) continue;
                     if (c->contains(p2)) {
                         cp = c->get_center();
                         pred_template->set_arg(0, cp);
 
-                        auto gen_p3 = c->all_points();
-                        while (gen_p3) {
-                            Point* pt3 = gen_p3();
+                        for (Point* pt3 : NodeUtils::get_root(c)->points) {
                             if (pt3 != p1 && pt3 != p2) {
                                 pred_template->set_arg(unsets[0], pt3);
                                 co_yield true;
@@ -1698,7 +1930,7 @@ Generator<bool> DDEngine::match_diff(PredicateTemplate* pred_template, Geometric
     if (!pred_template->args_filled()) {
         throw DDInternalError("DIFF predicate requires all arguments to be set for matching.");
     }
-    std::set<Point*> pts;
+    std::set<Point*, NodeOrder> pts;
     for (Arg* arg : pred_template->args) {
         Point* p = arg->get_point();
         if (pts.contains(p)) co_return;
@@ -1713,7 +1945,7 @@ Generator<bool> DDEngine::match_ncoll(PredicateTemplate* pred_template, Geometri
         throw DDInternalError("NCOLL predicate requires all arguments to be set for matching.");
     }
     int i = 0;
-    std::set<Point*> pts;
+    std::set<Point*, NodeOrder> pts;
     for (Arg* arg : pred_template->args) {
         Point* p = arg->get_point();
         if (i < 2) {
@@ -1825,113 +2057,419 @@ Generator<bool> DDEngine::match_diffside_p(PredicateTemplate* pred_template, Geo
     co_return;
 }
 
-Generator<bool> DDEngine::match(Theorem* theorem, int i, int n, GeometricGraph &ggraph) {
+long DDEngine::__enumeration_work(pred_t name, GeometricGraph &ggraph, bool delta) {
+    auto pairs = [](long k) { return k * (k - 1); };
+    long work = 0;
+    switch (name) {
+        case pred_t::COLL: {
+            for (Line* l : delta ? ggraph.delta_lines : ggraph.root_lines) work += pairs(l->points.size());
+        } break;
+        case pred_t::CYCLIC:
+        case pred_t::CIRCLE: {
+            for (Circle* c : delta ? ggraph.delta_circles : ggraph.root_circles) work += pairs(c->points.size());
+        } break;
+        case pred_t::PARA: {
+            for (Direction* d : delta ? ggraph.delta_directions : ggraph.root_directions) work += pairs(d->root_objs.size());
+        } break;
+        case pred_t::PERP: {
+            for (Direction* d : delta ? ggraph.delta_directions : ggraph.root_directions) {
+                if (d->has_perp()) work += d->root_objs.size() * d->get_perp()->root_objs.size();
+            }
+        } break;
+        case pred_t::CONG: {
+            for (Length* l : delta ? ggraph.delta_lengths : ggraph.root_lengths) work += pairs(l->root_objs.size());
+        } break;
+        case pred_t::EQANGLE: {
+            for (Measure* m : delta ? ggraph.delta_measures : ggraph.root_measures) work += pairs(m->root_obj2s.size());
+        } break;
+        case pred_t::EQRATIO: {
+            for (Fraction* f : delta ? ggraph.delta_fractions : ggraph.root_fractions) work += pairs(f->root_obj2s.size());
+        } break;
+        case pred_t::MIDP: {
+            // Midpoints are always matched against all nodes
+            for (Length* l : ggraph.root_lengths) work += pairs(l->root_objs.size());
+        } break;
+        default: {
+            // Numerical predicates cannot be enumerated without bound arguments
+            work = delta ? 0 : LONG_MAX;
+        } break;
+    }
+    return work;
+}
+
+double DDEngine::__count_candidates(pred_t name, GeometricGraph &ggraph) {
+    auto triples = [](double k) { return k * (k - 1) * (k - 2); };
+    // Ordered pairs of distinct elements drawn from groups of the given sizes, across two different groups
+    auto cross_pairs = [](double sum, double sum_of_squares) { return sum * sum - sum_of_squares; };
+    // Ordered point pairs spanning the lines of a direction, and segments (either way round) of a length
+    auto point_pairs = [](Direction* d) {
+        double n = 0;
+        for (Line* l : NodeUtils::get_root(d)->root_objs) {
+            double k = NodeUtils::get_root(l)->points.size();
+            n += k * (k - 1);
+        }
+        return n;
+    };
+    auto segments = [](Length* l) { return 2.0 * NodeUtils::get_root(l)->root_objs.size(); };
+
+    double candidates = 0;
+    switch (name) {
+        case pred_t::COLL:
+        case pred_t::MIDP: {
+            for (Line* l : ggraph.root_lines) candidates += triples(l->points.size());
+        } break;
+        case pred_t::CYCLIC:
+        case pred_t::CIRCLE: {
+            for (Circle* c : ggraph.root_circles) {
+                double k = c->points.size();
+                candidates += triples(k) * std::max(1.0, k - 3);
+            }
+        } break;
+        case pred_t::PARA: {
+            for (Direction* d : ggraph.root_directions) {
+                double sum = 0, sum_of_squares = 0;
+                for (Line* l : d->root_objs) {
+                    double k = NodeUtils::get_root(l)->points.size();
+                    sum += k * (k - 1);
+                    sum_of_squares += k * (k - 1) * k * (k - 1);
+                }
+                candidates += cross_pairs(sum, sum_of_squares);
+            }
+        } break;
+        case pred_t::PERP: {
+            for (Direction* d : ggraph.root_directions) {
+                if (d->has_perp()) candidates += point_pairs(d) * point_pairs(d->get_perp());
+            }
+        } break;
+        case pred_t::CONG: {
+            for (Length* l : ggraph.root_lengths) {
+                double k = segments(l);
+                candidates += k * (k - 2);
+            }
+        } break;
+        case pred_t::EQANGLE: {
+            for (Measure* m : ggraph.root_measures) {
+                double sum = 0, sum_of_squares = 0;
+                for (Angle* a : m->root_obj2s) {
+                    double k = point_pairs(a->direction1) * point_pairs(a->direction2);
+                    sum += k;
+                    sum_of_squares += k * k;
+                }
+                candidates += cross_pairs(sum, sum_of_squares);
+            }
+        } break;
+        case pred_t::EQRATIO: {
+            for (Fraction* f : ggraph.root_fractions) {
+                double sum = 0, sum_of_squares = 0;
+                for (Ratio* r : f->root_obj2s) {
+                    double k = segments(r->length1) * segments(r->length2);
+                    sum += k;
+                    sum_of_squares += k * k;
+                }
+                candidates += cross_pairs(sum, sum_of_squares);
+            }
+        } break;
+        default: break;
+    }
+    return candidates;
+}
 
-    if (i == n) {
-        if (!ggraph.check(theorem->postcondition.get())) {
+int DDEngine::match(Theorem* theorem, const std::vector<JoinStep> &plan, const std::vector<std::vector<int>> &symmetries,
+    GeometricGraph &ggraph, TheoremResult &result) {
+    if (plan.empty()) return 0;
+    PredicateTemplate* postcondition = theorem->postcondition.get();
+    int matches = 0;
+
+    // The matchers of the preconditions bound so far, with the innermost last
+    std::vector<Generator<bool>> stack;
+    stack.reserve(plan.size());
+    stack.emplace_back((this->*plan[0].matcher)(plan[0].pred_template, ggraph));
+
+    while (!stack.empty()) {
+        Generator<bool>& matcher = stack.back();
+        if (!matcher) {
+            stack.pop_back();
+            continue;
+        }
+        if (!matcher()) continue;
 
+        // Skip over partial matches outside the region around the goal
+        if (relevance_limit >= 0 && !__is_relevant(plan[stack.size() - 1].pred_template)) continue;
 
-            std::unique_ptr<Predicate> pred_ = theorem->instantiate_postcondition();
-            Predicate* pred = pred_.get();
-            // if (!ggraph.num_check(pred)) {
-            //     throw GGraphInternalError("The following predicate failed num_check: " 
-            //         + theorem->to_string());
-            // }
-            pred->source = pred_src::DD;
+        // Skip over partial matches which are not the least of their images under the symmetries of the theorem
+        if (!symmetries.empty() && __breaks_symmetry(theorem, symmetries)) continue;
 
-            auto whys_ = theorem->instantiate_preconditions();
-            while (whys_) {
-                Predicate* why = insert_predicate(std::move(whys_()));
-                if (new_predicate) why->source = pred_src::GGRAPH;
-                pred->why += why;
-            }
+        // Skip over matches where the postcondition is already known
+        if (__check_postcondition(postcondition, ggraph)) continue;
 
-            insert_new_predicate(std::move(pred_));
-            co_yield true;
+        if (stack.size() < plan.size()) {
+            const JoinStep& step = plan[stack.size()];
+            stack.emplace_back((this->*step.matcher)(step.pred_template, ggraph));
+            continue;
+        }
 
+        // In semi-naive passes, the same match may be found once for every changed precondition
+        if (delta_template && postcondition->args_filled()) {
+            PredKey key = postcondition->to_key();
+            if (has_predicate(key) || result.postconditions.contains(key)) continue;
         }
-        co_return;
+
+        Derivation& derivation = result.derivations.emplace_back(
+            theorem->instantiate_postcondition(), theorem->instantiate_preconditions()
+        );
+        // if (!ggraph.num_check(&derivation.pred)) {
+        //     throw GGraphInternalError("The following predicate failed num_check: " 
+        //         + theorem->to_string());
+        // }
+        result.postconditions.insert(&derivation.pred);
+        matches += 1;
     }
-    PredicateTemplate* pred_template = theorem->preconditions.predicates[i].get();
-    pred_t ptype = pred_template->name;
+    return matches;
+}
 
-    if (!match_function_map.contains(ptype)) {
-        co_return;
+void DDEngine::__match_theorem(JoinPlan &plan, bool full_pass, const std::map<pred_t, double> &candidates,
+    const std::map<pred_t, long> &root_work, const std::map<pred_t, long> &delta_work,
+    GeometricGraph &ggraph, TheoremResult &result) {
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Theorem* theorem = plan.theorem;
+    __refresh_plans(plan, candidates);
+
+    bool full_pass_ = full_pass || plan.full.empty();
+    if (!full_pass_) {
+        // The semi-naive pass enumerates the changed nodes of every precondition, whereas the
+        // full pass only enumerates all nodes of the first one
+        long delta_work_ = 0;
+        for (auto& pred_template : theorem->preconditions.predicates) {
+            delta_work_ += delta_work.at(pred_template->name);
+        }
+        full_pass_ = (delta_work_ >= root_work.at(plan.full[0].pred_template->name));
     }
-    Generator<bool> pred_matcher = (this->*match_function_map[ptype])(pred_template, ggraph);
-    
-    while (pred_matcher) {
-        if (pred_matcher()) {
-            // Skip over matches where the postcondition is already known
-            if (ggraph.check(theorem->postcondition.get())) continue;
-
-            Generator<bool> rec = match(theorem, i + 1, n, ggraph);
-            while (rec) {
-                if (rec()) {
-                    co_yield true;
-                }
-            }
+
+    if (full_pass_) {
+        result.matches += match(theorem, plan.full, plan.symmetries, ggraph, result);
+    } else {
+        result.full_pass = false;
+        // Semi-naive pass: match each of the delta plans in turn (see `__compile_theorem()`)
+        for (auto& delta : plan.delta) {
+            delta_template = delta[0].pred_template;
+            result.matches += match(theorem, delta, plan.symmetries, ggraph, result);
+            delta_template = nullptr;
+            theorem->__clear_args();
         }
     }
-    co_return;
-}
+    LOG("Matches for theorem " << theorem->to_string_with_placeholders() << ": " << result.matches);
+    theorem->__clear_args();
 
+    auto end_time = std::chrono::high_resolution_clock::now();
+    result.duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+}
 
+int DDEngine::__merge_derivations(TheoremResult &result) {
+    int merged = 0;
+    for (Derivation& derivation : result.derivations) {
+        if (has_predicate(derivation.pred.key())) continue;
+
+        Predicate& pred = derivation.pred;
+        pred.source = pred_src::DD;
+        for (auto& why_ : derivation.whys) {
+            Predicate* why = insert_predicate(std::move(why_));
+            if (new_predicate) why->source = pred_src::GGRAPH;
+            pred.why += why;
+        }
+        insert_new_predicate(std::move(derivation.pred));
+        merged += 1;
+    }
+    result.postconditions.clear();
+    result.derivations.clear();
+    return merged;
+}
 
 
 
 void DDEngine::search(GeometricGraph &ggraph, Profiler& profiler) {
 
-    for (auto& thr : theorems) {
-        auto start_time = std::chrono::high_resolution_clock::now();
+    ggraph.collect_changes();
+    check_memo.next_pass();
+    bool full_pass = !semi_naive || ggraph.all_changed;
+    last_pass_full = true;
+
+    // Everything the theorems are matched against is computed up front, so that matching only reads
+    // the GeometricGraph and the DDEngine
+    std::map<pred_t, long> root_work, delta_work;
+    std::map<pred_t, double> candidates;
+    for (auto& [name, _] : match_function_map) {
+        root_work[name] = __enumeration_work(name, ggraph, false);
+        delta_work[name] = __enumeration_work(name, ggraph, true);
+        if (name < pred_t::DIFF) candidates[name] = __count_candidates(name, ggraph);
+    }
 
-        int matches = 0;
-        Theorem* theorem = thr.second.get();
-        int n = theorem->preconditions.predicates.size();
+    std::vector<JoinPlan*> triggered;
+    int skipped = 0;
+    for (auto& [_, plan] : plans) {
+        if (!full_pass && !(plan.triggers & ggraph.delta_kinds)) {
+            // None of the nodes the theorem reads changed, so a semi-naive pass would find nothing
+            last_pass_full = false;
+            skipped += 1;
+            profiler.dd_p.theorem_duration[plan.theorem->name].emplace_back(0);
+            profiler.dd_p.theorem_matches[plan.theorem->name].emplace_back(0);
+            continue;
+        }
+        triggered.push_back(&plan);
+    }
 
-        Generator<bool> gen = match(theorem, 0, n, ggraph);
-        while (gen) {
-            if (gen()) {
-                matches += 1;
+    /* Theorems are handed out to the threads one at a time, in order. Each theorem has its own `Arg`s
+    and each thread its own `delta_template`, and the graph is not modified until the derivations are
+    merged, so the threads share no mutable state other than the thread-safe `check_memo`. */
+    int k = triggered.size();
+    std::vector<TheoremResult> results(k);
+    std::atomic<int> next_theorem = 0;
+    auto worker = [&]() {
+        pred_sets.activate();
+        for (int i; (i = next_theorem++) < k; ) {
+            try {
+                __match_theorem(*triggered[i], full_pass, candidates, root_work, delta_work, ggraph, results[i]);
+            } catch (...) {
+                results[i].error = std::current_exception();
+                delta_template = nullptr;
+                triggered[i]->theorem->__clear_args();
             }
         }
-        LOG("Matches for theorem " << theorem->to_string_with_placeholders() << ": " << matches);
-        theorem->__clear_args();
+    };
 
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
-        profiler.dd_p.theorem_duration[theorem->name].emplace_back(duration);
-        profiler.dd_p.theorem_matches[theorem->name].emplace_back(matches);
+    int num_threads_ = std::max(1, std::min(num_threads, k));
+    if (num_threads_ > 1) ggraph.compress_roots();
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads_; t++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : threads) {
+        t.join();
     }
 
-    profiler.dd_p.total_preds.emplace_back(predicates.size());
+    // Merge the derivations in theorem order, and in discovery order within each theorem
+    for (int i = 0; i < k; i++) {
+        TheoremResult& result = results[i];
+        if (result.error) std::rethrow_exception(result.error);
+        if (!result.full_pass) last_pass_full = false;
+        __merge_derivations(result);
 
-}
+        Theorem* theorem = triggered[i]->theorem;
+        profiler.dd_p.theorem_duration[theorem->name].emplace_back(result.duration);
+        profiler.dd_p.theorem_matches[theorem->name].emplace_back(result.matches);
+    }
 
+    profiler.dd_p.total_preds.emplace_back(predicates.size());
+    profiler.dd_p.skipped_theorems.emplace_back(skipped);
+    LOG("Skipped " << skipped << " theorems with no changed triggers");
 
+    ggraph.all_changed = false;
+}
 
 bool DDEngine::check_postcondition_exact(PredicateTemplate* postcondition) {
     return (
         postcondition->args_filled() &&
-        predicates.contains(postcondition->to_hash_with_args())
+        has_predicate(postcondition->to_key())
     );
 }
 
+void DDEngine::compute_relevance(const std::vector<std::unique_ptr<Numeric>> &numerics) {
+    point_distances.clear();
+    relevance_limit = relevance_radius;
+    if (relevance_radius < 0) return;
+
+    // Each construction step links its output points to the points it was constructed from
+    std::map<Point*, std::set<Point*, NodeOrder>, NodeOrder> neighbours;
+    for (const auto& num : numerics) {
+        for (Point* out : num->outs) {
+            for (Point* arg : num->args) {
+                neighbours[out].insert(arg);
+                neighbours[arg].insert(out);
+            }
+            for (Point* out_ : num->outs) {
+                if (out_ != out) neighbours[out].insert(out_);
+            }
+        }
+    }
+
+    // Breadth-first search from the points of the conclusion
+    std::deque<Point*> to_visit;
+    auto visit = [&](Point* p, int d) {
+        if (p->id >= point_distances.size()) point_distances.resize(p->id + 1, INT_MAX);
+        if (point_distances[p->id] <= d) return;
+        point_distances[p->id] = d;
+        to_visit.push_back(p);
+    };
+    for (auto& arg : conclusion_args) {
+        if (Point* p = arg->get_point()) visit(p, 0);
+    }
+    while (!to_visit.empty()) {
+        Point* p = to_visit.front();
+        to_visit.pop_front();
+        for (Point* q : neighbours[p]) visit(q, point_distances[p->id] + 1);
+    }
+    for (auto& [p, _] : neighbours) {
+        if (p->id >= point_distances.size()) point_distances.resize(p->id + 1, INT_MAX);
+    }
+    LOG("Relevance distances computed for " << point_distances.size() << " points");
+}
+
+bool DDEngine::widen_relevance() {
+    if (relevance_limit < 0) return false;
+    int next = -1;
+    for (int d : point_distances) {
+        if (d > relevance_limit && (next < 0 || d < next)) next = d;
+    }
+    if (next < 0) {
+        // Every point is in the region, so stop pruning altogether
+        relevance_limit = -1;
+        return false;
+    }
+    // Points unconnected to the goal are only matched once pruning stops
+    relevance_limit = (next == INT_MAX) ? -1 : relevance_limit + 1;
+    LOG("Widened relevance region to radius " << relevance_limit);
+    return true;
+}
+
+bool DDEngine::__is_relevant(PredicateTemplate* pred_template) {
+    for (Arg* arg : pred_template->args) {
+        Point* p = arg->get_point();
+        if (p && p->id < point_distances.size() && point_distances[p->id] > relevance_limit) return false;
+    }
+    return true;
+}
+
 bool DDEngine::check_conclusion(GeometricGraph &ggraph) {
     PredicateTemplate* conc = conclusion_.get();
     return ggraph.check(conc);
 }
 
+bool DDEngine::__check_postcondition(PredicateTemplate* postcondition, GeometricGraph &ggraph) {
+    if (!postcondition->args_filled()) return false;
+    PredKey key = postcondition->to_key();
+    if (std::optional<bool> known = check_memo.find(key)) return *known;
+    bool holds = ggraph.check(postcondition);
+    check_memo.insert(key, holds);
+    return holds;
+}
+
 
 
 
 
 void DDEngine::reset_problem() {
+    predicate_table.clear();
     predicates.clear();
+    pred_sets.clear();
+    check_memo.clear();
 
     recent_predicates.clear();
 
     conclusion_.reset();
     conclusion_args.clear();
     conclusion.reset();
+
+    point_distances.clear();
+    relevance_limit = -1;
 }
\ No newline at end of file
@@ -1,11 +1,17 @@
 #pragma once
 
 #include <map>
+#include <set>
+#include <string>
+#include <exception>
 #include <vector>
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <ostream>
 #include <iostream>
+#include <type_traits>
+#include <utility>
 
 #include "Predicate.hh"
 #include "Theorem.hh"
@@ -29,8 +35,15 @@ class DDEngine {
     // Predicates
 public:
     DDEngine();
+    ~DDEngine();
     std::unique_ptr<Predicate> base_pred;
-    uptrmap<Predicate> predicates;
+    /* All known predicates, allocated from a per-problem arena. `predicate_table` indexes them by their
+    `PredKey`s. */
+    PredicateArena predicates;
+    PredicateTable predicate_table;
+    /* Pool of the `PredSet`s of the problem. It is the current pool of the thread constructing the engine,
+    and of the threads matching theorems in `search()`. */
+    PredSetPool pred_sets;
 
     std::deque<Predicate*> recent_predicates;
 
@@ -49,16 +62,51 @@ public:
     void add_construction_template_from_texts(const std::tuple<std::string, std::string, std::string, std::string> v);
     void set_conclusion(std::unique_ptr<Predicate> predicate);
 
-    /* Inserts a newly derived predicate into the engine (specifically `utrmap<Predicate> predicates`).
+    /* Inserts a newly derived predicate into the engine (specifically `PredicateArena predicates`).
+    The predicate is given by the arguments of a `Predicate` constructor, and only constructed (in place in
+    the arena) if it is not known yet. An already constructed predicate is moved into the arena instead.
     Returns a raw pointer to the predicate, whether it was newly inserted or already existed.
     Also adds new predicates into `std::vector<Predicate*> recent_predicates`. */
+    template <typename... Args>
+    Predicate* insert_new_predicate(const pred_t name, PredArgs nodes, Args&&... args) {
+        Predicate* p = insert_predicate(name, nodes, std::forward<Args>(args)...);
+        if (new_predicate) recent_predicates.emplace_back(p);
+        return p;
+    }
+    Predicate* insert_new_predicate(Predicate &&predicate);
     Predicate* insert_new_predicate(std::unique_ptr<Predicate> &&predicate);
-    /* Inserts an already known predicate into the engine (specifically `utrmap<Predicate> predicates`).
+    /* Inserts an already known predicate into the engine (specifically `PredicateArena predicates`).
+    The predicate is given by the arguments of a `Predicate` constructor, and only constructed (in place in
+    the arena) if it is not known yet. An already constructed predicate is moved into the arena instead.
     Returns a raw pointer to the predicate, whether it was newly inserted or already existed.
     Used to insert predicates for which the GeometricGraph does not need to be updated - for example,
     rule preconditions. */
+    template <typename... Args>
+    Predicate* insert_predicate(const pred_t name, PredArgs nodes, Args&&... args) {
+        PredKey key(name, nodes.data(), nodes.size(), __frac_arg(args...));
+        if (Predicate* existing = predicate_table.find(key)) {
+            new_predicate = false;
+            return existing;
+        }
+        Predicate* p = predicates.emplace(name, nodes, std::forward<Args>(args)...);
+        predicate_table.insert(p, key);
+        new_predicate = true;
+        return p;
+    }
+    Predicate* insert_predicate(Predicate &&predicate);
     Predicate* insert_predicate(std::unique_ptr<Predicate> &&predicate);
-    bool has_predicate_by_hash(const std::string hash);
+    /* The `Frac` argument of a `Predicate` constructor, given the arguments following its nodes. */
+    static Frac __frac_arg() { return Frac(); }
+    template <typename T, typename... Rest>
+    static Frac __frac_arg(const T& first, const Rest&...) {
+        if constexpr (std::is_convertible_v<const T&, Frac>) return Frac(first);
+        else return Frac();
+    }
+    bool has_predicate(const PredKey &key);
+    /* Fetches a known predicate from its text, e.g. `coll a b c`, or returns `nullptr`. The points are
+    looked up by name in `global_point_map`. Predicates are matched up to the symmetries of their
+    type (see `PredKey`). */
+    Predicate* get_predicate(const std::string pred_string, std::map<std::string, Point*> &global_point_map);
 
     Generator<Predicate*> get_recent_predicates();
 
@@ -110,13 +158,165 @@ public:
         {pred_t::DIFFSIDE_P, &DDEngine::match_diffside_p},
     };
 
-    Generator<bool> match(Theorem* theorem, int i, int n, GeometricGraph &ggraph);
+    /* One step of a join plan: a precondition, together with the function matching it and the bitmask
+    of the (indices of the) theorem arguments it binds. */
+    struct JoinStep {
+        PredicateTemplate* pred_template;
+        Generator<bool>(DDEngine::*matcher)(PredicateTemplate*, GeometricGraph &);
+        std::uint64_t args;
+    };
+    /* A theorem compiled into flat join plans, once, when it is added. `steps` holds the preconditions in
+    their original order. `full` matches all of them in the order chosen by `__plan_steps()`. `delta` holds
+    one plan per geometric precondition for semi-naive passes, which matches that precondition first
+    (against changed nodes only) and then the remaining ones. `full` and `delta` are planned with the
+    numbers of candidates in `planned_candidates`, and only re-planned by `__refresh_plans()` once these
+    have drifted far enough from the current ones that another order may win.
+    `triggers` is the trigger set of the theorem: the kinds of nodes (see `GeometricGraph::delta_kinds`)
+    whose changes may give it new matches.
+    `symmetries` holds permutations of the theorem arguments (as `sigma[i]`, the index that argument `i`
+    is sent to) mapping the theorem onto itself, see `__theorem_symmetries()`.
+    Theorems with a precondition that cannot be matched have no plans. */
+    struct JoinPlan {
+        Theorem* theorem;
+        std::uint32_t triggers;
+        std::vector<JoinStep> steps;
+        std::vector<JoinStep> full;
+        std::vector<std::vector<JoinStep>> delta;
+        std::vector<double> planned_candidates;
+        std::vector<std::vector<int>> symmetries;
+    };
+    /* Join plans of all theorems, by theorem name. */
+    std::map<std::string, JoinPlan> plans;
+    JoinPlan __compile_theorem(Theorem* theorem);
+    /* Permutations of the argument positions of a predicate of type `name` with `size` arguments which
+    leave it meaning the same fact, as checked by both the GeometricGraph and the numerics. Includes the
+    identity. Permutations under which `GeometricGraph::check()` is not known to be invariant (e.g. swapping
+    the two angles of an eqangle) are left out. */
+    static std::vector<std::vector<int>> __arg_symmetries(pred_t name, int size);
+    /* Symmetries of a theorem: the non-identity permutations of its arguments which send its preconditions
+    onto themselves (as a multiset, up to `__arg_symmetries()`) and its postcondition onto itself. Two
+    bindings related by a symmetry derive the same fact from the same facts, so `match()` only keeps the
+    lexicographically least binding (by point id) of every orbit. At most `MAX_SYMMETRIES` are kept;
+    any subset of the symmetries still keeps at least one binding of every orbit. */
+    static std::vector<std::vector<int>> __theorem_symmetries(Theorem* theorem);
+    const static int MAX_SYMMETRIES = 64;
+    /* Whether the (partial) binding of the arguments of `theorem` is not lexicographically least among its
+    images under `symmetries`, as far as can be told from the arguments already bound. */
+    static bool __breaks_symmetry(Theorem* theorem, const std::vector<std::vector<int>> &symmetries);
+    static void __plan_delta(JoinPlan &plan, const std::map<pred_t, double> &candidates);
+    /* Re-plans `full` and `delta` with `candidates` if the number of candidates of some precondition in
+    `steps` changed by more than a factor of `PLAN_REORDER_GAIN` since they were last planned, since
+    `__plan_steps()` would keep the old order otherwise anyway. Returns whether the plans were recomputed. */
+    static bool __refresh_plans(JoinPlan &plan, const std::map<pred_t, double> &candidates);
+    /* The kinds of nodes (see `GeometricGraph::delta_kinds`) that a precondition of type `name` is
+    matched against. Numerical preconditions never change between passes, so they have none. */
+    static std::uint32_t __trigger_kinds(pred_t name);
+
+    /* Estimates for matching a precondition with `candidates` candidates when nothing is bound, given the
+    arguments already bound in `bound`: `work` done for each partial match reaching it, and the number of
+    `matches` it extends each partial match to. */
+    struct StepEstimate {
+        double work;
+        double matches;
+    };
+    static StepEstimate __estimate_step(const JoinStep &step, double candidates, std::uint64_t bound);
+    /* The number of candidates of the precondition of `step` in `candidates`, at least 1. Preconditions
+    without a count (e.g. before the graph is known) are estimated to have a single candidate. */
+    static double __step_candidates(const JoinStep &step, const std::map<pred_t, double> &candidates);
+    /* Query planner. Orders the geometric preconditions in `steps` by least estimated total work, given
+    the arguments already bound in `bound` and the number of `candidates` of each predicate (see
+    `__count_candidates()`), then pushes every numerical precondition down to right after the step
+    binding the last of its arguments, so that degenerate partial matches are discarded early. */
+    static std::vector<JoinStep> __plan_steps(
+        const std::vector<JoinStep> &steps, std::uint64_t bound, const std::map<pred_t, double> &candidates);
+
+    /* A postcondition derived by a match, together with the instantiated preconditions explaining it. */
+    struct Derivation {
+        Predicate pred;
+        std::vector<Predicate> whys;
+    };
+    /* The result of matching one theorem in one pass. Derivations are buffered in discovery order by the
+    thread matching the theorem, and only merged into `predicates` once all theorems have been matched
+    (see `__merge_derivations()`). `postconditions` indexes the buffered postconditions. */
+    struct TheoremResult {
+        std::deque<Derivation> derivations;
+        PredicateTable postconditions;
+        int matches = 0;
+        long duration = 0;
+        bool full_pass = true;
+        std::exception_ptr error;
+    };
+
+    /* Matches the preconditions of `theorem` in the order given by `plan`, then buffers the postcondition
+    of every complete match whose postcondition is not yet known into `result`. Returns the number of such
+    matches. The plan is executed iteratively with an explicit stack holding one matcher per bound
+    precondition. Partial matches which break one of the `symmetries` of the theorem are dropped (see
+    `__theorem_symmetries()`). Only reads the GeometricGraph and the DDEngine (apart from `check_memo`,
+    which is thread-safe), so different theorems may be matched concurrently. */
+    int match(Theorem* theorem, const std::vector<JoinStep> &plan, const std::vector<std::vector<int>> &symmetries,
+        GeometricGraph &ggraph, TheoremResult &result);
+    /* Matches one theorem in a pass of `search()`, in a full or a semi-naive pass as appropriate. */
+    void __match_theorem(JoinPlan &plan, bool full_pass, const std::map<pred_t, double> &candidates,
+        const std::map<pred_t, long> &root_work, const std::map<pred_t, long> &delta_work,
+        GeometricGraph &ggraph, TheoremResult &result);
+    /* Inserts the buffered derivations of `result` into `predicates`, skipping those whose postcondition
+    is already known. Returns the number of new predicates. */
+    int __merge_derivations(TheoremResult &result);
+
+    /* Flag enabling semi-naive matching in `search()`. When set, each pass after the first only
+    looks for matches in which at least one precondition is witnessed by a node that changed since
+    the previous pass (see `GeometricGraph::collect_changes()`). */
+    bool semi_naive = false;
+    /* The precondition currently restricted to changed nodes (the pivot) in a semi-naive pass, if any.
+    Matching functions with no bound arguments enumerate the `delta_` sets of the GeometricGraph
+    instead of the `root_` sets when matching this precondition. Each matching thread has its own. */
+    static thread_local PredicateTemplate* delta_template;
+    /* Number of threads matching theorems in `search()`. The derivations are merged in the same order
+    whatever the number of threads, so the results do not depend on it. */
+    int num_threads = 1;
+    /* Estimates the work needed to match a precondition of type `name` with no bound arguments, as the
+    number of ordered pairs of objects on the nodes enumerated (the `delta_` sets if `delta` is set).
+    Used by `search()` to fall back to a full pass for theorems where the semi-naive pass costs more.
+    The estimate follows what the matching functions actually enumerate: midp is always matched against
+    all lengths, so it costs the same in both cases, and numerical predicates cannot be enumerated at all,
+    so they cost `LONG_MAX` as the first precondition of a full pass and nothing in a semi-naive pass,
+    where they are never a pivot. */
+    long __enumeration_work(pred_t name, GeometricGraph &ggraph, bool delta);
+    /* Estimates the number of matches of a precondition of type `name` with no bound arguments, by counting
+    the point tuples spanned by the nodes of the graph. Used by the query planner (see `__plan_steps()`). */
+    double __count_candidates(pred_t name, GeometricGraph &ggraph);
+    /* Whether the most recent call to `search()` matched every theorem in a full pass over all nodes.
+    Semi-naive passes do not pick up matches which only become possible through reflexive facts
+    (e.g. `cong A B B A`), so saturation should be confirmed with a full pass. */
+    bool last_pass_full = true;
+
+    /* Goal-relevance pruning. `relevance_radius` is the initial radius of the region matched around
+    the points of the conclusion, or negative to match everywhere. The distance of a point is the number
+    of construction steps (`Numeric`s) separating it from the nearest point of the conclusion, found by
+    `compute_relevance()`. `match()` drops partial matches which bind a point further away than
+    `relevance_limit`, which `widen_relevance()` increases when saturation stalls. */
+    int relevance_radius = -1;
+    int relevance_limit = -1;
+    std::vector<int> point_distances;
+    /* Computes `point_distances` from the dependencies between the points of the given numerics, and
+    resets `relevance_limit` to `relevance_radius`. */
+    void compute_relevance(const std::vector<std::unique_ptr<Numeric>> &numerics);
+    /* Widens the matched region by one construction step. Returns false if pruning is disabled or the
+    region already contains every point, in which case nothing changes. */
+    bool widen_relevance();
+    /* Whether every point bound to the arguments of `pred_template` lies within `relevance_limit`. */
+    bool __is_relevant(PredicateTemplate* pred_template);
 
     /* Search functions */
     void search(GeometricGraph &ggraph, Profiler& profiler);
 
     bool check_postcondition_exact(PredicateTemplate* pred_template);
     bool check_conclusion(GeometricGraph &ggraph);
+    /* Results of checking the postconditions of matches against the GeometricGraph, shared by all
+    theorems. `search()` drops the negative results at the start of every pass. */
+    CheckMemo check_memo;
+    /* `GeometricGraph::check()` of a postcondition, through `check_memo`. */
+    bool __check_postcondition(PredicateTemplate* postcondition, GeometricGraph &ggraph);
 
 
 
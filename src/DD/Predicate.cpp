@@ -1,6 +1,8 @@
 
 #include <string>
 #include <variant>
+#include <atomic>
+#include <algorithm>
 
 #include "Predicate.hh"
 #include "Geometry/GeometricGraph.hh"
@@ -16,6 +18,185 @@
 
 
 
+namespace {
+    // Orders nodes by `id`, so that canonical keys do not depend on allocation addresses
+    bool __node_less(const Node* a, const Node* b) {
+        return (a->id != b->id) ? (a->id < b->id) : (a < b);
+    }
+    // The helpers below sort positions `p` into the given nodes, by the nodes at those positions
+    struct __PosLess {
+        Node* const* nodes;
+        bool operator()(std::uint8_t i, std::uint8_t j) const { return __node_less(nodes[i], nodes[j]); }
+    };
+    void __sort_pair(std::uint8_t* p, __PosLess less) {
+        if (less(p[1], p[0])) std::swap(p[0], p[1]);
+    }
+    // Orders two blocks of `n` positions lexicographically
+    void __sort_blocks(std::uint8_t* p, std::size_t n, __PosLess less) {
+        if (std::lexicographical_compare(p + n, p + 2 * n, p, p + n, less)) {
+            std::swap_ranges(p, p + n, p + n);
+        }
+    }
+    std::uint64_t __mix(std::uint64_t h, std::uint64_t v) {
+        h = (h ^ v) * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 32);
+    }
+}
+
+PredKey::PredKey(const pred_t name, Node* const* nodes, std::size_t size, Frac f)
+: name(name), size(static_cast<std::uint8_t>(size)), frac_num(f.num), frac_den(f.den) {
+    if (size > MAX_ARGS) {
+        throw DDInternalError("PredKey: Too many arguments for predicate " + Utils::to_pred_str(name));
+    }
+    for (std::size_t i = 0; i < size; i++) order[i] = static_cast<std::uint8_t>(i);
+    std::uint8_t* p = order.data();
+    __PosLess less{nodes};
+
+    // Canonicalise the argument order for the symmetries of each predicate type
+    switch (name) {
+        case pred_t::COLL:
+        case pred_t::CYCLIC:
+        case pred_t::DIFF:
+        case pred_t::NCOLL:
+            std::sort(p, p + size, less);
+            break;
+        case pred_t::CIRCLE:
+            if (size == 4) std::sort(p + 1, p + 4, less);
+            break;
+        case pred_t::MIDP:
+            if (size == 3) __sort_pair(p + 1, less);
+            break;
+        case pred_t::PARA:
+        case pred_t::PERP:
+        case pred_t::CONG:
+        case pred_t::NPARA:
+        case pred_t::NPERP:
+        case pred_t::NCONG:
+            if (size == 4) {
+                __sort_pair(p, less);
+                __sort_pair(p + 2, less);
+                __sort_blocks(p, 2, less);
+            }
+            break;
+        case pred_t::EQANGLE:
+        case pred_t::EQRATIO:
+            if (size == 8) {
+                for (int i = 0; i < 8; i += 2) __sort_pair(p + i, less);
+                __sort_blocks(p, 4, less);
+            }
+            break;
+        case pred_t::CONSTANGLE:
+        case pred_t::CONSTRATIO:
+            if (size == 4) {
+                __sort_pair(p, less);
+                __sort_pair(p + 2, less);
+            }
+            break;
+        case pred_t::CONTRI:
+        case pred_t::SIMTRI:
+            if (size == 6) __sort_blocks(p, 3, less);
+            break;
+        default:
+            break;
+    }
+    for (std::size_t i = 0; i < size; i++) args[i] = nodes[order[i]];
+
+    hash = __mix(static_cast<std::uint64_t>(name), size);
+    for (std::size_t i = 0; i < size; i++) hash = __mix(hash, args[i]->id);
+    hash = __mix(hash, (static_cast<std::uint64_t>(static_cast<std::uint32_t>(frac_num)) << 32) 
+        | static_cast<std::uint32_t>(frac_den));
+}
+
+bool PredKey::operator==(const PredKey& other) const {
+    return (
+        hash == other.hash && name == other.name && size == other.size &&
+        frac_num == other.frac_num && frac_den == other.frac_den &&
+        std::equal(args.begin(), args.begin() + size, other.args.begin())
+    );
+}
+
+Predicate* PredicateTable::find(const PredKey& key) const {
+    if (slots.empty()) return nullptr;
+    std::size_t mask = slots.size() - 1;
+    for (std::size_t i = key.hash & mask; slots[i].pred; i = (i + 1) & mask) {
+        if (slots[i].hash == key.hash && slots[i].pred->has_key(key)) return slots[i].pred;
+    }
+    return nullptr;
+}
+
+bool PredicateTable::insert(Predicate* pred) {
+    return insert(pred, pred->key());
+}
+
+bool PredicateTable::insert(Predicate* pred, const PredKey& key) {
+    if (2 * (count + 1) > slots.size()) __grow();
+    std::size_t mask = slots.size() - 1;
+    std::size_t i = key.hash & mask;
+    for (; slots[i].pred; i = (i + 1) & mask) {
+        if (slots[i].hash == key.hash && slots[i].pred->has_key(key)) return false;
+    }
+    slots[i] = {key.hash, pred};
+    count++;
+    return true;
+}
+
+void PredicateTable::__grow() {
+    std::vector<Slot> old = std::move(slots);
+    slots.assign(old.empty() ? 64 : 2 * old.size(), Slot{});
+    std::size_t mask = slots.size() - 1;
+    for (const Slot& slot : old) {
+        if (!slot.pred) continue;
+        std::size_t i = slot.hash & mask;
+        while (slots[i].pred) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+}
+
+void PredicateTable::clear() {
+    slots.clear();
+    count = 0;
+}
+
+std::optional<bool> CheckMemo::find(const PredKey& key) {
+    Shard& shard = __shard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.results.find(key);
+    if (it == shard.results.end()) return std::nullopt;
+    return it->second;
+}
+
+void CheckMemo::insert(const PredKey& key, bool holds) {
+    Shard& shard = __shard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.results.insert_or_assign(key, holds);
+}
+
+void CheckMemo::next_pass() {
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::erase_if(shard.results, [](const auto& entry) { return !entry.second; });
+    }
+}
+
+std::size_t CheckMemo::size() {
+    std::size_t res = 0;
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        res += shard.results.size();
+    }
+    return res;
+}
+
+void CheckMemo::clear() {
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.results.clear();
+    }
+}
+
+
+
+
 PredicateTemplate::PredicateTemplate(const std::string s, std::map<std::string, Arg*> &argmap) {
 
     std::vector<std::string> v = StrUtils::split(s, " ");
@@ -93,10 +274,21 @@ std::string PredicateTemplate::to_string() const {
     return res;
 }
 
-std::string PredicateTemplate::to_hash_with_args() const {
-    // For now, just use the same as to_string()
-    // This is the same as the hash as implemented in the Predicate constructors
-    return to_string(); 
+PredKey PredicateTemplate::to_key() const {
+    std::array<Node*, PredKey::MAX_ARGS> nodes;
+    std::size_t size = 0;
+    Frac f;
+    for (Arg* arg : args) {
+        if (Node** node = std::get_if<Node*>(&arg->arg)) {
+            if (size == PredKey::MAX_ARGS) {
+                throw DDInternalError("PredicateTemplate: Too many arguments for a key: " + to_string());
+            }
+            nodes[size++] = *node;
+        } else if (Frac* f_ = std::get_if<Frac>(&arg->arg)) {
+            f = *f_;
+        }
+    }
+    return PredKey(name, nodes.data(), size, f);
 }
 
 bool PredicateTemplate::__validate_neq(GeometricGraph &ggraph) {
@@ -136,49 +328,54 @@ bool PredicateTemplate::validate_degeneracy_args(GeometricGraph &ggraph) {
 
 
 
+PredArgs::PredArgs(const std::vector<Node*> &v) {
+    for (Node* node : v) emplace_back(node);
+}
+PredArgs::PredArgs(std::initializer_list<Node*> init_list) {
+    for (Node* node : init_list) emplace_back(node);
+}
+
+void PredArgs::emplace_back(Node* node) {
+    if (count == PredKey::MAX_ARGS) {
+        throw DDInternalError("PredArgs: Predicate has more than " + std::to_string(PredKey::MAX_ARGS) + " arguments");
+    }
+    nodes[count++] = node;
+}
+
+
+
+
 Predicate::Predicate(const pred_t pred_name, Frac f, pred_src src) 
 : name(pred_name), frac_arg(f), source(src) {
-    hash = Utils::to_pred_str(pred_name) + " " + f.to_string();
+    __set_key();
 }
-Predicate::Predicate(const pred_t pred_name, std::vector<Node*> &&nodes, pred_src src)
-: args(std::move(nodes)), name(pred_name), source(src) {
-    hash = Utils::to_pred_str(pred_name);
-    for (Node* node : args) {
-        hash = hash + " " + node->name;
-    }
+Predicate::Predicate(const pred_t pred_name, PredArgs nodes, pred_src src)
+: args(nodes), name(pred_name), source(src) {
+    __set_key();
 }
-Predicate::Predicate(const pred_t pred_name, std::vector<Node*> &&nodes, Frac f, pred_src src)
-: Predicate(pred_name, std::move(nodes), src) {
-    frac_arg = f;
-    hash = hash + " " + f.to_string();
+Predicate::Predicate(const pred_t pred_name, PredArgs nodes, Frac f, pred_src src)
+: args(nodes), name(pred_name), frac_arg(f), source(src) {
+    __set_key();
 }
-Predicate::Predicate(const pred_t pred_name, std::vector<Node*> &&nodes, PredSet &&why, pred_src src)
-: args(std::move(nodes)), name(pred_name), why(std::move(why)), source(src) {
-    hash = Utils::to_pred_str(pred_name);
-    for (Node* node : args) {
-        hash = hash + " " + node->name;
-    }
+Predicate::Predicate(const pred_t pred_name, PredArgs nodes, PredSet &&why, pred_src src)
+: args(nodes), name(pred_name), why(std::move(why)), source(src) {
+    __set_key();
 }
-Predicate::Predicate(const pred_t pred_name, std::vector<Node*> &&nodes, Frac f, PredSet &&why, pred_src src)
-: Predicate(pred_name, std::move(nodes), std::move(why), src) {
-    frac_arg = f;
-    hash = hash + " " + f.to_string();
+Predicate::Predicate(const pred_t pred_name, PredArgs nodes, Frac f, PredSet &&why, pred_src src)
+: args(nodes), name(pred_name), frac_arg(f), why(std::move(why)), source(src) {
+    __set_key();
 }
-Predicate::Predicate(const pred_t pred_name, std::vector<Node*> &&nodes, std::set<Predicate*> &&why, pred_src src)
-: args(std::move(nodes)), name(pred_name), why(std::move(why)), source(src) {
-    hash = Utils::to_pred_str(pred_name);
-    for (Node* node : args) {
-        hash = hash + " " + node->name;
-    }
+Predicate::Predicate(const pred_t pred_name, PredArgs nodes, std::set<Predicate*> &&why, pred_src src)
+: args(nodes), name(pred_name), why(std::move(why)), source(src) {
+    __set_key();
 }
-Predicate::Predicate(const pred_t pred_name, std::vector<Node*> &&nodes, Frac f, std::set<Predicate*> &&why, pred_src src)
-: Predicate(pred_name, std::move(nodes), std::move(why), src) {
-    frac_arg = f;
-    hash = hash + " " + f.to_string();
+Predicate::Predicate(const pred_t pred_name, PredArgs nodes, Frac f, std::set<Predicate*> &&why, pred_src src)
+: args(nodes), name(pred_name), frac_arg(f), why(std::move(why)), source(src) {
+    __set_key();
 }
 
 std::unique_ptr<Predicate> Predicate::from_global_point_map(
-    const std::string pred_string, std::map<std::string, std::unique_ptr<Point>> &global_point_map
+    const std::string pred_string, std::map<std::string, Point*> &global_point_map
 ) {
     std::vector<std::string> v = StrUtils::split(pred_string, " ");
     std::string pred_name = v[0];
@@ -191,7 +388,7 @@ std::unique_ptr<Predicate> Predicate::from_global_point_map(
     for (auto iter = v.begin() + 1; iter != v.end(); iter++) {
         std::string pt_str = *iter;
         if (Utils::isinmap(pt_str, global_point_map)) {
-            Node* node = global_point_map[pt_str].get();
+            Node* node = global_point_map[pt_str];
             nodes.emplace_back(node);
         } else {
             throw DDInternalError("Predicate: Invalid predicate argument: " + pt_str);
@@ -204,8 +401,6 @@ std::unique_ptr<Predicate> Predicate::from_global_point_map(
 }
 
 Predicate::Predicate(PredicateTemplate &pt, pred_src src) : name(pt.name), source(src) {
-    hash = pt.to_hash_with_args();
-
     for (int i=0; i<pt.args.size(); i++) {
         std::visit( overloaded {
             /* ampersands [&] make capture-by-reference the default for our lambda. In
@@ -215,16 +410,62 @@ Predicate::Predicate(PredicateTemplate &pt, pred_src src) : name(pt.name), sourc
             [&](auto&) { throw DDInternalError("Predicate: Invalid argument in predicate template: " + pt.to_string()); }
         }, pt.args[i]->arg );
     }
+    __set_key();
+}
+
+void Predicate::__set_key() {
+    key_order = PredKey(name, args.data(), args.size(), frac_arg).order;
+}
+
+PredKey Predicate::key() const {
+    if (key_args) return PredKey(name, key_args->data(), key_args->size(), frac_arg);
+    return PredKey(name, args.data(), args.size(), frac_arg);
+}
+
+bool Predicate::has_key(const PredKey& key) const {
+    if (key.name != name || key.frac_num != frac_arg.num || key.frac_den != frac_arg.den) return false;
+    if (key_args) {
+        return key.size == key_args->size() && std::equal(key_args->begin(), key_args->end(), key.args.begin());
+    }
+    if (key.size != args.size()) return false;
+    for (std::size_t i = 0; i < args.size(); i++) {
+        if (args[key_order[i]] != key.args[i]) return false;
+    }
+    return true;
+}
+
+void Predicate::rewrite_args(PredArgs nodes) {
+    if (!key_args) {
+        key_args = std::make_unique<PredArgs>();
+        for (std::size_t i = 0; i < args.size(); i++) key_args->emplace_back(args[key_order[i]]);
+    }
+    args = nodes;
+}
+
+void Predicate::set_level(int level) {
+    if (this->level == level) return;
+    this->level = level;
+    PredSet::invalidate_levels();
 }
 
-std::string Predicate::to_string() const { return hash; }
+std::string Predicate::to_string() const {
+    std::string res = Utils::to_pred_str(name);
+    for (Node* node : args) {
+        res = res + " " + node->name;
+    }
+    // Only these predicates (and the argument-less placeholders) carry a `Frac`
+    if (name == pred_t::CONSTANGLE || name == pred_t::CONSTRATIO || (args.empty() && name != pred_t::BASE)) {
+        res = res + " " + frac_arg.to_string();
+    }
+    return res;
+}
 
 std::string Predicate::to_string_with_whys() const {
-    std::string res = hash;
+    std::string res = to_string();
     if (why.size() >= 1) {
-        auto it = why.preds.begin();
+        auto it = why.begin();
         res += " <- " + (*it)->to_string();
-        while (++it != why.preds.end()) {
+        while (++it != why.end()) {
             res += ", " + (*it)->to_string();
         }
     }
@@ -234,95 +475,273 @@ std::string Predicate::to_string_with_whys() const {
 
 
 
+namespace {
+    // Source of the ids of the pools, which tag the cached levels of the sets
+    std::atomic<std::uint64_t> __next_pool_id{1};
+
+    std::uint64_t __hash_preds(const std::vector<Predicate*> &preds) {
+        std::uint64_t h = preds.size();
+        for (Predicate* pred : preds) {
+            h = __mix(h, reinterpret_cast<std::uintptr_t>(pred));
+        }
+        return h;
+    }
+}
+
+bool PredicateOrder::operator()(const Predicate* a, const Predicate* b) const {
+    if (!a || !b) return std::less<const Predicate*>()(a, b);
+    return (a->index != b->index) ? (a->index < b->index) : std::less<const Predicate*>()(a, b);
+}
+
+std::size_t PredSetPool::PairHash::operator()(const std::pair<const PredSetData*, const PredSetData*>& p) const {
+    return __mix(p.first->hash, p.second->hash);
+}
+
+thread_local PredSetPool* PredSetPool::active = nullptr;
+
+PredSetPool::PredSetPool() : id(__next_pool_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+PredSetPool& PredSetPool::current() {
+    if (active) return *active;
+    thread_local PredSetPool pool;
+    return pool;
+}
+
+void PredSetPool::activate() {
+    active = this;
+}
+
+void PredSetPool::deactivate() {
+    if (active == this) active = nullptr;
+}
+
+std::shared_ptr<const PredSetData> PredSetPool::intern(std::vector<Predicate*> &&preds) {
+    std::uint64_t hash = __hash_preds(preds);
+    SetShard& shard = set_shards[(hash >> 32) % NUM_SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto [first, last] = shard.sets.equal_range(hash);
+    for (auto it = first; it != last; ) {
+        std::shared_ptr<const PredSetData> data = it->second.lock();
+        if (!data) {
+            it = shard.sets.erase(it);
+            continue;
+        }
+        if (data->preds == preds) return data;
+        it++;
+    }
+    auto data = std::make_shared<PredSetData>();
+    data->preds = std::move(preds);
+    data->hash = hash;
+    shard.sets.emplace(hash, data);
+    __maybe_sweep(shard);
+    return data;
+}
+
+void PredSetPool::__maybe_sweep(SetShard &shard) {
+    if (shard.sets.size() < shard.sweep_size) return;
+    std::erase_if(shard.sets, [](const auto& entry) { return entry.second.expired(); });
+    shard.sweep_size = std::max(MIN_SWEEP_SIZE, 2 * shard.sets.size());
+}
+
+void PredSetPool::__maybe_sweep(UnionShard &shard) {
+    if (shard.unions.size() < shard.sweep_size) return;
+    std::erase_if(shard.unions, [](const auto& entry) {
+        const Union& u = entry.second;
+        return u.a.expired() || u.b.expired() || u.res.expired();
+    });
+    shard.sweep_size = std::max(MIN_SWEEP_SIZE, 2 * shard.unions.size());
+}
+
+std::shared_ptr<const PredSetData> PredSetPool::unite(
+    const std::shared_ptr<const PredSetData> &a, const std::shared_ptr<const PredSetData> &b
+) {
+    if (!a || a == b) return b;
+    if (!b) return a;
+    // Union is commutative, so both argument orders share one cache entry
+    std::pair<const PredSetData*, const PredSetData*> key = (a.get() < b.get()) ? 
+        std::make_pair(a.get(), b.get()) : std::make_pair(b.get(), a.get());
+    UnionShard& shard = union_shards[(PairHash()(key) >> 32) % NUM_SHARDS];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.unions.find(key);
+        if (it != shard.unions.end()) {
+            // The operands are alive, so an entry with live operands was cached for these very sets
+            const Union& u = it->second;
+            if (!u.a.expired() && !u.b.expired()) {
+                if (std::shared_ptr<const PredSetData> res = u.res.lock()) return res;
+            }
+        }
+    }
+    // The union is computed without holding the lock, as interning it locks a set shard
+    std::vector<Predicate*> merged;
+    merged.reserve(a->preds.size() + b->preds.size());
+    std::set_union(
+        a->preds.begin(), a->preds.end(), b->preds.begin(), b->preds.end(), 
+        std::back_inserter(merged), PredicateOrder()
+    );
+    std::shared_ptr<const PredSetData> res = (merged.size() == a->preds.size()) ? a
+        : (merged.size() == b->preds.size()) ? b 
+        : intern(std::move(merged));
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.unions.insert_or_assign(key, Union{a, b, res});
+    __maybe_sweep(shard);
+    return res;
+}
+
+std::pair<int, int> PredSetPool::level_and_lsum(const PredSetData &data) const {
+    std::uint64_t epoch = level_epoch.load(std::memory_order_relaxed);
+    if (data.level_pool != id || data.level_epoch != epoch) {
+        int max_level = -1;
+        int lsum = 0;
+        for (Predicate* pred : data.preds) {
+            int pred_level = pred->get_level();
+            if (pred_level > max_level) {
+                max_level = pred_level;
+            }
+            lsum += pred_level;
+        }
+        data.level = max_level;
+        data.lsum = lsum;
+        data.level_pool = id;
+        data.level_epoch = epoch;
+    }
+    return {data.level, data.lsum};
+}
+
+void PredSetPool::invalidate_levels() {
+    level_epoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::size_t PredSetPool::size() {
+    std::size_t res = 0;
+    for (SetShard& shard : set_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::erase_if(shard.sets, [](const auto& entry) { return entry.second.expired(); });
+        res += shard.sets.size();
+    }
+    return res;
+}
+
+void PredSetPool::clear() {
+    for (UnionShard& shard : union_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.unions.clear();
+        shard.sweep_size = MIN_SWEEP_SIZE;
+    }
+    for (SetShard& shard : set_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.sets.clear();
+        shard.sweep_size = MIN_SWEEP_SIZE;
+    }
+}
+
+
+
+PredSet::PredSet(Predicate* pred) : data(PredSetPool::current().intern({pred})) {}
+PredSet::PredSet(std::initializer_list<Predicate*> init_list) : PredSet(std::vector<Predicate*>(init_list)) {}
+PredSet::PredSet(const std::set<Predicate*> &preds) {
+    if (!preds.empty()) {
+        *this = PredSet(std::vector<Predicate*>(preds.begin(), preds.end()));
+    }
+}
+PredSet::PredSet(std::vector<Predicate*> &&preds) {
+    if (preds.empty()) return;
+    std::sort(preds.begin(), preds.end(), PredicateOrder());
+    preds.erase(std::unique(preds.begin(), preds.end()), preds.end());
+    data = PredSetPool::current().intern(std::move(preds));
+}
+
 void PredSet::operator+=(Predicate* pred) {
-    preds.insert(pred);
+    insert(pred);
 }
 void PredSet::insert(Predicate* pred) {
-    preds.insert(pred);
+    if (!data) {
+        data = PredSetPool::current().intern({pred});
+        return;
+    }
+    auto it = std::lower_bound(data->preds.begin(), data->preds.end(), pred, PredicateOrder());
+    if (it != data->preds.end() && *it == pred) return;
+    std::vector<Predicate*> preds;
+    preds.reserve(data->preds.size() + 1);
+    preds.insert(preds.end(), data->preds.begin(), it);
+    preds.emplace_back(pred);
+    preds.insert(preds.end(), it, data->preds.end());
+    data = PredSetPool::current().intern(std::move(preds));
 }
 void PredSet::operator+=(const PredSet& other) {
-    Utils::__unify_sets(preds, other.preds);
+    data = PredSetPool::current().unite(data, other.data);
 }
 void PredSet::insert(std::initializer_list<Predicate*> list) {
-    for (Predicate* pred : list) {
-        preds.insert(pred);
-    }
-}
-void PredSet::operator+=(PredSet&& other) {
-    preds.merge(other.preds);
+    *this += PredSet(list);
 }
 
 void PredSet::operator=(const PredSet& other) {
-    preds = other.preds;
+    data = other.data;
 }
 void PredSet::operator=(PredSet&& other) {
-    std::swap(preds, other.preds);
+    std::swap(data, other.data);
 }
 
 PredSet PredSet::operator+(const PredSet& other) const {
-    PredSet res(*this);
-    res += other;
-    // Return Value Optimisation (RVO) applies here:
-    return res;
+    return PredSet(PredSetPool::current().unite(data, other.data));
+}
+
+bool PredSet::operator==(const PredSet& other) const {
+    if (data == other.data) return true;
+    if (!data || !other.data || data->hash != other.data->hash) return false;
+    return data->preds == other.data->preds;
 }
 
 int PredSet::size() const { 
-    return preds.size(); 
+    return data ? data->preds.size() : 0; 
 }
 bool PredSet::contains(Predicate* pred) const { 
-    return preds.contains(pred); 
+    return data && std::binary_search(data->preds.begin(), data->preds.end(), pred, PredicateOrder()); 
 }
 bool PredSet::empty() const {
-    return preds.empty();
+    return !data;
 }
 void PredSet::set_level(int level) {
-    for (Predicate* pred : preds) {
-        if (pred->level > level) {
-            pred->level = level;
-        }
+    for (Predicate* pred : *this) {
+        if (pred->get_level() > level) pred->set_level(level);
     }
 }
 int PredSet::level() const {
-    int res = -1;
-    for (Predicate* pred : preds) {
-        if (pred->level > res) {
-            res = pred->level;
-        }
-    }
-    return res;
+    return __level_and_lsum().first;
 }
 int PredSet::lsum() const {
-    int res = 0;
-    for (Predicate* pred : preds) {
-        res += pred->level;
-    }
-    return res;
+    return __level_and_lsum().second;
 }
 std::pair<int, int> PredSet::__level_and_lsum() const {
-    int max_level = -1;
-    int lsum = 0;
-    for (Predicate* pred : preds) {
-        if (pred->level > max_level) {
-            max_level = pred->level;
-        }
-        lsum += pred->level;
-    }
-    return {max_level, lsum};
+    if (!data) return {-1, 0};
+    return PredSetPool::current().level_and_lsum(*data);
+}
+void PredSet::invalidate_levels() {
+    PredSetPool::current().invalidate_levels();
 }
 
 bool PredSet::operator<(const PredSet& other) const {
     auto [level, lsum] = __level_and_lsum();
     auto [other_level, other_lsum] = other.__level_and_lsum();
-    return (other.preds.empty()) || (level < other_level) || (level == other_level && lsum < other_lsum) 
-        || (level == other_level && lsum == other_lsum && preds.size() < other.preds.size());
+    return (other.empty()) || (level < other_level) || (level == other_level && lsum < other_lsum) 
+        || (level == other_level && lsum == other_lsum && size() < other.size());
+}
+
+Predicate* const* PredSet::begin() const {
+    return data ? data->preds.data() : nullptr;
+}
+Predicate* const* PredSet::end() const {
+    return data ? data->preds.data() + data->preds.size() : nullptr;
 }
+
 std::string PredSet::to_string() const {
-    if (preds.empty()) {
+    if (empty()) {
         return "EMPTY";
     }
-    auto iter = preds.begin();
+    auto iter = begin();
     std::string res = (*iter++)->to_string();
-    while (iter != preds.end()) {
+    while (iter != end()) {
         res = res + " && " + (*(iter++))->to_string();
     }
     return res;
@@ -365,12 +784,6 @@ Generator<std::unique_ptr<Predicate>> ClauseTemplate::instantiate() {
     }
 }
 
-Generator<std::string> ClauseTemplate::instantiate_hashes() {
-    for (auto& predptr : predicates) {
-        co_yield predptr.get()->to_hash_with_args();
-    }
-}
-
 std::string ClauseTemplate::to_string() {
     if (this->is_empty()) {
         return "EMPTY";
@@ -1,9 +1,17 @@
 #pragma once 
 
 #include <map>
+#include <set>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <cstdint>
+#include <mutex>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
+#include <unordered_map>
 
 #include "Common/Frac.hh"
 #include "Common/Generator.hh"
@@ -13,6 +21,113 @@
 
 class GeometricGraph;
 
+/* Fixed-size structural key of a predicate: its type, its node arguments and its `Frac` argument.
+
+The node arguments are stored in a canonical order for the symmetries of the predicate type (e.g. the
+points of a `coll`, or the two segments of a `cong`), so that predicates stating the same fact in different
+argument orders have equal keys. `hash` is computed from the node `id`s, so it does not depend on where the
+nodes were allocated. Keys are compared by node pointers. */
+class PredKey {
+public:
+	const static std::size_t MAX_ARGS = 8;
+
+	pred_t name = pred_t::BASE;
+	std::uint8_t size = 0;
+	std::array<Node*, MAX_ARGS> args{};
+	/* Position in the given nodes of each of `args` */
+	std::array<std::uint8_t, MAX_ARGS> order{};
+	int frac_num = 0;
+	int frac_den = 1;
+	std::uint64_t hash = 0;
+
+	PredKey() {}
+	PredKey(const pred_t name, Node* const* nodes, std::size_t size, Frac f);
+
+	bool operator==(const PredKey& other) const;
+};
+
+/* Open-addressing hash table of predicates, indexed by their `PredKey`s. Does not own the predicates.
+Linear probing over a power-of-two number of slots, kept at most half full. */
+class PredicateTable {
+	struct Slot {
+		std::uint64_t hash = 0;
+		Predicate* pred = nullptr;
+	};
+	std::vector<Slot> slots;
+	std::size_t count = 0;
+
+	void __grow();
+
+public:
+	/* Returns the predicate with the given key, or `nullptr` if there is none. */
+	Predicate* find(const PredKey& key) const;
+	bool contains(const PredKey& key) const { return find(key) != nullptr; }
+	/* Inserts `pred` unless a predicate with the same key is already present. Returns true if it was inserted. */
+	bool insert(Predicate* pred);
+	/* As above, given the key of `pred` if it was already built. */
+	bool insert(Predicate* pred, const PredKey& key);
+
+	std::size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	void clear();
+};
+
+/* Memo of `GeometricGraph::check()` results, keyed by the `PredKey`s of the checked predicates.
+The graph only changes between DD passes, so negative results are only valid for the pass they were
+found in and are dropped by `next_pass()`. Positive results are kept until `clear()`, since the graph
+only ever gains facts. Split into shards with their own locks, so that it may be shared by the threads
+matching theorems. */
+class CheckMemo {
+	const static std::size_t NUM_SHARDS = 16;
+	struct KeyHash {
+		std::size_t operator()(const PredKey& key) const { return key.hash; }
+	};
+	struct Shard {
+		std::mutex mutex;
+		std::unordered_map<PredKey, bool, KeyHash> results;
+	};
+	std::array<Shard, NUM_SHARDS> shards;
+
+	Shard& __shard(const PredKey& key) { return shards[(key.hash >> 32) % NUM_SHARDS]; }
+
+public:
+	/* Returns the remembered result of checking the predicate with the given key, if any. */
+	std::optional<bool> find(const PredKey& key);
+	void insert(const PredKey& key, bool holds);
+	/* Drops the negative results, to be called whenever the graph may have changed. */
+	void next_pass();
+
+	std::size_t size();
+	void clear();
+};
+
+/* Node arguments of a predicate, stored inline rather than in a separate heap allocation.
+Holds at most `PredKey::MAX_ARGS` nodes, which is the largest arity of any predicate. */
+class PredArgs {
+	std::array<Node*, PredKey::MAX_ARGS> nodes{};
+	std::uint8_t count = 0;
+
+public:
+	PredArgs() {}
+	PredArgs(const std::vector<Node*> &v);
+	PredArgs(std::initializer_list<Node*> init_list);
+
+	void emplace_back(Node* node);
+	void clear() noexcept { count = 0; }
+
+	std::size_t size() const noexcept { return count; }
+	bool empty() const noexcept { return count == 0; }
+	Node*& operator[](std::size_t i) { return nodes[i]; }
+	Node* operator[](std::size_t i) const { return nodes[i]; }
+
+	Node** data() noexcept { return nodes.data(); }
+	Node* const* data() const noexcept { return nodes.data(); }
+	Node** begin() noexcept { return nodes.data(); }
+	Node** end() noexcept { return nodes.data() + count; }
+	Node* const* begin() const noexcept { return nodes.data(); }
+	Node* const* end() const noexcept { return nodes.data() + count; }
+};
+
 class PredicateTemplate {
 	std::string id;
 
@@ -57,81 +172,232 @@ public:
 	std::unique_ptr<Predicate> instantiate();
 
 	std::string to_string() const;
-	std::string to_hash_with_args() const;
+	/* Builds the key of the predicate the template would instantiate, without instantiating it.
+	Note: Assumes all arguments are filled. */
+	PredKey to_key() const;
 
 	bool __validate_neq(GeometricGraph &ggraph);
 	bool __validate_ncoll(GeometricGraph &ggraph);
 	bool validate_degeneracy_args(GeometricGraph &ggraph);
 };
 
-class PredSet {
+/* Orders predicates by their `index` in the `PredicateArena`, i.e. in the order the DDEngine learnt them,
+so that the order does not depend on where the predicates were allocated. Predicates outside of any arena
+come last, in address order; a null predicate comes first. */
+struct PredicateOrder {
+	bool operator()(const Predicate* a, const Predicate* b) const;
+};
+
+/* Immutable contents of a `PredSet`: an array of distinct predicates, sorted by `PredicateOrder`. The `level` and `lsum` of
+the set are computed once, and only recomputed after some predicate levels have changed (see
+`PredSetPool::invalidate_levels()`). */
+struct PredSetData {
+	std::vector<Predicate*> preds;
+	std::uint64_t hash = 0;
+
+	// Id and level epoch of the pool the cached level was computed under
+	mutable std::uint64_t level_pool = 0;
+	mutable std::uint64_t level_epoch = 0;
+	mutable int level = -1;
+	mutable int lsum = 0;
+};
+
+/* Hash-consing pool of `PredSetData`, so that equal predicate sets share a single immutable instance.
+Also caches the results of unions, which are rebuilt over and over along merge chains.
+Every DDEngine owns a pool, which is the current pool of the threads it runs on: `PredSet`s are interned
+in the current pool of the thread building them (or in a pool of the thread itself, if it has none).
+The pool only holds weak references, so sets are freed as soon as no `PredSet` holds them, and their
+entries are evicted periodically. All operations are thread-safe: like the `CheckMemo`, the sets and the
+unions are split into shards by hash, each behind its own mutex. */
+class PredSetPool {
+	const static std::size_t NUM_SHARDS = 16;
+	// Number of entries below which a shard is never swept for expired entries
+	static constexpr std::size_t MIN_SWEEP_SIZE = 64;
+
+	struct PairHash {
+		std::size_t operator()(const std::pair<const PredSetData*, const PredSetData*>& p) const;
+	};
+	/* A cached union. Only valid while both operands are alive, as their addresses may otherwise have
+	been reused by other sets. */
+	struct Union {
+		std::weak_ptr<const PredSetData> a, b, res;
+	};
+	struct SetShard {
+		std::mutex mutex;
+		std::unordered_multimap<std::uint64_t, std::weak_ptr<const PredSetData>> sets;
+		std::size_t sweep_size = MIN_SWEEP_SIZE;
+	};
+	struct UnionShard {
+		std::mutex mutex;
+		std::unordered_map<std::pair<const PredSetData*, const PredSetData*>, Union, PairHash> unions;
+		std::size_t sweep_size = MIN_SWEEP_SIZE;
+	};
+
+	static thread_local PredSetPool* active;
+
+	std::array<SetShard, NUM_SHARDS> set_shards;
+	std::array<UnionShard, NUM_SHARDS> union_shards;
+
+	const std::uint64_t id;
+	std::atomic<std::uint64_t> level_epoch = 1;
+
+	/* Evicts the entries of expired sets (resp. unions) once the shard has doubled in size since its
+	last sweep. Must be called with the shard locked. */
+	static void __maybe_sweep(SetShard &shard);
+	static void __maybe_sweep(UnionShard &shard);
+
 public:
-	std::set<Predicate*> preds;
+	PredSetPool();
+
+	/* Returns the current pool of the calling thread. */
+	static PredSetPool& current();
+	/* Makes this pool the current pool of the calling thread. */
+	void activate();
+	/* Resets the current pool of the calling thread, if it is this pool. */
+	void deactivate();
+
+	/* Returns the shared instance holding `preds`, which must be sorted by `PredicateOrder` and without
+	duplicates. */
+	std::shared_ptr<const PredSetData> intern(std::vector<Predicate*> &&preds);
+	std::shared_ptr<const PredSetData> unite(
+		const std::shared_ptr<const PredSetData> &a, const std::shared_ptr<const PredSetData> &b
+	);
+
+	/* Returns the `level` and `lsum` of `data`, computing them if some predicate levels have changed since
+	they were last computed under this pool. */
+	std::pair<int, int> level_and_lsum(const PredSetData &data) const;
+	/* Invalidates the cached `level()` and `lsum()` of all sets, when read under this pool. */
+	void invalidate_levels();
+
+	/* Number of live sets in the pool. */
+	std::size_t size();
+	void clear();
+};
+
+/* Set of predicates. A PredSet is a handle to hash-consed, immutable `PredSetData`: copies are O(1), equal
+sets share their data, and every modification replaces the handle by one to the resulting set. 
+Iteration visits the predicates in `PredicateOrder`, like a `std::set<Predicate*, PredicateOrder>` would.
+The empty set holds no data. */
+class PredSet {
+	std::shared_ptr<const PredSetData> data;
+
+	explicit PredSet(std::shared_ptr<const PredSetData> &&data) : data(std::move(data)) {}
 
+public:
 	PredSet() {}
-	PredSet(Predicate* pred) : preds{pred} {}
-	PredSet(std::initializer_list<Predicate*> init_list) : preds(init_list) {}
-	PredSet(const std::set<Predicate*> &preds) : preds(preds) {}
-	PredSet(std::set<Predicate*> &&preds) : preds(std::move(preds)) {}
+	PredSet(Predicate* pred);
+	PredSet(std::initializer_list<Predicate*> init_list);
+	PredSet(const std::set<Predicate*> &preds);
+	/* Builds the set of the predicates in `preds`, which may be unsorted and contain duplicates. */
+	explicit PredSet(std::vector<Predicate*> &&preds);
 
-	/* Move constructor */
-	PredSet(PredSet&& other) : preds(std::move(other.preds)) {}
-	/* Copy constructor */
-	PredSet(const PredSet& other) : preds(other.preds) {}
+	PredSet(PredSet&& other) = default;
+	PredSet(const PredSet& other) = default;
 
 	void operator+=(Predicate* pred);
 	void insert(Predicate* pred);
 	void operator+=(const PredSet& other);
 	void insert(std::initializer_list<Predicate*> list);
-	void operator+=(PredSet&& other);
 
 	void operator=(const PredSet& other);
 	void operator=(PredSet&& other);
 
 	PredSet operator+(const PredSet& other) const;
 
+	/* O(1) if both sets were interned by the same pool since it was last cleared. */
+	bool operator==(const PredSet& other) const;
+
 	int size() const;
 	bool contains(Predicate* pred) const;
 	bool empty() const;
+	/* Lowers the level of every predicate in the set to at most `level`. */
 	void set_level(int level);
 	int level() const;
 	int lsum() const;
 	std::pair<int, int> __level_and_lsum() const;
 
+	/* Invalidates the cached `level()` and `lsum()` of all sets of the current pool. Called by
+	`Predicate::set_level()`. */
+	static void invalidate_levels();
+
 	bool operator<(const PredSet& other) const;
 
-	explicit operator std::set<Predicate*>() const { return preds; }
+	Predicate* const* begin() const;
+	Predicate* const* end() const;
+
+	explicit operator std::set<Predicate*>() const { return std::set<Predicate*>(begin(), end()); }
 
 	std::string to_string() const;
 };
 
 class Predicate {
 public:
-	std::string hash;
-
 	pred_t name;
 	pred_src source;
-	std::vector<Node*> args;
+	PredArgs args;
 	Frac frac_arg;
 	PredSet why;
 
-	int level = Constants::MAX_LEVEL; // for traceback
+	/* Position of the predicate in its `PredicateArena`, assigned on insertion */
+	std::uint32_t index = NO_INDEX;
+	const static std::uint32_t NO_INDEX = UINT32_MAX;
 
-	Predicate() : name(pred_t::BASE), hash(Utils::to_pred_str(pred_t::BASE)), source(pred_src::BASE) {}
+	Predicate() : name(pred_t::BASE), source(pred_src::BASE) {}
 	Predicate(const pred_t name, Frac f, pred_src src = pred_src::BASE);	// placeholder for debugging purposes
-	Predicate(const pred_t name, std::vector<Node*> &&nodes, pred_src src = pred_src::BASE);
-	Predicate(const pred_t name, std::vector<Node*> &&nodes, Frac f, pred_src src = pred_src::BASE);
-	Predicate(const pred_t name, std::vector<Node*> &&nodes, PredSet &&why, pred_src src = pred_src::BASE);
-	Predicate(const pred_t name, std::vector<Node*> &&nodes, Frac f, PredSet &&why, pred_src src = pred_src::BASE);
-	Predicate(const pred_t name, std::vector<Node*> &&nodes, std::set<Predicate*> &&why, pred_src src = pred_src::BASE);
-	Predicate(const pred_t name, std::vector<Node*> &&nodes, Frac f, std::set<Predicate*> &&why, pred_src src = pred_src::BASE);
+	Predicate(const pred_t name, PredArgs nodes, pred_src src = pred_src::BASE);
+	Predicate(const pred_t name, PredArgs nodes, Frac f, pred_src src = pred_src::BASE);
+	Predicate(const pred_t name, PredArgs nodes, PredSet &&why, pred_src src = pred_src::BASE);
+	Predicate(const pred_t name, PredArgs nodes, Frac f, PredSet &&why, pred_src src = pred_src::BASE);
+	Predicate(const pred_t name, PredArgs nodes, std::set<Predicate*> &&why, pred_src src = pred_src::BASE);
+	Predicate(const pred_t name, PredArgs nodes, Frac f, std::set<Predicate*> &&why, pred_src src = pred_src::BASE);
 	Predicate(PredicateTemplate &pred_template, pred_src src = pred_src::BASE);
 
 	static std::unique_ptr<Predicate> 
-	from_global_point_map(const std::string pred_string, std::map<std::string, std::unique_ptr<Point>> &global_point_map);
+	from_global_point_map(const std::string pred_string, std::map<std::string, Point*> &global_point_map);
+
+	/* The structural key of the predicate is not stored, only the permutation `key_order` taking `args` to
+	the canonical order of the key, so that `has_key()` need not canonicalise `args` again. If `args` were
+	rewritten, the key of the original arguments is kept in `key_args`. */
+	std::array<std::uint8_t, PredKey::MAX_ARGS> key_order{};
+	std::unique_ptr<PredArgs> key_args;
+
+	/* Computes `key_order` from the arguments. Called by every constructor. */
+	void __set_key();
+	PredKey key() const;
+	bool has_key(const PredKey& key) const;
+	/* Replaces the arguments, e.g. the directions of a `para` derived by the AREngine by points on them,
+	while keeping the key of the predicate. */
+	void rewrite_args(PredArgs nodes);
+
+	/* Level of the predicate, for traceback. */
+	int get_level() const { return level; }
+	/* Sets the level of the predicate. Every write goes through here, as it invalidates the cached
+	`level()` and `lsum()` of the PredSets of the current pool. */
+	void set_level(int level);
 
 	std::string to_string() const;
 	std::string to_string_with_whys() const;
+
+private:
+	int level = Constants::MAX_LEVEL;
+};
+
+/* Per-problem storage of the predicates known to the DDEngine. Predicates are constructed in place in a
+deque, so they are allocated in blocks and their addresses stay stable. Predicates are only ever released
+all at once, by `clear()`. */
+class PredicateArena {
+	std::deque<Predicate> preds;
+public:
+	/* Constructs a predicate from the arguments of a `Predicate` constructor. */
+	template <typename... Args>
+	Predicate* emplace(Args&&... args) {
+		Predicate* pred = &preds.emplace_back(std::forward<Args>(args)...);
+		pred->index = static_cast<std::uint32_t>(preds.size() - 1);
+		return pred;
+	}
+
+	std::size_t size() const { return preds.size(); }
+	void clear() { preds.clear(); }
 };
 
 class ClauseTemplate {
@@ -148,7 +414,6 @@ public:
 	bool is_empty();
 
 	Generator<std::unique_ptr<Predicate>> instantiate();
-	Generator<std::string> instantiate_hashes();
 
 	std::string to_string();
 };
\ No newline at end of file
@@ -28,17 +28,18 @@ Theorem::Theorem(const std::string &s) {
     name = preconditions.name + "_" + Utils::to_pred_str(postcondition.get()->name);
 };
 
-Generator<std::unique_ptr<Predicate>> Theorem::instantiate_preconditions() {
-    auto preconditions_ = preconditions.instantiate();
-    while (preconditions_) {
-        co_yield std::move(preconditions_());
+std::vector<Predicate> Theorem::instantiate_preconditions() {
+    std::vector<Predicate> preds;
+    preds.reserve(preconditions.predicates.size());
+    for (auto& pred_template : preconditions.predicates) {
+        preds.emplace_back(*pred_template);
     }
+    return preds;
 }
 
-std::unique_ptr<Predicate> Theorem::instantiate_postcondition() {
+Predicate Theorem::instantiate_postcondition() {
     LOG("Instantiating: " << to_string());
-    std::unique_ptr<Predicate> pred_ = postcondition.get()->instantiate();
-    return pred_;
+    return Predicate(*postcondition);
 }
 
 void Theorem::__set_placeholder_args() {
@@ -20,8 +20,8 @@ public:
 
     Theorem(const std::string &s);
 
-    Generator<std::unique_ptr<Predicate>> instantiate_preconditions();
-    std::unique_ptr<Predicate> instantiate_postcondition();
+    std::vector<Predicate> instantiate_preconditions();
+    Predicate instantiate_postcondition();
 
     void __set_placeholder_args();
     void __clear_args();
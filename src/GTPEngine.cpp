@@ -3,7 +3,6 @@
 #include <vector>
 #include <chrono>
 #include <fstream>
-#include <random>
 
 #include "GTPEngine.hh"
 #include "Common/Constants.hh"
@@ -12,32 +11,41 @@
 #include "Geometry/GeometricGraph.hh"
 #include "IO/InputParser.hh"
 #include "Common/StrUtils.hh"
-
-std::random_device rd = std::random_device();
-std::mt19937 gen(rd());
+#include "Common/NumUtils.hh"
+#include "Common/Generator.hh"
 
 GTPEngine::GTPEngine(
     std::string rule_filepath,
     std::string construction_filepath,
     std::string profiler_filepath
+) : GTPEngine(
+    InputParser().parse_rules_from_file(rule_filepath),
+    InputParser().parse_constructions_from_file(construction_filepath),
+    profiler_filepath
 ) {
     this->construction_filepath = construction_filepath;
     this->rule_filepath = rule_filepath;
+}
+
+GTPEngine::GTPEngine(
+    const std::vector<std::string>& rules,
+    const std::vector<std::tuple<std::string, std::string, std::string, std::string>>& constructions,
+    std::string profiler_filepath
+) {
     this->profiler_filepath = profiler_filepath;
 
-    // Read in the constructions and pass them to the DD engine.
-    auto constructions = inputParser.parse_constructions_from_file(construction_filepath);
-    for (auto construction : constructions) {
+    // Pass the constructions to the DD engine.
+    for (const auto& construction : constructions) {
         dd.add_construction_template_from_texts(construction);
     }
 
-    // Read in the rules and pass them to the DD engine.
-    auto rules = inputParser.parse_rules_from_file(rule_filepath);
-    for (auto rule : rules) {
+    // Pass the rules to the DD engine.
+    for (const auto& rule : rules) {
         dd.add_theorem_template_from_text(rule);
     }
 
     this->ggraph.tr = &tr;
+    this->dd.semi_naive = true;
 }
 
 bool GTPEngine::load_problem(
@@ -51,6 +59,8 @@ bool GTPEngine::load_problem(
     this->input_filepath = input_filepath;
     this->problem_name = problem_name;
     this->output_filepath = output_filepath;
+    // Seed each problem from its name, so that its draws don't depend on which problems ran before
+    nm.seed = NumUtils::mix_seed(seed, problem_name);
 
     outputParser.set_output_stream(output_filepath);
     if (!profiler_filepath.empty()) {
@@ -77,7 +87,7 @@ bool GTPEngine::load_problem(
         }
 
         StrUtils::trim(_goal);
-        dd.set_conclusion(Predicate::from_global_point_map(_goal, ggraph.points));
+        dd.set_conclusion(Predicate::from_global_point_map(_goal, ggraph.points_by_name));
 
     } catch (const std::exception& e) {
         std::cerr << "Error loading problem: " << e.what() << std::endl;
@@ -127,19 +137,41 @@ bool GTPEngine::solve(
     // Add numeric values from the NumEngine
     ggraph.initialise_point_numerics(nm);
 
+    // Restrict matching to the region around the goal, if enabled
+    dd.compute_relevance(nm.numerics);
+
+    // Watch the goal, so that synthesis stops as soon as it holds
+    ggraph.watch_conclusion(dd.conclusion_.get());
+
     // Add initial geometric objects (lines, circles, directions etc.) from the initial predicates
     ggraph.synthesise_preds(dd, ar);
     int step = 1;
 
-    for (; step <= max_steps; step++) {
+    if (ggraph.poll_conclusion()) {
+        std::cout << "SOLVED!! Conclusion reached before iteration 1!" << std::endl;
+        solved = true;
+        step = 0;
+    }
+
+    for (; !solved && step <= max_steps; step++) {
 
         std::cout << "-------- Iteration " << step << ": --------\n";
 
+        // Coroutine frames allocated by each phase, to track generator churn
+        std::uint64_t frames_ = FramePool::stats().allocated;
+        auto frames_since = [&frames_]() {
+            std::uint64_t f = FramePool::stats().allocated;
+            long res = f - frames_;
+            frames_ = f;
+            return res;
+        };
+
         auto start_time_ = std::chrono::high_resolution_clock::now();
         dd.search(ggraph, profiler);
         auto end_time_ = std::chrono::high_resolution_clock::now();
         auto duration_ = std::chrono::duration_cast<std::chrono::microseconds>(end_time_ - start_time_).count();
         profiler.dd_p.duration.emplace_back(duration_);
+        profiler.dd_p.frames.emplace_back(frames_since());
 
         start_time_ = std::chrono::high_resolution_clock::now();
         int dd_num_preds = ggraph.synthesise_preds(dd, ar);
@@ -147,19 +179,32 @@ bool GTPEngine::solve(
         duration_ = std::chrono::duration_cast<std::chrono::microseconds>(end_time_ - start_time_).count();
         profiler.ggraph_p.duration_dd.emplace_back(duration_);
         profiler.ggraph_p.num_preds_dd.emplace_back(dd_num_preds);
-
-        start_time_ = std::chrono::high_resolution_clock::now();
-        ar.derive(ggraph, dd, profiler);
-        end_time_ = std::chrono::high_resolution_clock::now();
-        duration_ = std::chrono::duration_cast<std::chrono::microseconds>(end_time_ - start_time_).count();
-        profiler.ar_p.duration.emplace_back(duration_);
-
-        start_time_ = std::chrono::high_resolution_clock::now();
-        int ar_num_preds = ggraph.synthesise_ar_preds(dd);
-        end_time_ = std::chrono::high_resolution_clock::now();
-        duration_ = std::chrono::duration_cast<std::chrono::microseconds>(end_time_ - start_time_).count();
-        profiler.ggraph_p.duration_ar.emplace_back(duration_);
-        profiler.ggraph_p.num_preds_ar.emplace_back(ar_num_preds);
+        profiler.ggraph_p.frames_dd.emplace_back(frames_since());
+
+        // The AR phase cannot be needed once the goal holds
+        int ar_num_preds = 0;
+        if (ggraph.poll_conclusion()) {
+            profiler.ar_p.duration.emplace_back(0);
+            profiler.ar_p.frames.emplace_back(0);
+            profiler.ggraph_p.duration_ar.emplace_back(0);
+            profiler.ggraph_p.num_preds_ar.emplace_back(0);
+            profiler.ggraph_p.frames_ar.emplace_back(0);
+        } else {
+            start_time_ = std::chrono::high_resolution_clock::now();
+            ar.derive(ggraph, dd, profiler);
+            end_time_ = std::chrono::high_resolution_clock::now();
+            duration_ = std::chrono::duration_cast<std::chrono::microseconds>(end_time_ - start_time_).count();
+            profiler.ar_p.duration.emplace_back(duration_);
+            profiler.ar_p.frames.emplace_back(frames_since());
+
+            start_time_ = std::chrono::high_resolution_clock::now();
+            ar_num_preds = ggraph.synthesise_ar_preds(dd);
+            end_time_ = std::chrono::high_resolution_clock::now();
+            duration_ = std::chrono::duration_cast<std::chrono::microseconds>(end_time_ - start_time_).count();
+            profiler.ggraph_p.duration_ar.emplace_back(duration_);
+            profiler.ggraph_p.num_preds_ar.emplace_back(ar_num_preds);
+            profiler.ggraph_p.frames_ar.emplace_back(frames_since());
+        }
 
         profiler.ggraph_p.total_nodes.emplace_back(ggraph.count_nodes());
 
@@ -168,13 +213,24 @@ bool GTPEngine::solve(
 
         
         /* Check if the conclusion was reached. */
-        if (dd.check_conclusion(ggraph)) {
+        if (ggraph.poll_conclusion() || dd.check_conclusion(ggraph)) {
             std::cout << "SOLVED!! Conclusion reached at iteration " << step << "!" << std::endl;
             solved = true;
             break;
         }
 
         if (dd_num_preds == 0 && ar_num_preds == 0) {
+            if (dd.widen_relevance()) {
+                // Matches outside the old region may involve unchanged nodes, so rematch everything
+                std::cout << "Widening the region around the goal." << std::endl;
+                ggraph.all_changed = true;
+                continue;
+            }
+            if (!dd.last_pass_full) {
+                // Confirm saturation with a full DD pass before giving up
+                ggraph.all_changed = true;
+                continue;
+            }
             std::cout << "UNSOLVED!! No new predicates derived." << std::endl;
             break;
         }
@@ -1,4 +1,7 @@
 #include <string>
+#include <vector>
+#include <tuple>
+#include <cstdint>
 
 #include "DD/DDEngine.hh"
 #include "AR/AREngine.hh"
@@ -29,6 +32,9 @@ public:
 
     std::string problem_name;
 
+    /* Base seed from which the seeds of each problem and draw are derived. */
+    std::uint64_t seed = 0;
+
     bool solved = false;
 
     GTPEngine(
@@ -37,6 +43,14 @@ public:
         std::string profiler_filepath
     );
 
+    /* Builds an engine from rules and constructions that were already parsed. This lets batch
+    workers share a single parsed copy of the rule and construction files. */
+    GTPEngine(
+        const std::vector<std::string>& rules,
+        const std::vector<std::tuple<std::string, std::string, std::string, std::string>>& constructions,
+        std::string profiler_filepath
+    );
+
     bool load_problem(
         std::string input_filepath,
         std::string problem_name,
@@ -25,6 +25,71 @@
 #endif
 
 
+namespace {
+    // Width of the cells of the `PointNumerics` grid. Points equal up to `TOL` lie in adjacent cells.
+    const double GRID_CELL_WIDTH = 2 * TOL;
+    // Largest magnitude of a cell index, well within `std::int64_t` for the neighbouring cells too
+    const double GRID_MAX_CELL = 4e18;
+}
+
+std::size_t PointNumerics::CellHash::operator()(const Cell& c) const {
+    std::uint64_t h = static_cast<std::uint64_t>(c.first) * 0x9E3779B97F4A7C15ull;
+    h ^= static_cast<std::uint64_t>(c.second) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+std::optional<PointNumerics::Cell> PointNumerics::__cell(const CartesianPoint& cp) {
+    double cx = std::floor(cp.x / GRID_CELL_WIDTH);
+    double cy = std::floor(cp.y / GRID_CELL_WIDTH);
+    // Also rejects NaNs and infinities
+    if (!(std::abs(cx) < GRID_MAX_CELL && std::abs(cy) < GRID_MAX_CELL)) return std::nullopt;
+    return Cell{static_cast<std::int64_t>(cx), static_cast<std::int64_t>(cy)};
+}
+
+void PointNumerics::set(Point* p, CartesianPoint cp) {
+    if (contains(p)) {
+        if (auto cell = __cell(at(p))) std::erase(grid[*cell], p);
+        else std::erase(off_grid, p);
+    } else if (p->id >= pts.size()) {
+        pts.resize(p->id + 1, nullptr);
+        xs.resize(p->id + 1, 0);
+        ys.resize(p->id + 1, 0);
+    }
+    pts[p->id] = p;
+    xs[p->id] = cp.x;
+    ys[p->id] = cp.y;
+    if (auto cell = __cell(cp)) grid[*cell].emplace_back(p);
+    else off_grid.emplace_back(p);
+}
+
+std::vector<Point*> PointNumerics::find_equal(const CartesianPoint& cp) const {
+    std::vector<Point*> res;
+    auto cell = __cell(cp);
+    if (!cell) {
+        // Points off the grid may be equal to any point, so scan them all
+        for (Point* p : pts) {
+            if (p && at(p) == cp) res.emplace_back(p);
+        }
+        return res;
+    }
+    for (std::int64_t dx = -1; dx <= 1; dx++) {
+        for (std::int64_t dy = -1; dy <= 1; dy++) {
+            auto it = grid.find({cell->first + dx, cell->second + dy});
+            if (it == grid.end()) continue;
+            for (Point* p : it->second) {
+                if (at(p) == cp) res.emplace_back(p);
+            }
+        }
+    }
+    for (Point* p : off_grid) {
+        if (at(p) == cp) res.emplace_back(p);
+    }
+    std::sort(res.begin(), res.end(), [](Point* a, Point* b) { return a->id < b->id; });
+    return res;
+}
+
+
+
 void GeometricGraph::initialise_point_numerics(NumEngine &nm) {
     // Fill in the points
     for (Point* p : nm.order_of_resolution) {
@@ -32,27 +97,27 @@ void GeometricGraph::initialise_point_numerics(NumEngine &nm) {
         __identify_num_eq_points(p);
         LOG(p->name << " : " << point_nums.at(p).to_string());
     }
+    point_triples.reset(points.size());
 }
 void GeometricGraph::__set_point_numeric(Point* p, CartesianPoint cp) {
-    point_nums[p] = cp;
+    // Memoised checks involving `p` are stale if it is being moved
+    if (point_nums.contains(p)) point_triples.clear();
+    point_nums.set(p, cp);
 }
 void GeometricGraph::__identify_num_eq_points(Point* new_p) {
-    CartesianPoint cp = point_nums.at(new_p);
-    for (const auto& [other_p, other_cp] : point_nums) {
+    for (Point* other_p : point_nums.find_equal(point_nums.at(new_p))) {
         if (other_p == new_p) continue;
-        if (cp == other_cp) {
-            int set_num;
-            if (point_to_num_eq_set.contains(other_p)) {
-                set_num = point_to_num_eq_set.at(other_p);
-            } else {
-                set_num = num_eq_point_sets.size();
-                num_eq_point_sets.emplace_back(std::set<Point*>{other_p});
-                point_to_num_eq_set.insert({other_p, set_num});
-            }
-            num_eq_point_sets[set_num].insert(new_p);
-            point_to_num_eq_set.insert({new_p, set_num});
-            return;
+        int set_num;
+        if (point_to_num_eq_set.contains(other_p)) {
+            set_num = point_to_num_eq_set.at(other_p);
+        } else {
+            set_num = num_eq_point_sets.size();
+            num_eq_point_sets.emplace_back(std::set<Point*, NodeOrder>{other_p});
+            point_to_num_eq_set.insert({other_p, set_num});
         }
+        num_eq_point_sets[set_num].insert(new_p);
+        point_to_num_eq_set.insert({new_p, set_num});
+        return;
     }
 }
 
@@ -86,21 +151,22 @@ double GeometricGraph::compute_direction_angle(Line* l) {
 
 
 Point* GeometricGraph::__add_new_point(const std::string point_id, CartesianPoint&& coords) {
-    if (Utils::isinmap(point_id, points)) {
+    if (points_by_name.contains(point_id)) {
         throw GGraphInternalError("Error: Point with id " + point_id + " already exists in GeometricGraph.");
     }
-    points[point_id] = std::make_unique<Point>(point_id);
-    Point* p = points[point_id].get();
+    Point* p = points.emplace(point_id);
+    points_by_name[point_id] = p;
     root_points.insert(p);
 
-    point_nums[p] = std::move(coords);
+    point_nums.set(p, coords);
     return p;
 }
 
 void GeometricGraph::__try_add_point(const std::string point_id) {
-    if (!points.contains(point_id)) {
-        points[point_id] = std::make_unique<Point>(point_id);
-        root_points.insert(points[point_id].get());
+    if (!points_by_name.contains(point_id)) {
+        Point* p = points.emplace(point_id);
+        points_by_name[point_id] = p;
+        root_points.insert(p);
         new_object = true;
     } else {
         new_object = false;
@@ -109,7 +175,7 @@ void GeometricGraph::__try_add_point(const std::string point_id) {
 
 Point* GeometricGraph::get_or_add_point(const std::string point_id) {
     __try_add_point(point_id);
-    return points[point_id].get();
+    return points_by_name[point_id];
 }
 
 void GeometricGraph::merge_points(Point* dest, Point* src, PredSet preds, DDEngine& dd, AREngine& ar) {
@@ -124,7 +190,7 @@ void GeometricGraph::merge_points(Point* dest, Point* src, PredSet preds, DDEngi
 
     // Check for newly incident lines
     std::map<std::string, Line*> line_merger_order;
-    std::map<Line*, std::vector<std::pair<Line*, PredSet>>> to_merge_lines;
+    std::map<Line*, std::vector<std::pair<Line*, PredSet>>, NodeOrder> to_merge_lines;
     auto gen_to_merge_lines = Line::check_incident_lines(root_dest, root_src);
     while (gen_to_merge_lines) {
         auto [point, lines] = gen_to_merge_lines();
@@ -146,7 +212,7 @@ void GeometricGraph::merge_points(Point* dest, Point* src, PredSet preds, DDEngi
 
     // And newly incident circles
     std::map<std::string, Circle*> circle_merger_order;
-    std::map<Circle*, std::vector<std::pair<Circle*, PredSet>>> to_merge_circles;
+    std::map<Circle*, std::vector<std::pair<Circle*, PredSet>>, NodeOrder> to_merge_circles;
     auto gen_to_merge_circles_1 = Circle::check_incident_circles_by_intersections(root_dest, root_src);
     while (gen_to_merge_circles_1) {
         auto [points, circles] = gen_to_merge_circles_1();
@@ -193,7 +259,7 @@ void GeometricGraph::merge_points(Point* dest, Point* src, PredSet preds, DDEngi
 
 
     // And newly incident segments
-    std::map<Segment*, std::vector<std::pair<Segment*, PredSet>>> to_merge_segments;
+    std::map<Segment*, std::vector<std::pair<Segment*, PredSet>>, NodeOrder> to_merge_segments;
     auto gen_to_merge_segments = Segment::check_incident_segments(root_dest, root_src);
     while (gen_to_merge_segments) {
         auto pair = gen_to_merge_segments();
@@ -222,13 +288,16 @@ void GeometricGraph::merge_points(Point* dest, Point* src, PredSet preds, DDEngi
     }
 
     // Finally, merge the points themselves
-    Predicate* merger_pred = dd.insert_new_predicate(std::make_unique<Predicate>(
-        pred_t::EQ, std::vector<Node*>{root_dest, root_src},
+    Predicate* merger_pred = dd.insert_new_predicate(
+        pred_t::EQ, {root_dest, root_src},
          std::move(preds), pred_src::GGRAPH
-    ));
+    );
 
     ar.update_point_merger(root_dest, root_src, merger_pred);
     root_dest->merge(root_src, merger_pred);
+    for (Line* l : root_dest->on_root_line) __index_line(l, root_dest);
+    for (Circle* c : root_dest->on_root_circle) __index_circle(c, root_dest);
+    record_change(root_dest);
 }
 
 
@@ -241,16 +310,17 @@ Line* GeometricGraph::__add_new_line(Point* p1, Point* p2, Predicate* base_pred)
         std::swap(p1, p2);
     }
     std::string line_id = "l_" + p1->name + "_" + p2->name;
-    if (Utils::isinmap(line_id, lines)) {
+    if (lines.contains(line_id)) {
         throw GGraphInternalError("Error: Line with id " + line_id + " already exists in GeometricGraph.");
     }
-    lines[line_id] = std::make_unique<Line>(line_id, p1, p2);
-    Line* l = lines[line_id].get();
+    Line* l = lines.emplace(line_id, p1, p2);
     line_nums[l] = compute_line_from_points(p1, p2); // throws NumericsInternalError if line is degenerate
 
     root_lines.insert(l);
     p1->set_this_on(l);
     p2->set_this_on(l);
+    __index_line(l);
+    record_change(l);
 
     // For traceback:
     tr->set_point_on(p1, l, base_pred);
@@ -260,16 +330,37 @@ Line* GeometricGraph::__add_new_line(Point* p1, Point* p2, Predicate* base_pred)
 }
 
 Line* GeometricGraph::__try_get_line(Point* p1, Point* p2) {
-    auto gen = p1->on_lines();
-    Line* l = nullptr;
-    while (gen) {
-        Line* l0 = gen();
-        if (l0->contains(p2)) {
-            l = l0;
-            break;
+    p1 = NodeUtils::get_root(p1);
+    p2 = NodeUtils::get_root(p2);
+    if (p1 == p2) {
+        return p1->on_root_line.empty() ? nullptr : *p1->on_root_line.begin();
+    }
+    auto it = line_index.find(NodeUtils::id_key(p1, p2));
+    if (it == line_index.end()) return nullptr;
+    return NodeUtils::get_root(it->second);
+}
+void GeometricGraph::__index_line(Line* l) {
+    l = NodeUtils::get_root(l);
+    for (auto it1 = l->points.begin(); it1 != l->points.end(); ++it1) {
+        for (auto it2 = std::next(it1); it2 != l->points.end(); ++it2) {
+            line_index[NodeUtils::id_key(*it1, *it2)] = l;
+        }
+    }
+}
+void GeometricGraph::__index_line(Line* l, Point* p) {
+    l = NodeUtils::get_root(l);
+    for (Point* q : l->points) {
+        if (q != p) line_index[NodeUtils::id_key(p, q)] = l;
+    }
+}
+void GeometricGraph::__index_line_merger(Line* dest, Line* src) {
+    // Pairs of points both on `src` are already indexed under `src`, whose root will be `dest`
+    for (Point* p : src->points) {
+        if (dest->points.contains(p)) continue;
+        for (Point* q : dest->points) {
+            line_index[NodeUtils::id_key(p, q)] = dest;
         }
     }
-    return l;
 }
 
 Line* GeometricGraph::get_or_add_line(Point* p1, Point* p2, DDEngine &dd) {
@@ -295,7 +386,7 @@ void GeometricGraph::merge_lines(
 ) {
     Line* root_dest = NodeUtils::get_root(dest);
 
-    std::map<Line*, PredSet> L{{root_dest, {}}}, L1{}, L2{};
+    std::map<Line*, PredSet, NodeOrder> L{{root_dest, {}}}, L1{}, L2{};
 
     for (auto& [src, preds] : srcs) {
         Line* root_src = NodeUtils::get_root(src);
@@ -346,9 +437,9 @@ void GeometricGraph::merge_lines(
                             l_preds += tr->why_on(p2, l2);
                             l_preds += tr->why_on(p1, l);
                             l_preds += tr->why_on(p2, l);
-                            l_preds += dd.insert_predicate(std::make_unique<Predicate>(
-                                pred_t::DIFF, std::vector<Node*>{p1, p2}, pred_src::BASE
-                            ));
+                            l_preds += dd.insert_predicate(
+                                pred_t::DIFF, {p1, p2}, pred_src::BASE
+                            );
                             L2.insert({l, l_preds});
 
                             // elements_of_L2 += res.first->name + " (" + (res.second.first->name) + " " + (res.second.second->name) + "), ";
@@ -377,10 +468,10 @@ void GeometricGraph::merge_lines(
 
         // Predicate for merging the lines
         PredSet l_preds = it->second;
-        Predicate* merger_pred = dd.insert_new_predicate(std::make_unique<Predicate>(
-            pred_t::EQ, std::vector<Node*>{root_dest, l},
+        Predicate* merger_pred = dd.insert_new_predicate(
+            pred_t::EQ, {root_dest, l},
              std::move(l_preds), pred_src::GGRAPH
-        ));
+        );
 
         // Predicate for merging their directions
         PredSet l_dir_preds(merger_pred);
@@ -389,6 +480,7 @@ void GeometricGraph::merge_lines(
         }
 
         ar.update_line_merger(root_dest, l, merger_pred);
+        __index_line_merger(root_dest, l);
         auto dirs = root_dest->merge(l, merger_pred);
 
         // Check if the lines have directions that need to be merged
@@ -396,6 +488,7 @@ void GeometricGraph::merge_lines(
             to_merge_dirs.emplace_back(dirs->first, dirs->second, root_dest_dir_preds + l_dir_preds);
         }
     }
+    record_change(root_dest);
     for (const auto& [d1, d2, preds] : to_merge_dirs) {
         set_directions_para(d1, d2, preds, dd);
     }
@@ -424,6 +517,8 @@ bool GeometricGraph::add_point_to_line(Line* qr, Point* p, PredSet preds, DDEngi
     }
     if (to_merge_lines.empty()) {
         p->set_this_on(qr);
+        __index_line(qr, p);
+        record_change(qr);
         return false;
     }
     merge_lines(qr, std::move(to_merge_lines), dd, ar);
@@ -435,16 +530,16 @@ bool GeometricGraph::add_point_to_line(Line* qr, Point* p, PredSet preds, DDEngi
 
 Direction* GeometricGraph::__add_new_direction(Line* l, Predicate* base_pred) {
     std::string dir_id = "d_" + l->name;
-    if (Utils::isinmap(dir_id, directions)) {
+    if (directions.contains(dir_id)) {
         throw GGraphInternalError("Error: Direction with id " + dir_id + " already exists in GeometricGraph.");
     }
-    directions[dir_id] = std::make_unique<Direction>(dir_id);
-    Direction* dir = directions[dir_id].get();
+    Direction* dir = directions.emplace(dir_id);
     direction_gradients[dir] = compute_direction_angle(l);
 
     dir->add_line(l);
     l->set_direction(dir);
     root_directions.insert(dir);
+    record_change(dir);
 
     // For traceback
     tr->set_direction_of(dir, l, base_pred);
@@ -491,12 +586,13 @@ void GeometricGraph::set_directions_para(Direction* dest, Direction* src, PredSe
         merge_angles(pair.first, pair.second, angle_merge_preds, dd);
     }
 
-    Predicate* merger_pred = dd.insert_new_predicate(std::make_unique<Predicate>(
-        pred_t::EQ, std::vector<Node*>{root_dest, root_src},
+    Predicate* merger_pred = dd.insert_new_predicate(
+        pred_t::EQ, {root_dest, root_src},
          std::move(preds), pred_src::GGRAPH
-    ));
+    );
     
     root_dest->merge(root_src, merger_pred);
+    record_change(root_dest);
 
     // Check if the directions' perps also need to be merged
     if (root_dest_perp && root_src_perp && !NodeUtils::same_as(root_dest_perp, root_src_perp)) {
@@ -560,16 +656,18 @@ void GeometricGraph::set_directions_perp(Direction* d1, Direction* d2, PredSet p
     // (rd1 <- dp2) perp to (rd2 <- dp1)
 
     rd1->set_perp(rd2);
+    record_change(rd1);
+    record_change(rd2);
 
     if (dp1) {
         root_directions.erase(dp1);
 
         PredSet preds_1(preds);
         preds_1 += tr->why_directions_perp(rd1, dp1);
-        Predicate* merger_pred_1 = dd.insert_predicate(std::make_unique<Predicate>(
-            pred_t::EQ, std::vector<Node*>{rd2, dp1}, 
+        Predicate* merger_pred_1 = dd.insert_predicate(
+            pred_t::EQ, {rd2, dp1}, 
             std::move(preds_1), pred_src::GGRAPH
-        ));
+        );
 
         rd2->merge(dp1, merger_pred_1);
         tr->record_merge(rd2, dp1);
@@ -579,10 +677,10 @@ void GeometricGraph::set_directions_perp(Direction* d1, Direction* d2, PredSet p
 
         PredSet preds_2(preds);
         preds_2 += tr->why_directions_perp(rd2, dp2);
-        Predicate* merger_pred_2 = dd.insert_predicate(std::make_unique<Predicate>(
-            pred_t::EQ, std::vector<Node*>{rd1, dp2}, 
+        Predicate* merger_pred_2 = dd.insert_predicate(
+            pred_t::EQ, {rd1, dp2}, 
             std::move(preds_2), pred_src::GGRAPH
-        ));
+        );
 
         rd1->merge(dp2, merger_pred_2);
         tr->record_merge(rd1, dp2);
@@ -600,17 +698,18 @@ Circle* GeometricGraph::__add_new_circle(Point* p1, Point* p2, Point* p3, Predic
     if (p2->name > p3->name) std::swap(p2, p3);
     if (p1->name > p2->name) std::swap(p1, p2);
     std::string circle_id = "c_" + p1->name + "_" + p2->name + "_" + p3->name;
-    if (Utils::isinmap(circle_id, circles)) {
+    if (circles.contains(circle_id)) {
         throw GGraphInternalError("Error: Circle " + circle_id + " already exists in GeometricGraph.");
     }
-    circles[circle_id] = std::make_unique<Circle>(circle_id, p1, p2, p3);
-    Circle* circ = circles[circle_id].get();
+    Circle* circ = circles.emplace(circle_id, p1, p2, p3);
     circle_nums[circ] = compute_circle_from_points(p1, p2, p3); // throws NumericsInternalError if points are collinear or coincide
 
     root_circles.insert(circ);
     p1->set_this_on(circ);
     p2->set_this_on(circ);
     p3->set_this_on(circ);
+    __index_circle(circ);
+    record_change(circ);
 
     // For traceback
     tr->set_point_on(p1, circ, base_pred);
@@ -621,16 +720,16 @@ Circle* GeometricGraph::__add_new_circle(Point* p1, Point* p2, Point* p3, Predic
 }
 Circle* GeometricGraph::__add_new_circle(Point* c, Point* p1, Predicate* base_pred) {
     std::string circle_id = "c_" + c->name + "_" + p1->name;
-    if (Utils::isinmap(circle_id, circles)) {
+    if (circles.contains(circle_id)) {
         throw GGraphInternalError("Error: Circle " + circle_id + " already exists in GeometricGraph.");
     }
-    circles[circle_id] = std::make_unique<Circle>(circle_id, c, p1);
-    Circle* circ = circles[circle_id].get();
+    Circle* circ = circles.emplace(circle_id, c, p1);
     circle_nums[circ] = compute_circle_from_points(c, p1); // throws NumericsInternalError if c, p1 coincide
 
     root_circles.insert(circ);
     p1->set_this_on(circ);
     c->set_this_center_of(circ);
+    record_change(circ);
 
     // For traceback
     tr->set_point_on(p1, circ, base_pred);
@@ -640,12 +739,12 @@ Circle* GeometricGraph::__add_new_circle(Point* c, Point* p1, Predicate* base_pr
 }
 Circle* GeometricGraph::__add_new_circle(Point* c, Predicate* base_pred) {
     std::string circle_id = "c_" + c->name;
-    if (Utils::isinmap(circle_id, circles)) {
+    if (circles.contains(circle_id)) {
         throw GGraphInternalError("Error: Circle " + circle_id + " already exists in GeometricGraph.");
     }
-    circles[circle_id] = std::make_unique<Circle>(circle_id, c);
-    Circle* circ = circles[circle_id].get();
+    Circle* circ = circles.emplace(circle_id, c);
     root_circles.insert(circ);
+    record_change(circ);
 
     tr->set_point_as_center(c, circ, base_pred);
 
@@ -656,16 +755,55 @@ Circle* GeometricGraph::__add_new_circle(Point* c, Predicate* base_pred) {
 }
 
 Circle* GeometricGraph::__try_get_circle(Point* p1, Point* p2, Point* p3) {
-    auto gen = p1->on_circles();
-    Circle* circ = nullptr;
-    while (gen) {
-        Circle* circ0 = gen();
-        if (circ0->contains(p2) && circ0->contains(p3)) {
-            circ = circ0;
-            break;
+    if ((p1 == p2) || (p2 == p3) || (p3 == p1)) {
+        // Not a triple, so fall back to scanning the circles through `p1`
+        auto gen = p1->on_circles();
+        while (gen) {
+            Circle* circ0 = gen();
+            if (circ0->contains(p2) && circ0->contains(p3)) return circ0;
         }
+        return nullptr;
+    }
+    auto it = circle_index.find(NodeUtils::id_key(p1, p2, p3));
+    if (it == circle_index.end()) return nullptr;
+    return NodeUtils::get_root(it->second);
+}
+void GeometricGraph::__index_circle(Circle* c) {
+    c = NodeUtils::get_root(c);
+    for (auto it1 = c->points.begin(); it1 != c->points.end(); ++it1) {
+        for (auto it2 = std::next(it1); it2 != c->points.end(); ++it2) {
+            for (auto it3 = std::next(it2); it3 != c->points.end(); ++it3) {
+                circle_index[NodeUtils::id_key(*it1, *it2, *it3)] = c;
+            }
+        }
+    }
+}
+void GeometricGraph::__index_circle(Circle* c, Point* p) {
+    c = NodeUtils::get_root(c);
+    for (auto it1 = c->points.begin(); it1 != c->points.end(); ++it1) {
+        if (*it1 == p) continue;
+        for (auto it2 = std::next(it1); it2 != c->points.end(); ++it2) {
+            if (*it2 != p) circle_index[NodeUtils::id_key(p, *it1, *it2)] = c;
+        }
+    }
+}
+void GeometricGraph::__index_circle_merger(Circle* dest, Circle* src) {
+    /* Triples of points all on `src` are already indexed under `src`, whose root will be `dest`. The
+    remaining new triples contain a point `p` of `src` which is not on `dest` and a point `q` on `dest`.
+    Each is indexed once, at the last such `p` it contains. */
+    std::vector<Point*> added;
+    for (Point* p : src->points) {
+        if (dest->points.contains(p)) continue;
+        for (auto it = dest->points.begin(); it != dest->points.end(); ++it) {
+            for (auto it2 = std::next(it); it2 != dest->points.end(); ++it2) {
+                circle_index[NodeUtils::id_key(p, *it, *it2)] = dest;
+            }
+            for (Point* r : added) {
+                circle_index[NodeUtils::id_key(p, *it, r)] = dest;
+            }
+        }
+        added.push_back(p);
     }
-    return circ;
 }
 Circle* GeometricGraph::__try_get_circle(Point* c, Point* p1) {
     auto gen = c->center_of_circles();
@@ -680,29 +818,12 @@ Circle* GeometricGraph::__try_get_circle(Point* c, Point* p1) {
     return circ;
 }
 std::pair<Circle*, Circle*> GeometricGraph::__try_get_circles(Point* p1, Point* p2, Point* p3, Point* p4) {
-    auto gen = p1->on_circles();
     std::pair<Circle*, Circle*> ret = {nullptr, nullptr};
-    while (gen) {
-        Circle* circ0 = gen();
-        if (circ0->contains(p2)) {
-            if (ret.first == nullptr) {
-                if (circ0->contains(p3)) {
-                    if (!NodeUtils::same_as(p1, p3) && !NodeUtils::same_as(p2, p3)) {
-                        ret.first = circ0;
-                    }
-                }
-            }
-            if (ret.second == nullptr) {
-                if (circ0->contains(p4)) {
-                    if (!NodeUtils::same_as(p1, p4) && !NodeUtils::same_as(p2, p4)) {
-                        ret.second = circ0;
-                    }
-                }
-            }
-            if (ret.first) {
-                if (ret.second) break;
-            }
-        }
+    if (!NodeUtils::same_as(p1, p3) && !NodeUtils::same_as(p2, p3)) {
+        ret.first = __try_get_circle(p1, p2, p3);
+    }
+    if (!NodeUtils::same_as(p1, p4) && !NodeUtils::same_as(p2, p4)) {
+        ret.second = __try_get_circle(p1, p2, p4);
     }
     return ret;
 }
@@ -757,9 +878,14 @@ Point* GeometricGraph::get_or_add_circle_center(Circle* c, DDEngine& dd) {
         return p;
     }
     std::string p_id = "adhoc_p" + std::to_string(adhoc++);
-    points[p_id] = std::make_unique<Point>(p_id);
-    p = points[p_id].get();
+    p = points.emplace(p_id);
+    points_by_name[p_id] = p;
+    if (circle_nums.contains(c)) {
+        __set_point_numeric(p, circle_nums.at(c).c);
+        __identify_num_eq_points(p);
+    }
     c->set_center(p);
+    record_change(c);
     new_object = true;
 
     tr->set_point_as_center(p, c, dd.base_pred.get());
@@ -768,12 +894,13 @@ Point* GeometricGraph::get_or_add_circle_center(Circle* c, DDEngine& dd) {
 
 void GeometricGraph::set_circle_center(Point* cp, Circle* c, Predicate* pred) {
     NodeUtils::get_root(c)->set_center(NodeUtils::get_root(cp));
+    record_change(c);
     tr->set_point_as_center(cp, c, pred);
 }
 void GeometricGraph::merge_circles(Circle* dest, std::vector<std::pair<Circle*, PredSet>> srcs, DDEngine& dd, AREngine& ar) {
     Circle* root_dest = NodeUtils::get_root(dest);
 
-    std::map<Circle*, PredSet> C{{root_dest, {}}}, C1{}, C2{};
+    std::map<Circle*, PredSet, NodeOrder> C{{root_dest, {}}}, C1{}, C2{};
 
     for (auto& [src, preds] : srcs) {
         Circle* root_src = NodeUtils::get_root(src);
@@ -828,16 +955,16 @@ void GeometricGraph::merge_circles(Circle* dest, std::vector<std::pair<Circle*,
                         if (p2 && (point_nums.at(p1) != point_nums.at(p2))) {
                             Point* p1_ = p1, *p2_ = p2;
                             if (p1_->name > p2_->name) std::swap(p1_, p2_);
-                            c_preds += dd.insert_predicate(std::make_unique<Predicate>(
-                                pred_t::DIFF, std::vector<Node*>{p1_, p2_}, pred_src::BASE
-                            )); 
+                            c_preds += dd.insert_predicate(
+                                pred_t::DIFF, {p1_, p2_}, pred_src::BASE
+                            ); 
                         }
                         if (p4 && (point_nums.at(p3) != point_nums.at(p4))) {
                             Point* p3_ = p3, *p4_ = p4;
                             if (p3_->name > p4_->name) std::swap(p3_, p4_);
-                            c_preds += dd.insert_predicate(std::make_unique<Predicate>(
-                                pred_t::DIFF, std::vector<Node*>{p3_, p4_}, pred_src::BASE
-                            ));
+                            c_preds += dd.insert_predicate(
+                                pred_t::DIFF, {p3_, p4_}, pred_src::BASE
+                            );
                         }
                         C2.insert({c, c_preds});
                     }
@@ -888,10 +1015,10 @@ void GeometricGraph::merge_circles(Circle* dest, std::vector<std::pair<Circle*,
 
         // Predicates for merging circles
         PredSet c_preds = it->second;
-        Predicate* merger_pred = dd.insert_new_predicate(std::make_unique<Predicate>(
-            pred_t::EQ, std::vector<Node*>{root_dest, c},
+        Predicate* merger_pred = dd.insert_new_predicate(
+            pred_t::EQ, {root_dest, c},
             std::move(c_preds), pred_src::GGRAPH
-        ));
+        );
         
         // Predicates for merging circle centers
         PredSet center_merge_preds(merger_pred);
@@ -899,6 +1026,7 @@ void GeometricGraph::merge_circles(Circle* dest, std::vector<std::pair<Circle*,
             center_merge_preds += tr->why_center(c->get_center(), c);
         }
 
+        __index_circle_merger(root_dest, c);
         auto centers = root_dest->merge(c, merger_pred);
         tr->record_merge(root_dest, c);
 
@@ -906,6 +1034,7 @@ void GeometricGraph::merge_circles(Circle* dest, std::vector<std::pair<Circle*,
             to_merge_centers.emplace_back(centers->first, centers->second, center_merge_preds + root_center_preds);
         }
     }
+    record_change(root_dest);
     for (const auto& [cp1, cp2, preds] : to_merge_centers) {
         merge_points(cp1, cp2, preds, dd, ar);
     }
@@ -923,11 +1052,10 @@ Segment* GeometricGraph::__add_new_segment(Point* p1, Point* p2, Line* l, Predic
         std::swap(p1, p2);
     }
     std::string segment_id = "s_" + p1->name + "_" + p2->name;
-    if (Utils::isinmap(segment_id, segments)) {
+    if (segments.contains(segment_id)) {
         throw GGraphInternalError("Error: Segment with id " + segment_id + " already exists in GeometricGraph.");
     }
-    segments[segment_id] = std::make_unique<Segment>(segment_id, p1, p2, l, base_pred);
-    Segment* s = segments[segment_id].get();
+    Segment* s = segments.emplace(segment_id, p1, p2, l, base_pred);
 
     root_segments.insert(s);
     p1->set_this_endpoint_of(s);
@@ -974,14 +1102,16 @@ void GeometricGraph::merge_segments(Segment* dest, Segment* src, PredSet preds,
 
     root_segments.erase(root_src);
 
-    Predicate* merger_pred = dd.insert_new_predicate(std::make_unique<Predicate>(
-        pred_t::EQ, std::vector<Node*>{root_dest, root_src}, 
+    Predicate* merger_pred = dd.insert_new_predicate(
+        pred_t::EQ, {root_dest, root_src}, 
         std::move(preds), pred_src::GGRAPH
-    ));
+    );
 
     auto l2 = root_dest->merge(root_src, merger_pred);
     if (l2) {
         set_lengths_cong(l2->first, l2->second, merger_pred, dd);
+    } else if (root_dest->has_length()) {
+        record_change(root_dest->get_length());
     }
 }
 
@@ -989,13 +1119,13 @@ void GeometricGraph::merge_segments(Segment* dest, Segment* src, PredSet preds,
 
 Length* GeometricGraph::__add_new_length(Segment* s, Predicate* base_pred) {
     std::string length_id = "len_" + s->name;
-    if (Utils::isinmap(length_id, lengths)) {
+    if (lengths.contains(length_id)) {
         throw GGraphInternalError("Error: Length with id " + length_id + " already exists in GeometricGraph.");
     }
-    lengths[length_id] = std::make_unique<Length>(length_id);
-    Length* l = lengths[length_id].get();
+    Length* l = lengths.emplace(length_id);
     l->add_segment(s);
     root_lengths.insert(l);
+    record_change(l);
 
     // For traceback
     tr->set_length_of(l, s, base_pred);
@@ -1053,12 +1183,13 @@ void GeometricGraph::set_lengths_cong(Length* l1, Length* l2, PredSet preds, DDE
         // No traceback necessary
     }
 
-    Predicate* merger_pred = dd.insert_new_predicate(std::make_unique<Predicate>(
-        pred_t::EQ, std::vector<Node*>{root_l1, root_l2}, 
+    Predicate* merger_pred = dd.insert_new_predicate(
+        pred_t::EQ, {root_l1, root_l2}, 
         std::move(preds), pred_src::GGRAPH
-    ));
+    );
 
     root_l1->merge(root_l2, merger_pred);
+    record_change(root_l1);
     
     tr->record_merge(root_l1, root_l2);
 }
@@ -1069,12 +1200,15 @@ void GeometricGraph::set_lengths_cong(Length* l1, Length* l2, PredSet preds, DDE
 
 Angle* GeometricGraph::__add_new_angle(Direction* d1, Direction* d2, Predicate* base_pred) {
     std::string angle_id = "a_" + d1->name + "_" + d2->name;
-    if (Utils::isinmap(angle_id, angles)) {
+    if (angles.contains(angle_id)) {
         throw GGraphInternalError("Error: Angle with id " + angle_id + " already exists in GeometricGraph.");
     }
-    angles[angle_id] = std::make_unique<Angle>(angle_id, d1, d2);
-    Angle* a = angles[angle_id].get();
+    Angle* a = angles.emplace(angle_id, d1, d2);
+    // The sets of angles on a direction are ordered by `id`, so `a` may only join them now
+    d1->on_angles_1.insert(a);
+    d2->on_angles_2.insert(a);
     root_angles.insert(a);
+    record_change(a);
 
     tr->make_angle_with_directions(a, d1, d2);
 
@@ -1225,10 +1359,10 @@ void GeometricGraph::merge_angles(Angle* dest, Angle* src, PredSet preds, DDEngi
 
     root_angles.erase(root_src);
 
-    Predicate* merger_pred = dd.insert_predicate(std::make_unique<Predicate>(
-        pred_t::EQ, std::vector<Node*>{root_dest, root_src}, 
+    Predicate* merger_pred = dd.insert_predicate(
+        pred_t::EQ, {root_dest, root_src}, 
         std::move(preds), pred_src::GGRAPH
-    ));
+    );
 
     auto ms = root_dest->merge(root_src, merger_pred);
 
@@ -1238,6 +1372,7 @@ void GeometricGraph::merge_angles(Angle* dest, Angle* src, PredSet preds, DDEngi
         measure_merge_preds += tr->why_measure_of(ms->second, root_src);
         set_measures_equal(ms->first, ms->second, measure_merge_preds, dd);
     }
+    record_change(root_dest);
     tr->record_merge(root_dest, root_src);
 }
 
@@ -1246,13 +1381,13 @@ void GeometricGraph::merge_angles(Angle* dest, Angle* src, PredSet preds, DDEngi
 
 Measure* GeometricGraph::__add_new_measure(Angle* a, Predicate* base_pred) {
     std::string measure_id = "m_" + a->name;
-    if (Utils::isinmap(measure_id, measures)) {
+    if (measures.contains(measure_id)) {
         throw GGraphInternalError("Error: Measure with id " + measure_id + " already exists in GeometricGraph.");
     }
-    measures[measure_id] = std::make_unique<Measure>(measure_id);
-    Measure* m = measures[measure_id].get();
+    Measure* m = measures.emplace(measure_id);
     a->set_measure(m);
     root_measures.insert(m);
+    record_change(m);
 
     // For traceback
     tr->set_measure_of(m, a, base_pred);
@@ -1280,12 +1415,13 @@ void GeometricGraph::set_measures_equal(Measure* m1, Measure* m2, PredSet preds,
 
     root_measures.erase(root_m2);
 
-    Predicate* merger_pred = dd.insert_new_predicate(std::make_unique<Predicate>(
-        pred_t::EQ, std::vector<Node*>{root_m1, root_m2}, 
+    Predicate* merger_pred = dd.insert_new_predicate(
+        pred_t::EQ, {root_m1, root_m2}, 
         std::move(preds), pred_src::GGRAPH
-    ));
+    );
 
     root_m1->merge(root_m2, merger_pred);
+    record_change(root_m1);
     tr->record_merge(root_m1, root_m2);
 }
 
@@ -1299,6 +1435,7 @@ bool GeometricGraph::set_measure_val(Measure* m, Frac f, Predicate* pred, DDEngi
     }
 
     m->val = f;
+    record_change(m);
     tr->set_measure_val(m, f, pred);
 
     if (root_measure_vals.contains(f)) {
@@ -1314,12 +1451,15 @@ bool GeometricGraph::set_measure_val(Measure* m, Frac f, Predicate* pred, DDEngi
 
 Ratio* GeometricGraph::__add_new_ratio(Length* l1, Length* l2, Predicate* base_pred) {
     std::string ratio_id = "r_" + l1->name + "_" + l2->name;
-    if (Utils::isinmap(ratio_id, ratios)) {
+    if (ratios.contains(ratio_id)) {
         throw GGraphInternalError("Error: Ratio with id " + ratio_id + " already exists in GeometricGraph.");
     }
-    ratios[ratio_id] = std::make_unique<Ratio>(ratio_id, l1, l2);
-    Ratio* r = ratios[ratio_id].get();
+    Ratio* r = ratios.emplace(ratio_id, l1, l2);
+    // The sets of ratios on a length are ordered by `id`, so `r` may only join them now
+    l1->on_ratio_1.insert(r);
+    l2->on_ratio_2.insert(r);
     root_ratios.insert(r);
+    record_change(r);
 
     tr->make_ratio_with_lengths(r, l1, l2);
 
@@ -1425,12 +1565,13 @@ void GeometricGraph::merge_ratios(Ratio* dest, Ratio* src, PredSet preds, DDEngi
 
     root_ratios.erase(root_src);
 
-    Predicate* merger_pred = dd.insert_new_predicate(std::make_unique<Predicate>(
-        pred_t::EQ, std::vector<Node*>{root_dest, root_src}, 
+    Predicate* merger_pred = dd.insert_new_predicate(
+        pred_t::EQ, {root_dest, root_src}, 
         std::move(preds), pred_src::GGRAPH
-    ));
+    );
 
     auto fracs = root_dest->merge(root_src, merger_pred);
+    record_change(root_dest);
     tr->record_merge(root_dest, root_src);
 
     if (fracs) {
@@ -1446,13 +1587,13 @@ void GeometricGraph::merge_ratios(Ratio* dest, Ratio* src, PredSet preds, DDEngi
 
 Fraction* GeometricGraph::__add_new_fraction(Ratio* r, Predicate* base_pred) {
     std::string fraction_id = "f_" + r->name;
-    if (Utils::isinmap(fraction_id, fractions)) {
+    if (fractions.contains(fraction_id)) {
         throw GGraphInternalError("Error: Fraction with id " + fraction_id + " already exists in GeometricGraph.");
     }
-    fractions[fraction_id] = std::make_unique<Fraction>(fraction_id);
-    Fraction* f = fractions[fraction_id].get();
+    Fraction* f = fractions.emplace(fraction_id);
     r->set_fraction(f);
     root_fractions.insert(f);
+    record_change(f);
 
     // For traceback
     tr->set_fraction_of(f, r, base_pred);
@@ -1480,12 +1621,13 @@ void GeometricGraph::set_fractions_equal(Fraction* f1, Fraction* f2, PredSet pre
 
     root_fractions.erase(root_f2);
 
-    Predicate* merger_pred = dd.insert_predicate(std::make_unique<Predicate>(
-        pred_t::EQ, std::vector<Node*>{root_f1, root_f2}, 
+    Predicate* merger_pred = dd.insert_predicate(
+        pred_t::EQ, {root_f1, root_f2}, 
         std::move(preds), pred_src::GGRAPH
-    ));
+    );
 
     root_f1->merge(root_f2, merger_pred);
+    record_change(root_f1);
 }
 
 bool GeometricGraph::set_fraction_val(Fraction* f, Frac val, Predicate* pred, DDEngine& dd) {
@@ -1498,6 +1640,7 @@ bool GeometricGraph::set_fraction_val(Fraction* f, Frac val, Predicate* pred, DD
     }
 
     f->val = val;
+    record_change(f);
     tr->set_fraction_val(f, val, pred);
 
     if (root_fraction_vals.contains(val)) {
@@ -1519,11 +1662,10 @@ Triangle* GeometricGraph::__add_new_triangle(Point* p1, Point* p2, Point* p3, Pr
     if (point_nums[p2] > point_nums[p3]) std::swap(p2, p3);
     if (point_nums[p1] > point_nums[p2]) std::swap(p1, p2);
     std::string triangle_id = "t_" + p1->name + "_" + p2->name + "_" + p3->name;
-    if (Utils::isinmap(triangle_id, triangles)) {
+    if (triangles.contains(triangle_id)) {
         throw GGraphInternalError("Error: Triangle with id " + triangle_id + " already exists in GeometricGraph.");
     }
-    triangles[triangle_id] = std::make_unique<Triangle>(triangle_id, p1, p2, p3, base_pred);
-    Triangle* t = triangles[triangle_id].get();
+    Triangle* t = triangles.emplace(triangle_id, p1, p2, p3, base_pred);
     root_triangles.insert(t);
     p1->set_this_vertex_of(t);
     p2->set_this_vertex_of(t);
@@ -1551,11 +1693,10 @@ Triangle* GeometricGraph::__try_get_triangle(Point* p1, Point* p2, Point* p3) {
 
 Dimension* GeometricGraph::__add_new_dimension(Triangle* t, Predicate* base_pred) {
     std::string dimension_id = "dim_" + t->name;
-    if (Utils::isinmap(dimension_id, dimensions)) {
+    if (dimensions.contains(dimension_id)) {
         throw GGraphInternalError("Error: Dimension with id " + dimension_id + " already exists in GeometricGraph.");
     }
-    dimensions[dimension_id] = std::make_unique<Dimension>(dimension_id, t);
-    Dimension* dim = dimensions[dimension_id].get();
+    Dimension* dim = dimensions.emplace(dimension_id, t);
     root_dimensions.insert(dim);
 
     t->set_dimension(dim);
@@ -1589,11 +1730,10 @@ Dimension* GeometricGraph::get_or_add_dimension(Triangle* t, DDEngine& dd) {
 
 Shape* GeometricGraph::__add_new_shape(Dimension* dim, Predicate* base_pred) {
     std::string shape_id = "shp_" + dim->name;
-    if (Utils::isinmap(shape_id, shapes)) {
+    if (shapes.contains(shape_id)) {
         throw GGraphInternalError("Error: Shape with id " + shape_id + " already exists in GeometricGraph.");
     }
-    shapes[shape_id] = std::make_unique<Shape>(shape_id);
-    Shape* shape = shapes[shape_id].get();
+    Shape* shape = shapes.emplace(shape_id);
     root_shapes.insert(shape);
 
     dim->set_shape(shape);
@@ -1651,19 +1791,21 @@ void GeometricGraph::merge_triangles(Triangle* dest, Triangle* src, PredSet pred
 
     root_triangles.erase(root_src);
 
-    Predicate* merger_pred = dd.insert_new_predicate(std::make_unique<Predicate>(
-        pred_t::EQ, std::vector<Node*>{root_dest, root_src}, 
+    Predicate* merger_pred = dd.insert_new_predicate(
+        pred_t::EQ, {root_dest, root_src}, 
         std::move(preds), pred_src::GGRAPH
-    ));
+    );
 
     root_dest->merge(root_src, merger_pred);
 }
 
 bool GeometricGraph::check_same_orientation(Point* p1, Point* p2, Point* p3, Point* p4, Point* p5, Point* p6) {
-    return Cartesian::same_orientation(
-        point_nums[p1], point_nums[p2], point_nums[p3],
-        point_nums[p4], point_nums[p5], point_nums[p6]
-    );
+    auto orientation = [this](Point* a, Point* b, Point* c) {
+        return point_triples.get(a, b, c, PointTripleTable::ORIENTATION, [&]() {
+            return Cartesian::orientation_of(point_nums.at(a), point_nums.at(b), point_nums.at(c));
+        });
+    };
+    return !(orientation(p1, p2, p3) ^ orientation(p4, p5, p6));
 }
 
 void GeometricGraph::set_triangle_isosceles(Point* p1, Point* p2, Point* p3) {
@@ -1722,10 +1864,10 @@ void GeometricGraph::set_triangles_congruent(Triangle* t1, Triangle* t2, std::ar
     Dimension* dim1 = get_or_add_dimension(t1, dd);
     Dimension* dim2 = get_or_add_dimension(t2, dd);
 
-    Predicate* pred = dd.insert_new_predicate(std::make_unique<Predicate>(
-        pred_t::EQ, std::vector<Node*>{t1, t2}, 
+    Predicate* pred = dd.insert_new_predicate(
+        pred_t::EQ, {t1, t2}, 
         std::move(all_preds), pred_src::GGRAPH
-    ));
+    );
 
     set_triangles_congruent(dim1, dim2, perm, pred, dd);
 }
@@ -1823,10 +1965,10 @@ void GeometricGraph::set_triangles_similar(Triangle* t1, Triangle* t2, std::arra
 
             shp2->perm_all_triangles(perm);
 
-            Predicate* pred = dd.insert_new_predicate(std::make_unique<Predicate>(
-                pred_t::EQ, std::vector<Node*>{shp1, shp2}, 
+            Predicate* pred = dd.insert_new_predicate(
+                pred_t::EQ, {shp1, shp2}, 
                 std::move(all_preds), pred_src::GGRAPH
-            ));
+            );
 
             auto [isosceles_mask, updated] = Dimension::or_isosceles_masks(dim1->isosceles_mask, dim2->isosceles_mask);
             PredSet isosceles_preds_1(pred);
@@ -2077,63 +2219,65 @@ bool GeometricGraph::check_constratio(Ratio* r, Frac f) { return Ratio::is_equal
 
 
 bool GeometricGraph::num_check_coll(Point* p1, Point* p2, Point* p3) {
-    return Cartesian::is_coll(point_nums[p1], point_nums[p2], point_nums[p3]);
+    return point_triples.get(p1, p2, p3, PointTripleTable::COLL, [&]() {
+        return Cartesian::is_coll(point_nums.at(p1), point_nums.at(p2), point_nums.at(p3));
+    });
 }
 bool GeometricGraph::num_check_cyclic(Point* p1, Point* p2, Point* p3, Point* p4) {
-    return CartesianCircle(point_nums[p1], point_nums[p2], point_nums[p3]).contains(point_nums[p4]);
+    return CartesianCircle(point_nums.at(p1), point_nums.at(p2), point_nums.at(p3)).contains(point_nums.at(p4));
 }
 bool GeometricGraph::num_check_para(Point* p1, Point* p2, Point* p3, Point* p4) {
-    return Cartesian::is_para(point_nums[p1], point_nums[p2], point_nums[p3], point_nums[p4]);
+    return Cartesian::is_para(point_nums.at(p1), point_nums.at(p2), point_nums.at(p3), point_nums.at(p4));
 }
 bool GeometricGraph::num_check_perp(Point* p1, Point* p2, Point* p3, Point* p4) {
-    return Cartesian::is_perp(point_nums[p1], point_nums[p2], point_nums[p3], point_nums[p4]);
+    return Cartesian::is_perp(point_nums.at(p1), point_nums.at(p2), point_nums.at(p3), point_nums.at(p4));
 }
 bool GeometricGraph::num_check_cong(Point* p1, Point* p2, Point* p3, Point* p4) {
-    return Cartesian::is_cong(point_nums[p1], point_nums[p2], point_nums[p3], point_nums[p4]);
+    return Cartesian::is_cong(point_nums.at(p1), point_nums.at(p2), point_nums.at(p3), point_nums.at(p4));
 }
 bool GeometricGraph::num_check_midp(Point* m, Point* p1, Point* p2) {
-    return Cartesian::is_midp(point_nums[m], point_nums[p1], point_nums[p2]);
+    return Cartesian::is_midp(point_nums.at(m), point_nums.at(p1), point_nums.at(p2));
 }
 bool GeometricGraph::num_check_circle(Point* c, Point* p1, Point* p2, Point* p3) {
-    return Cartesian::is_circle(point_nums[c], point_nums[p1], point_nums[p2], point_nums[p3]);
+    return Cartesian::is_circle(point_nums.at(c), point_nums.at(p1), point_nums.at(p2), point_nums.at(p3));
 }
 bool GeometricGraph::num_check_eqangle(Point* p1, Point* p2, Point* p3, Point* p4,
                                       Point* p5, Point* p6, Point* p7, Point* p8) {
     return Cartesian::is_eqangle(
-        point_nums[p1], point_nums[p2], point_nums[p3], point_nums[p4],
-        point_nums[p5], point_nums[p6], point_nums[p7], point_nums[p8]
+        point_nums.at(p1), point_nums.at(p2), point_nums.at(p3), point_nums.at(p4),
+        point_nums.at(p5), point_nums.at(p6), point_nums.at(p7), point_nums.at(p8)
     );
 }
 bool GeometricGraph::num_check_eqratio(Point* p1, Point* p2, Point* p3, Point* p4,
                                       Point* p5, Point* p6, Point* p7, Point* p8) {
     return Cartesian::is_eqratio(
-        point_nums[p1], point_nums[p2], point_nums[p3], point_nums[p4],
-        point_nums[p5], point_nums[p6], point_nums[p7], point_nums[p8]
+        point_nums.at(p1), point_nums.at(p2), point_nums.at(p3), point_nums.at(p4),
+        point_nums.at(p5), point_nums.at(p6), point_nums.at(p7), point_nums.at(p8)
     );
 }
 bool GeometricGraph::num_check_contri(Point* p1, Point* p2, Point* p3, Point* p4, Point* p5, Point* p6) {
     return (
-        Cartesian::is_cong(point_nums[p1], point_nums[p2], point_nums[p4], point_nums[p5])
-        && Cartesian::is_cong(point_nums[p2], point_nums[p3], point_nums[p5], point_nums[p6])
-        && Cartesian::is_cong(point_nums[p3], point_nums[p1], point_nums[p6], point_nums[p4])
+        Cartesian::is_cong(point_nums.at(p1), point_nums.at(p2), point_nums.at(p4), point_nums.at(p5))
+        && Cartesian::is_cong(point_nums.at(p2), point_nums.at(p3), point_nums.at(p5), point_nums.at(p6))
+        && Cartesian::is_cong(point_nums.at(p3), point_nums.at(p1), point_nums.at(p6), point_nums.at(p4))
     );
 }
 bool GeometricGraph::num_check_simtri(Point* p1, Point* p2, Point* p3, Point* p4, Point* p5, Point* p6) {
     return (
-        Cartesian::is_eqratio(point_nums[p1], point_nums[p2], point_nums[p2], point_nums[p3],
-                                 point_nums[p4], point_nums[p5], point_nums[p5], point_nums[p6])
-        && Cartesian::is_eqratio(point_nums[p2], point_nums[p3], point_nums[p3], point_nums[p1],
-                                 point_nums[p5], point_nums[p6], point_nums[p6], point_nums[p4])
-        && Cartesian::is_eqratio(point_nums[p3], point_nums[p1], point_nums[p1], point_nums[p2],
-                                 point_nums[p6], point_nums[p4], point_nums[p4], point_nums[p5])                                                  
+        Cartesian::is_eqratio(point_nums.at(p1), point_nums.at(p2), point_nums.at(p2), point_nums.at(p3),
+                                 point_nums.at(p4), point_nums.at(p5), point_nums.at(p5), point_nums.at(p6))
+        && Cartesian::is_eqratio(point_nums.at(p2), point_nums.at(p3), point_nums.at(p3), point_nums.at(p1),
+                                 point_nums.at(p5), point_nums.at(p6), point_nums.at(p6), point_nums.at(p4))
+        && Cartesian::is_eqratio(point_nums.at(p3), point_nums.at(p1), point_nums.at(p1), point_nums.at(p2),
+                                 point_nums.at(p6), point_nums.at(p4), point_nums.at(p4), point_nums.at(p5))                                                  
     );
 }
 
 
-bool GeometricGraph::num_check_diff(std::set<Point*> &pts) {
+bool GeometricGraph::num_check_diff(std::set<Point*, NodeOrder> &pts) {
     std::set<int> s;
     for (Point* p : pts) {
-        if (point_to_num_eq_set.contains(p) && !s.insert(point_to_num_eq_set[p]).second) {
+        if (point_to_num_eq_set.contains(p) && !s.insert(point_to_num_eq_set.at(p)).second) {
             return false;
         }
     }
@@ -2141,17 +2285,11 @@ bool GeometricGraph::num_check_diff(std::set<Point*> &pts) {
 }
 
 
-bool GeometricGraph::num_check_ncoll(std::set<Point*> &pts) {
+bool GeometricGraph::num_check_ncoll(std::set<Point*, NodeOrder> &pts) {
     for (auto it1 = pts.begin(); it1 != pts.end(); ++it1) {
         for (auto it2 = std::next(it1); it2 != pts.end(); ++it2) {
             for (auto it3 = std::next(it2); it3 != pts.end(); ++it3) {
-                if (Cartesian::is_coll(
-                    point_nums[*it1],
-                    point_nums[*it2],
-                    point_nums[*it3]
-                )) {
-                    return false;
-                }
+                if (num_check_coll(*it1, *it2, *it3)) return false;
             }
         }
     }
@@ -2160,22 +2298,24 @@ bool GeometricGraph::num_check_ncoll(std::set<Point*> &pts) {
 
 
 bool GeometricGraph::num_check_npara(Point* p1, Point* p2, Point* p3, Point* p4) {
-    return !Cartesian::is_para(point_nums[p1], point_nums[p2], point_nums[p3], point_nums[p4]);
+    return !Cartesian::is_para(point_nums.at(p1), point_nums.at(p2), point_nums.at(p3), point_nums.at(p4));
 }
 
 
 bool GeometricGraph::num_check_nperp(Point* p1, Point* p2, Point* p3, Point* p4) {
-    return !Cartesian::is_perp(point_nums[p1], point_nums[p2], point_nums[p3], point_nums[p4]);
+    return !Cartesian::is_perp(point_nums.at(p1), point_nums.at(p2), point_nums.at(p3), point_nums.at(p4));
 }
 
 
 bool GeometricGraph::num_check_ncong(Point* p1, Point* p2, Point* p3, Point* p4) {
-    return !Cartesian::is_cong(point_nums[p1], point_nums[p2], point_nums[p3], point_nums[p4]);
+    return !Cartesian::is_cong(point_nums.at(p1), point_nums.at(p2), point_nums.at(p3), point_nums.at(p4));
 }
 
 
 bool GeometricGraph::num_check_sameside(Point* a, Point* x, Point* y) {
-    return Cartesian::acute_angle(point_nums[a], point_nums[x], point_nums[y]);
+    return point_triples.get(a, x, y, PointTripleTable::ACUTE, [&]() {
+        return Cartesian::acute_angle(point_nums.at(a), point_nums.at(x), point_nums.at(y));
+    });
 }
 
 
@@ -2485,6 +2625,8 @@ bool GeometricGraph::__make_cyclic(Point* rp1, Point* rp2, Point* rp3, Point* rp
         }
         if (src_circles.empty()) {
             tp->set_this_on(c);
+            __index_circle(c, tp);
+            record_change(c);
             tr->set_point_on(tp, c, pred);
         } else {
             merge_circles(c234, std::move(src_circles), dd, ar);
@@ -2501,6 +2643,8 @@ bool GeometricGraph::__make_cyclic(Point* rp1, Point* rp2, Point* rp3, Point* rp
         }
         if (src_circles.empty()) {
             tp->set_this_on(c);
+            __index_circle(c, tp);
+            record_change(c);
             tr->set_point_on(tp, c, pred);
         } else {
             merge_circles(c341, std::move(src_circles), dd, ar);
@@ -2513,10 +2657,14 @@ bool GeometricGraph::__make_cyclic(Point* rp1, Point* rp2, Point* rp3, Point* rp
             merge_circles(c412, std::move(src_circles), dd, ar);
         } else {
             tp->set_this_on(c);
+            __index_circle(c, tp);
+            record_change(c);
             tr->set_point_on(tp, c, pred);
         }
     } else {
         tp->set_this_on(c);
+        __index_circle(c, tp);
+        record_change(c);
         tr->set_point_on(tp, c, pred);
     }
 
@@ -2580,12 +2728,14 @@ bool GeometricGraph::__make_para(Point* p1, Point* p2, Point* p3, Point* p4,
             PredSet preds = preds_12 + pred;
 
             d12->add_line(p3p4);
+            record_change(d12);
             tr->set_direction_of(d12, p3p4, preds);
         }
 
     } else {
         Direction* d34 = get_or_add_direction(p3p4, dd);
         d34->add_line(p1p2);
+        record_change(d34);
 
         PredSet preds = preds_34 + pred;
 
@@ -2607,10 +2757,7 @@ bool GeometricGraph::make_ar_para(Predicate* pred, DDEngine& dd) {
 
     auto [p1, p2] = get_points_on_line(l1);
     auto [p3, p4] = get_points_on_line(l2);
-    pred->args[0] = p1;
-    pred->args[1] = p2;
-    pred->args.emplace_back(p3);
-    pred->args.emplace_back(p4);
+    pred->rewrite_args({p1, p2, p3, p4});
 
     set_directions_para(d1, d2, pred, dd);
     tr->record_merge(d1, d2);
@@ -2664,10 +2811,7 @@ bool GeometricGraph::make_ar_perp(Predicate* pred, DDEngine& dd) {
 
     auto [p1, p2] = get_points_on_line(l1);
     auto [p3, p4] = get_points_on_line(l2);
-    pred->args[0] = p1;
-    pred->args[1] = p2;
-    pred->args.emplace_back(p3);
-    pred->args.emplace_back(p4);
+    pred->rewrite_args({p1, p2, p3, p4});
 
     set_directions_perp(d1, d2, pred, dd);
     tr->set_directions_perp(d1, d2, pred);
@@ -2705,6 +2849,7 @@ bool GeometricGraph::__make_cong(Point* p1, Point* p2, Point* p3, Point* p4,
         ar.add_cong_ratio(l1, l2, pred);
     } else {
         s2->set_length(l1);
+        record_change(l1);
         tr->set_length_of(l1, s2, preds);
     }
     ar.add_cong_disp(s1, s2, pred);
@@ -2725,10 +2870,7 @@ bool GeometricGraph::make_ar_cong(Predicate* pred, DDEngine &dd) {
             auto [p1, p2] = s1->endpoints;
             auto [p3, p4] = s2->endpoints;
 
-            pred->args[0] = p1;
-            pred->args[1] = p2;
-            pred->args.emplace_back(p3);
-            pred->args.emplace_back(p4);
+            pred->rewrite_args({p1, p2, p3, p4});
 
             set_lengths_cong(l1, l2, pred, dd);
             tr->record_merge(l1, l2);
@@ -2797,6 +2939,7 @@ bool GeometricGraph::__make_eqangle(Point* p1, Point* p2, Point* p3, Point* p4,
             preds += tr->why_measure_of(m1, a1);
 
             a2->set_measure(m1);
+            record_change(m1);
             tr->set_measure_of(m1, a2, preds);
         }
     } else if (a2->has_measure()) {
@@ -2805,10 +2948,12 @@ bool GeometricGraph::__make_eqangle(Point* p1, Point* p2, Point* p3, Point* p4,
         preds += tr->why_measure_of(m2, a2);
 
         a1->set_measure(m2);
+        record_change(m2);
         tr->set_measure_of(m2, a1, preds);
     } else {
         Measure* m = get_or_add_measure(a1, dd);
         a2->set_measure(m);
+        record_change(m);
         tr->set_measure_of(m, a2, pred);
     }
     
@@ -2858,14 +3003,7 @@ bool GeometricGraph::make_ar_eqangle(Predicate* pred, DDEngine& dd) {
     auto [p5, p6] = get_points_on_line(l3);
     auto [p7, p8] = get_points_on_line(l4);
 
-    pred->args[0] = p1;
-    pred->args[1] = p2;
-    pred->args[2] = p3;
-    pred->args[3] = p4;
-    pred->args.emplace_back(p5);
-    pred->args.emplace_back(p6);
-    pred->args.emplace_back(p7);
-    pred->args.emplace_back(p8);
+    pred->rewrite_args({p1, p2, p3, p4, p5, p6, p7, p8});
 
     PredSet preds(pred);
 
@@ -2884,6 +3022,7 @@ bool GeometricGraph::make_ar_eqangle(Predicate* pred, DDEngine& dd) {
             preds += tr->why_measure_of(m1, a1);
 
             a2->set_measure(m1);
+            record_change(m1);
             tr->set_measure_of(m1, a2, preds);
         }
     } else if (a2->has_measure()) {
@@ -2892,10 +3031,12 @@ bool GeometricGraph::make_ar_eqangle(Predicate* pred, DDEngine& dd) {
         preds += tr->why_measure_of(m2, a2);
 
         a1->set_measure(m2);
+        record_change(m2);
         tr->set_measure_of(m2, a1, preds);
     } else {
         Measure* m = get_or_add_measure(a1, dd);
         a2->set_measure(m);
+        record_change(m);
         tr->set_measure_of(m, a2, preds);
     }
     return true;
@@ -2942,6 +3083,7 @@ bool GeometricGraph::__make_eqratio(Point* p1, Point* p2, Point* p3, Point* p4,
             preds += tr->why_fraction_of(f1, r1);
 
             r2->set_fraction(f1);
+            record_change(f1);
             tr->set_fraction_of(f1, r2, preds);
         }
     } else if (r2->has_fraction()) {
@@ -2950,10 +3092,12 @@ bool GeometricGraph::__make_eqratio(Point* p1, Point* p2, Point* p3, Point* p4,
         preds += tr->why_fraction_of(f2, r2);
 
         r1->set_fraction(f2);
+        record_change(f2);
         tr->set_fraction_of(f2, r1, preds);
     } else {
         Fraction* f = get_or_add_fraction(r1, dd);
         r2->set_fraction(f);
+        record_change(f);
         tr->set_fraction_of(f, r2, pred);
     }
 
@@ -2995,14 +3139,7 @@ bool GeometricGraph::make_ar_eqratio(Predicate* pred, DDEngine &dd) {
     auto [p5, p6] = s3->endpoints;
     auto [p7, p8] = s4->endpoints;
 
-    pred->args[0] = p1;
-    pred->args[1] = p2;
-    pred->args[2] = p3;
-    pred->args[3] = p4;
-    pred->args.emplace_back(p5);
-    pred->args.emplace_back(p6);
-    pred->args.emplace_back(p7);
-    pred->args.emplace_back(p8);
+    pred->rewrite_args({p1, p2, p3, p4, p5, p6, p7, p8});
 
     PredSet preds(pred);
 
@@ -3021,6 +3158,7 @@ bool GeometricGraph::make_ar_eqratio(Predicate* pred, DDEngine &dd) {
             preds += tr->why_fraction_of(f1, r1);
 
             r2->set_fraction(f1);
+            record_change(f1);
             tr->set_fraction_of(f1, r2, preds);
         }
     } else if (r2->has_fraction()) {
@@ -3029,10 +3167,12 @@ bool GeometricGraph::make_ar_eqratio(Predicate* pred, DDEngine &dd) {
         preds += tr->why_fraction_of(f2, r2);
 
         r1->set_fraction(f2);
+        record_change(f2);
         tr->set_fraction_of(f2, r1, preds);
     } else {
         Fraction* f = get_or_add_fraction(r1, dd);
         r2->set_fraction(f);
+        record_change(f);
         tr->set_fraction_of(f, r2, pred);
     }
     return true;
@@ -3233,10 +3373,7 @@ bool GeometricGraph::make_ar_constangle(Predicate* pred, DDEngine& dd) {
     auto [p1, p2] = get_points_on_line(l1);
     auto [p3, p4] = get_points_on_line(l2);
 
-    pred->args[0] = p1;
-    pred->args[1] = p2;
-    pred->args.emplace_back(p3);
-    pred->args.emplace_back(p4);
+    pred->rewrite_args({p1, p2, p3, p4});
 
     if (!set_measure_val(m, f, pred, dd)) return false;
     return true;
@@ -3280,10 +3417,7 @@ bool GeometricGraph::make_ar_constratio(Predicate* pred, DDEngine &dd) {
     auto [p1, p2] = s1->endpoints;
     auto [p3, p4] = s2->endpoints;
 
-    pred->args[0] = p1;
-    pred->args[1] = p2;
-    pred->args.emplace_back(p3);
-    pred->args.emplace_back(p4);
+    pred->rewrite_args({p1, p2, p3, p4});
 
     Ratio* r = get_or_add_ratio(l1, l2, dd);
     Fraction* fr = get_or_add_fraction(r, dd);
@@ -3305,7 +3439,7 @@ int GeometricGraph::synthesise_preds(DDEngine &dd, AREngine &ar) {
         bool res = false;
         Predicate* pred = recent_preds_gen();
 
-        pred->level = level;
+        pred->set_level(level);
         pred->why.set_level(level - 1);
 
         // if (!num_check(pred)) {
@@ -3360,6 +3494,7 @@ int GeometricGraph::synthesise_preds(DDEngine &dd, AREngine &ar) {
             num += 1;
             LOG("Synthesised predicate: " << pred->to_string_with_whys());
         }
+        if (poll_conclusion()) break;
     }
     level += 2;
 
@@ -3373,7 +3508,7 @@ int GeometricGraph::synthesise_ar_preds(DDEngine &dd) {
         bool res = false;
         Predicate* pred = recent_preds_gen();
 
-        pred->level = level;
+        pred->set_level(level);
 
         assert(pred->why.size() > 0);
         assert(!(pred->why.contains(pred)));
@@ -3413,6 +3548,7 @@ int GeometricGraph::synthesise_ar_preds(DDEngine &dd) {
             num += 1;
             LOG("Synthesised AR predicate: " << pred->to_string_with_whys());
         }
+        if (poll_conclusion()) break;
     }
     level += 2;
 
@@ -3422,6 +3558,172 @@ int GeometricGraph::synthesise_ar_preds(DDEngine &dd) {
 
 
 
+void GeometricGraph::collect_changes() {
+    delta_lines.clear();
+    delta_circles.clear();
+    delta_directions.clear();
+    delta_lengths.clear();
+    delta_measures.clear();
+    delta_fractions.clear();
+
+    for (Point* p : changed_points) {
+        Point* rp = NodeUtils::get_root(p);
+        for (Line* l : rp->on_root_line) changed_lines.insert(l);
+        for (Circle* c : rp->on_root_circle) changed_circles.insert(c);
+        for (Circle* c : rp->center_of_root_circle) changed_circles.insert(c);
+        for (Segment* s : rp->endpoint_of_root_segment) {
+            if (s->has_length()) changed_lengths.insert(s->get_length());
+        }
+    }
+    for (Line* l : changed_lines) {
+        Line* rl = NodeUtils::get_root(l);
+        delta_lines.insert(rl);
+        if (rl->has_direction()) changed_directions.insert(rl->get_direction());
+    }
+    for (Circle* c : changed_circles) {
+        delta_circles.insert(NodeUtils::get_root(c));
+    }
+    for (Direction* d : changed_directions) {
+        Direction* rd = NodeUtils::get_root(d);
+        delta_directions.insert(rd);
+        for (Angle* a : rd->on_angles_1) changed_angles.insert(a);
+        for (Angle* a : rd->on_angles_2) changed_angles.insert(a);
+        // Perpendicular pairs are enumerated from either side, so both directions have to be marked
+        if (rd->has_perp()) delta_directions.insert(rd->get_perp());
+    }
+    for (Angle* a : changed_angles) {
+        Angle* ra = NodeUtils::get_root(a);
+        if (ra->has_measure()) changed_measures.insert(ra->get_measure());
+    }
+    for (Measure* m : changed_measures) {
+        delta_measures.insert(NodeUtils::get_root(m));
+    }
+    for (Length* l : changed_lengths) {
+        Length* rl = NodeUtils::get_root(l);
+        delta_lengths.insert(rl);
+        for (Ratio* r : rl->on_ratio_1) changed_ratios.insert(r);
+        for (Ratio* r : rl->on_ratio_2) changed_ratios.insert(r);
+    }
+    for (Ratio* r : changed_ratios) {
+        Ratio* rr = NodeUtils::get_root(r);
+        if (rr->has_fraction()) changed_fractions.insert(rr->get_fraction());
+    }
+    for (Fraction* f : changed_fractions) {
+        delta_fractions.insert(NodeUtils::get_root(f));
+    }
+
+    changed_points.clear();
+    changed_lines.clear();
+    changed_circles.clear();
+    changed_directions.clear();
+    changed_lengths.clear();
+    changed_angles.clear();
+    changed_ratios.clear();
+    changed_measures.clear();
+    changed_fractions.clear();
+
+    delta_kinds = 0;
+    if (!delta_lines.empty()) delta_kinds |= DELTA_LINES;
+    if (!delta_circles.empty()) delta_kinds |= DELTA_CIRCLES;
+    if (!delta_directions.empty()) delta_kinds |= DELTA_DIRECTIONS;
+    if (!delta_lengths.empty()) delta_kinds |= DELTA_LENGTHS;
+    if (!delta_measures.empty()) delta_kinds |= DELTA_MEASURES;
+    if (!delta_fractions.empty()) delta_kinds |= DELTA_FRACTIONS;
+}
+
+
+
+
+void GeometricGraph::compress_roots() {
+    auto compress = [](auto& arena) {
+        for (std::uint32_t i = 0; i < arena.size(); i++) NodeUtils::get_root(arena[i]);
+    };
+    compress(points);
+    compress(lines);
+    compress(circles);
+    compress(segments);
+    compress(triangles);
+    compress(directions);
+    compress(lengths);
+    compress(angles);
+    compress(ratios);
+    compress(dimensions);
+    compress(measures);
+    compress(fractions);
+    compress(shapes);
+
+    for (std::uint32_t i = 0; i < lines.size(); i++) {
+        if (lines[i]->__has_direction()) lines[i]->__get_direction();
+    }
+    for (std::uint32_t i = 0; i < circles.size(); i++) {
+        if (circles[i]->__has_center()) circles[i]->__get_center();
+    }
+    for (std::uint32_t i = 0; i < segments.size(); i++) {
+        if (segments[i]->__has_length()) segments[i]->__get_length();
+        segments[i]->__get_line();
+    }
+    for (std::uint32_t i = 0; i < triangles.size(); i++) {
+        if (triangles[i]->has_dimension()) triangles[i]->get_dimension();
+    }
+    for (std::uint32_t i = 0; i < angles.size(); i++) {
+        if (angles[i]->__has_measure()) angles[i]->__get_measure();
+    }
+    for (std::uint32_t i = 0; i < ratios.size(); i++) {
+        if (ratios[i]->__has_fraction()) ratios[i]->__get_fraction();
+    }
+    for (std::uint32_t i = 0; i < dimensions.size(); i++) {
+        if (dimensions[i]->shape) dimensions[i]->__get_shape();
+    }
+}
+
+
+
+
+void GeometricGraph::watch_conclusion(PredicateTemplate* goal) {
+    watched_goal = goal;
+    switch (goal->name) {
+        case pred_t::COLL:
+            watched_kinds = CHANGE_POINTS | CHANGE_LINES;
+            break;
+        case pred_t::CYCLIC:
+        case pred_t::CIRCLE:
+            watched_kinds = CHANGE_POINTS | CHANGE_CIRCLES;
+            break;
+        case pred_t::PARA:
+        case pred_t::PERP:
+            watched_kinds = CHANGE_LINES | CHANGE_DIRECTIONS;
+            break;
+        case pred_t::CONG:
+            watched_kinds = CHANGE_POINTS | CHANGE_LENGTHS;
+            break;
+        case pred_t::EQANGLE:
+        case pred_t::CONSTANGLE:
+            watched_kinds = CHANGE_LINES | CHANGE_DIRECTIONS | CHANGE_ANGLES | CHANGE_MEASURES;
+            break;
+        case pred_t::EQRATIO:
+        case pred_t::CONSTRATIO:
+            watched_kinds = CHANGE_POINTS | CHANGE_LENGTHS | CHANGE_RATIOS | CHANGE_FRACTIONS;
+            break;
+        case pred_t::MIDP:
+            watched_kinds = CHANGE_POINTS | CHANGE_LINES | CHANGE_LENGTHS;
+            break;
+        default:
+            // Triangles are not change-tracked, so subscribe to everything
+            watched_kinds = ~std::uint32_t(0);
+            break;
+    }
+    watch_fired = true;
+    goal_reached = false;
+}
+
+bool GeometricGraph::poll_conclusion() {
+    if (watch_fired && !goal_reached) {
+        watch_fired = false;
+        goal_reached = check(watched_goal);
+    }
+    return goal_reached;
+}
+
 int GeometricGraph::count_nodes() {
     return (
         points.size() + lines.size() + circles.size() + segments.size() + triangles.size() +
@@ -3437,6 +3739,9 @@ int GeometricGraph::count_nodes() {
 void GeometricGraph::reset_problem() {
 
     points.clear();
+    points_by_name.clear();
+    line_index.clear();
+    circle_index.clear();
     lines.clear();
     circles.clear();
     segments.clear();
@@ -3473,7 +3778,31 @@ void GeometricGraph::reset_problem() {
     root_fraction_vals.clear();
     root_shapes.clear();
 
+    all_changed = true;
+    changed_points.clear();
+    changed_lines.clear();
+    changed_circles.clear();
+    changed_directions.clear();
+    changed_lengths.clear();
+    changed_angles.clear();
+    changed_ratios.clear();
+    changed_measures.clear();
+    changed_fractions.clear();
+    delta_lines.clear();
+    delta_circles.clear();
+    delta_directions.clear();
+    delta_lengths.clear();
+    delta_measures.clear();
+    delta_fractions.clear();
+    delta_kinds = 0;
+
+    watched_goal = nullptr;
+    watched_kinds = 0;
+    watch_fired = false;
+    goal_reached = false;
+
     point_nums.clear();
+    point_triples.clear();
     line_nums.clear();
     circle_nums.clear();
     direction_gradients.clear();
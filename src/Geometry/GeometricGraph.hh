@@ -5,6 +5,10 @@
 #include <ostream>
 #include <iostream>
 #include <set>
+#include <unordered_map>
+#include <cstdint>
+#include <optional>
+#include <atomic>
 
 #include "DD/Predicate.hh"
 #include "Object.hh"
@@ -17,11 +21,89 @@
 #include "Numerics/Cartesian.hh"
 #include "Numerics/NumEngine.hh"
 
-template<typename T>    // "alias declaration"
-using uptrmap = std::map<std::string, std::unique_ptr<T>>;
+/* Numeric coordinates of points, stored as a structure of arrays indexed by `Point::id`. Lookups are O(1),
+and the `Cartesian::batch_` kernels can sweep `xs`, `ys` over all points at once. Slots of points without
+coordinates hold `nullptr` in `pts` (and zero coordinates).
+The points are also indexed by a uniform grid of cells at least `TOL` wide, so that the points equal to a
+coordinate (see `CartesianPoint::operator==`) are found among the 3x3 cells around it, in O(1) expected
+time. */
+class PointNumerics {
+    using Cell = std::pair<std::int64_t, std::int64_t>;
+    struct CellHash {
+        std::size_t operator()(const Cell& c) const;
+    };
+    std::vector<Point*> pts;
+    std::unordered_map<Cell, std::vector<Point*>, CellHash> grid;
+    /* Points whose coordinates have no grid cell, which `find_equal()` scans linearly. */
+    std::vector<Point*> off_grid;
+
+    /* The grid cell of `cp`, or `std::nullopt` if a coordinate is not finite or too large for the grid. */
+    static std::optional<Cell> __cell(const CartesianPoint& cp);
 
-template<typename T>
-using ptrset = std::set<T*>;
+public:
+    std::vector<double> xs;
+    std::vector<double> ys;
+
+    /* Sets the coordinates of `p`, moving it to its new grid cell if it already had coordinates. */
+    void set(Point* p, CartesianPoint cp);
+    bool contains(Point* p) const { return p->id < pts.size() && pts[p->id] == p; }
+    CartesianPoint at(Point* p) const {
+        if (!contains(p)) throw GGraphInternalError("Point " + p->name + " has no numeric coordinates");
+        return CartesianPoint(xs[p->id], ys[p->id]);
+    }
+    CartesianPoint operator[](Point* p) const { return at(p); }
+    /* The points whose coordinates are equal to `cp`, in `id` order. */
+    std::vector<Point*> find_equal(const CartesianPoint& cp) const;
+
+    /* The point in slot `i`, or `nullptr`. */
+    Point* point(std::size_t i) const { return pts[i]; }
+    /* The number of slots, i.e. one more than the largest `id` with coordinates. */
+    std::size_t size() const { return pts.size(); }
+    void clear() {
+        pts.clear();
+        grid.clear();
+        off_grid.clear();
+        xs.clear();
+        ys.clear();
+    }
+};
+
+/* Memo of numeric checks on ordered triples of points, which never change once the points have their
+coordinates. Indexed densely by the `id`s of the three points; each entry holds, for every kind of
+check, a bit recording whether it is known and a bit holding its result. Entries are filled lazily
+with atomic bit sets, so the threads matching theorems may share the table. Only sized for up to
+`MAX_POINTS` points: checks on points outside the table are computed directly. */
+class PointTripleTable {
+    std::size_t n = 0;
+    std::unique_ptr<std::atomic<std::uint8_t>[]> entries;
+
+public:
+    const static std::size_t MAX_POINTS = 128;
+    // Kinds of checks. The result of kind `k` is stored in bit `k << 4`.
+    const static std::uint8_t ORIENTATION = 1;
+    const static std::uint8_t COLL = 2;
+    const static std::uint8_t ACUTE = 4;
+
+    /* Empties the table and sizes it for points with ids below `num_points`. */
+    void reset(std::size_t num_points) {
+        n = (num_points <= MAX_POINTS) ? num_points : 0;
+        entries.reset(n ? new std::atomic<std::uint8_t>[n * n * n]{} : nullptr);
+    }
+    void clear() { reset(0); }
+
+    /* The result of the check of kind `kind` on the triple `(a, b, c)`, computed by `compute()` if it is
+    not known yet. */
+    template <typename F>
+    bool get(Point* a, Point* b, Point* c, std::uint8_t kind, F&& compute) {
+        if (a->id >= n || b->id >= n || c->id >= n) return compute();
+        std::atomic<std::uint8_t>& entry = entries[(a->id * n + b->id) * n + c->id];
+        std::uint8_t e = entry.load(std::memory_order_relaxed);
+        if (e & kind) return e & (kind << 4);
+        bool res = compute();
+        entry.fetch_or(kind | (res ? kind << 4 : 0), std::memory_order_relaxed);
+        return res;
+    }
+};
 
 class GeometricGraph {
 
@@ -33,58 +115,135 @@ public:
     an existing one */
     bool new_object = false;
 
-    // Geometric objects
+    // Geometric objects, stored in per-type arenas and numbered with dense ids
+
+    NodeArena<Point> points;
+    NodeArena<Line> lines;
+    NodeArena<Circle> circles;
+    NodeArena<Segment> segments;
+    NodeArena<Triangle> triangles;
 
-    uptrmap<Point> points;
-    uptrmap<Line> lines;
-    uptrmap<Circle> circles;
-    uptrmap<Segment> segments;
-    uptrmap<Triangle> triangles;
+    NodeArena<Direction> directions;
+    NodeArena<Length> lengths;
 
-    uptrmap<Direction> directions;
-    uptrmap<Length> lengths;
+    NodeArena<Angle> angles;
+    NodeArena<Ratio> ratios;
+    NodeArena<Dimension> dimensions;
 
-    uptrmap<Angle> angles;
-    uptrmap<Ratio> ratios;
-    uptrmap<Dimension> dimensions;
+    NodeArena<Measure> measures;
+    NodeArena<Fraction> fractions;
+    NodeArena<Shape> shapes;
 
-    uptrmap<Measure> measures;
-    uptrmap<Fraction> fractions;
-    uptrmap<Shape> shapes;
+    /* Points by name. Only points are looked up by name (when parsing problems); all other nodes are
+    only ever reached through the graph. */
+    std::map<std::string, Point*> points_by_name;
 
-    // Root geometric objects
+    // Root geometric objects, as id-indexed sets
 
-    ptrset<Point> root_points;
-    ptrset<Line> root_lines;
-    ptrset<Circle> root_circles;
-    ptrset<Segment> root_segments;
-    ptrset<Triangle> root_triangles;
+    NodeSet<Point> root_points;
+    NodeSet<Line> root_lines;
+    NodeSet<Circle> root_circles;
+    NodeSet<Segment> root_segments;
+    NodeSet<Triangle> root_triangles;
 
-    ptrset<Direction> root_directions;
-    ptrset<Length> root_lengths;
+    NodeSet<Direction> root_directions;
+    NodeSet<Length> root_lengths;
 
-    ptrset<Angle> root_angles;
-    ptrset<Ratio> root_ratios;
-    ptrset<Dimension> root_dimensions;
+    NodeSet<Angle> root_angles;
+    NodeSet<Ratio> root_ratios;
+    NodeSet<Dimension> root_dimensions;
 
-    ptrset<Measure> root_measures;
-    ptrset<Fraction> root_fractions;
-    ptrset<Shape> root_shapes;
+    NodeSet<Measure> root_measures;
+    NodeSet<Fraction> root_fractions;
+    NodeSet<Shape> root_shapes;
+
+    /* Lookup indices from pairs (resp. triples) of root points to the root line (resp. circle) through
+    them, keyed by `NodeUtils::id_key()`. Entries are added whenever points join a line or circle, and are
+    never removed: the stored object may since have been merged, so lookups take its root, and entries
+    keyed by points which are no longer roots are simply never looked up again. */
+    std::unordered_map<std::uint64_t, Line*> line_index;
+    std::unordered_map<NodeUtils::IdTriple, Circle*, NodeUtils::IdTripleHash> circle_index;
 
     // Valuations of Value2 nodes
 
     std::map<Frac, Measure*> root_measure_vals;
     std::map<Frac, Fraction*> root_fraction_vals;
 
+    // Change tracking (for semi-naive matching in the DDEngine)
+
+    /* Flag storing whether every node should be treated as changed in the next DD pass, e.g. in the
+    first pass after a problem is loaded. */
+    bool all_changed = true;
+
+    /* Nodes created, merged into, or otherwise modified since the last call to `collect_changes()`.
+    These need not be root nodes. */
+    NodeSet<Point> changed_points;
+    NodeSet<Line> changed_lines;
+    NodeSet<Circle> changed_circles;
+    NodeSet<Direction> changed_directions;
+    NodeSet<Length> changed_lengths;
+    NodeSet<Angle> changed_angles;
+    NodeSet<Ratio> changed_ratios;
+    NodeSet<Measure> changed_measures;
+    NodeSet<Fraction> changed_fractions;
+
+    /* Root nodes whose incident structure changed since the previous DD pass. Populated by
+    `collect_changes()`. */
+    NodeSet<Line> delta_lines;
+    NodeSet<Circle> delta_circles;
+    NodeSet<Direction> delta_directions;
+    NodeSet<Length> delta_lengths;
+    NodeSet<Measure> delta_measures;
+    NodeSet<Fraction> delta_fractions;
+
+    /* Bit flags for the kinds of nodes with a `delta_` set. */
+    enum delta_kind : std::uint32_t {
+        DELTA_LINES = 1 << 0,
+        DELTA_CIRCLES = 1 << 1,
+        DELTA_DIRECTIONS = 1 << 2,
+        DELTA_LENGTHS = 1 << 3,
+        DELTA_MEASURES = 1 << 4,
+        DELTA_FRACTIONS = 1 << 5
+    };
+    /* Change log of the current DD pass: the bitmask of `delta_kind`s whose `delta_` set is non-empty.
+    Populated by `collect_changes()`. */
+    std::uint32_t delta_kinds = 0;
+
+    // Conclusion watcher
+
+    /* Bit flags for the kinds of nodes passed to `record_change()`. */
+    enum change_kind : std::uint32_t {
+        CHANGE_POINTS = 1 << 0,
+        CHANGE_LINES = 1 << 1,
+        CHANGE_CIRCLES = 1 << 2,
+        CHANGE_DIRECTIONS = 1 << 3,
+        CHANGE_LENGTHS = 1 << 4,
+        CHANGE_ANGLES = 1 << 5,
+        CHANGE_RATIOS = 1 << 6,
+        CHANGE_MEASURES = 1 << 7,
+        CHANGE_FRACTIONS = 1 << 8
+    };
+    /* The goal watched by `poll_conclusion()`, and the bitmask of `change_kind`s it subscribes to. */
+    PredicateTemplate* watched_goal = nullptr;
+    std::uint32_t watched_kinds = 0;
+    /* Flag storing whether a change the goal subscribes to was recorded since the goal was last checked. */
+    bool watch_fired = false;
+    /* Flag storing whether the watched goal holds. Once set, the solve loop stops at the next poll. */
+    bool goal_reached = false;
+
     // Numerics
 
-    std::map<Point*, CartesianPoint> point_nums;
-    std::map<Line*, CartesianLine> line_nums;
-    std::map<Circle*, CartesianCircle> circle_nums;
-    std::map<Direction*, double> direction_gradients;
+    PointNumerics point_nums;
+    /* Orientations, collinearity and acute angles of point triples, filled in by `check_same_orientation()`,
+    `num_check_coll()`, `num_check_ncoll()` and `num_check_sameside()`. Sized once all points have their
+    coordinates (see `initialise_point_numerics()`), and emptied whenever a point is moved. */
+    PointTripleTable point_triples;
+    std::map<Line*, CartesianLine, NodeOrder> line_nums;
+    std::map<Circle*, CartesianCircle, NodeOrder> circle_nums;
+    std::map<Direction*, double, NodeOrder> direction_gradients;
 
-    std::vector<std::set<Point*>> num_eq_point_sets;
-    std::map<Point*, int> point_to_num_eq_set;
+    std::vector<std::set<Point*, NodeOrder>> num_eq_point_sets;
+    std::map<Point*, int, NodeOrder> point_to_num_eq_set;
 
     // Traceback
 
@@ -93,11 +252,12 @@ public:
 
     /* Populate newly resolved CartesianPoints from the NumEngine into our numeric maps */
     void initialise_point_numerics(NumEngine &nm);
-    /* Manually set a point's numeric coordinates.
-    This is a placeholder function and should only be used for debugging.*/
+    /* Manually set a point's numeric coordinates. Used for points created during the search (adhoc
+    circle centers, see `get_or_add_circle_center()`) and for debugging. */
     void __set_point_numeric(Point* p, CartesianPoint cp);
     /* Find another point, if it exists, whose Cartesian numeric is equal to that of `new_p`.
     If such a point exists, places them in the same set in `num_eq_point_sets`.
+    Candidates are looked up in the grid of `point_nums`, so this takes O(1) expected time.
     Note: Assumes that `point_nums[new_p]` has already been populated. */
     void __identify_num_eq_points(Point* new_p);
     
@@ -144,10 +304,16 @@ public:
     Populates the `points` of the new line with `p1` and `p2`, and adds the new line to their `on_line`. 
     Note: `p1` and `p2` should be root points. */
     Line* __add_new_line(Point* p1, Point* p2, Predicate* base_pred);
-    /* Gets the root line connecting the (existing) points `p1` and `p2`. 
-    Returns `nullptr` if no such line exists yet. 
-    Note: `p1` and `p2` must be root points (so that their `on_line` attribute is nonempty). */
+    /* Gets the root line connecting the (existing) points `p1` and `p2`, in O(1) via `line_index`.
+    Returns `nullptr` if no such line exists yet. */
     Line* __try_get_line(Point* p1, Point* p2);
+    /* Adds every pair of points on the line `l` to `line_index`. */
+    void __index_line(Line* l);
+    /* Adds every pair of the point `p` on the line `l` and another point on `l` to `line_index`. */
+    void __index_line(Line* l, Point* p);
+    /* Adds the pairs of points which become collinear when the root line `src` is merged into the root
+    line `dest` to `line_index`. Must be called before `dest->merge(src)`. */
+    void __index_line_merger(Line* dest, Line* src);
     /* Gets the root line connecting the roots of the points `p1` and `p2`, or creates a new line connecting
     them if none exists. */
     Line* get_or_add_line(Point* p1, Point* p2, DDEngine &dd);
@@ -219,10 +385,17 @@ public:
     /* Add a circle with center `c`. */
     Circle* __add_new_circle(Point* c, Predicate* base_pred);
 
-    /* Gets the root circumcircle of the three points `p1`, `p2`, `p3`.
+    /* Gets the root circumcircle of the three points `p1`, `p2`, `p3`, in O(1) via `circle_index`.
     Returns `nullptr` if no such circle exists.
     Note: `p1`, `p2`, `p3` must be root points. */
     Circle* __try_get_circle(Point* p1, Point* p2, Point* p3);
+    /* Adds every triple of points on the circle `c` to `circle_index`. */
+    void __index_circle(Circle* c);
+    /* Adds every triple of the point `p` on the circle `c` and two other points on `c` to `circle_index`. */
+    void __index_circle(Circle* c, Point* p);
+    /* Adds the triples of points which become concyclic when the root circle `src` is merged into the root
+    circle `dest` to `circle_index`. Must be called before `dest->merge(src)`. */
+    void __index_circle_merger(Circle* dest, Circle* src);
     /* Gets the root circle centered at `c` passing through `p1`.
     Returns `nullptr` if no such circle exists.
     Note: `p1` must be a root point. */
@@ -253,7 +426,7 @@ public:
     not yet exist. */
     Circle* get_or_add_circle(Point* c, Point* p1, DDEngine& dd);
     /* Gets the center of a given circle `c`, creating a new point as this center if it does not yet
-    exist. */
+    exist. The new point takes the numeric center of `c` as its coordinates. */
     Point* get_or_add_circle_center(Circle* c, DDEngine& dd);
     
     /* Sets the root of `cp` as the center of the root of circle `c`.
@@ -639,15 +812,15 @@ public:
         std::set<int> s;
         return ((point_to_num_eq_set.contains(pts) ? s.insert(point_to_num_eq_set[pts]) : true) && ...);
     }
-    bool num_check_diff(std::set<Point*> &pts);
+    bool num_check_diff(std::set<Point*, NodeOrder> &pts);
 
     template<typename... T>
     requires (std::same_as<T, Point> && ...)
     bool num_check_ncoll(T*... pts) {
-        std::set<Point*> p{pts...};
+        std::set<Point*, NodeOrder> p{pts...};
         num_check_ncoll(p);
     }
-    bool num_check_ncoll(std::set<Point*> &pts);
+    bool num_check_ncoll(std::set<Point*, NodeOrder> &pts);
 
     bool num_check_npara(Point* p1, Point* p2, Point* p3, Point* p4);
     bool num_check_nperp(Point* p1, Point* p2, Point* p3, Point* p4);
@@ -739,6 +912,37 @@ public:
     int synthesise_ar_preds(DDEngine &dd);
 
 
+    /* Records that a node was created, merged into, or had objects attached to it.
+    Also notifies the conclusion watcher if the goal subscribes to the kind of node. */
+    void record_change(Point* p) { changed_points.insert(p); __notify(CHANGE_POINTS); }
+    void record_change(Line* l) { changed_lines.insert(l); __notify(CHANGE_LINES); }
+    void record_change(Circle* c) { changed_circles.insert(c); __notify(CHANGE_CIRCLES); }
+    void record_change(Direction* d) { changed_directions.insert(d); __notify(CHANGE_DIRECTIONS); }
+    void record_change(Length* l) { changed_lengths.insert(l); __notify(CHANGE_LENGTHS); }
+    void record_change(Angle* a) { changed_angles.insert(a); __notify(CHANGE_ANGLES); }
+    void record_change(Ratio* r) { changed_ratios.insert(r); __notify(CHANGE_RATIOS); }
+    void record_change(Measure* m) { changed_measures.insert(m); __notify(CHANGE_MEASURES); }
+    void record_change(Fraction* f) { changed_fractions.insert(f); __notify(CHANGE_FRACTIONS); }
+    void __notify(change_kind kind) { if (watched_kinds & kind) watch_fired = true; }
+    /* Converts the recorded changes into the `delta_` sets of root nodes, then clears the `changed_` sets.
+    A change to a node is propagated upwards to every node whose matches it may affect: points to their
+    lines, circles and segment lengths, lines to their directions, directions to their perpendiculars and
+    angles, angles to their measures, lengths to their ratios, and ratios to their fractions. */
+    void collect_changes();
+    /* Points the `root` pointer of every node directly at its root, and refreshes every cached pointer to
+    a root node (e.g. the `direction` of a line). Until the graph is next modified, reading it performs no
+    writes, so it may be read by several threads at once (see `DDEngine::search()`). */
+    void compress_roots();
+
+    /* Subscribes the conclusion watcher to the kinds of nodes whose changes can make `goal` hold: for
+    example, the lines and directions of a `para` goal. The goal is checked on the next poll. */
+    void watch_conclusion(PredicateTemplate* goal);
+    /* Checks the watched goal if a change it subscribes to was recorded since the last poll, and returns
+    `goal_reached`. `synthesise_preds()` and `synthesise_ar_preds()` poll after every predicate, and stop
+    as soon as the goal holds. */
+    bool poll_conclusion();
+
+
 
 
     int count_nodes();
@@ -3,8 +3,15 @@
 #include <string>
 #include <concepts>
 #include <vector>
+#include <deque>
+#include <unordered_map>
 #include <map>
 #include <array>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <set>
 
 #include "Common/Constants.hh"
 #include "Common/Generator.hh"
@@ -18,29 +25,176 @@ class Node {
 
 public:
     std::string name;
+    /* Dense index of this node among the nodes of its type, assigned by its `NodeArena`. */
+    std::uint32_t id = 0;
 
+    /* Explanation tree: every merged node hangs under the node it was merged into, with the reason for
+    the merge. Traceback walks this tree (see `TracebackUtils`), so it is never rebalanced. */
     Node* parent = nullptr;
-    Node* root = this;
     std::vector<Node*> children;
     Predicate* parent_why;
 
+    /* The root of the explanation tree, as last looked up by `NodeUtils::get_root()`. It is correct as
+    long as it is still a root itself, since sets of merged nodes only ever grow. */
+    Node* root = this;
+
+    /* Union-find forest over the same sets, for root lookups when `root` is out of date. It is united by
+    rank and path-compressed independently of the explanation tree. `rank` bounds the height of the
+    union-find tree under this node, and `leader` is the explanation root of the set of a union-find
+    root. */
+    Node* uf = this;
+    Node* leader = this;
+    std::uint8_t rank = 0;
+
     Node(std::string name) : name(name), root(this) {}
 
-    constexpr bool is_root() { return (root == this); }
+    constexpr bool is_root() { return (parent == nullptr); }
+
+    /* Returns the union-find root of the set of `n`, compressing the path to it. */
+    static constexpr Node* find(Node* n) {
+        Node* r = n;
+        while (r->uf != r) r = r->uf;
+        while (n->uf != r) {
+            Node* next = n->uf;
+            n->uf = r;
+            n = next;
+        }
+        return r;
+    }
 
     /* Merge `other` into `this` node.
-    This function maps the `parent`, `root` and `children` attributes. */
+    This function maps the `parent`, `root` and `children` attributes, and unites the union-find sets of
+    both nodes by rank. The explanation root of `this` stays the root of the merged set. */
     constexpr void merge(Node* other, Predicate* pred) {
         if (this == other) return;
         other->parent = this;
         other->parent_why = pred;
         other->root = this;
         children.emplace_back(other);
+
+        Node* a = find(this);
+        Node* b = find(other);
+        Node* l = a->leader;
+        if (a != b) {
+            if (a->rank < b->rank) std::swap(a, b);
+            b->uf = a;
+            if (a->rank == b->rank) a->rank++;
+        }
+        a->leader = l;
     }
 
     constexpr std::string to_string() { return name; }
 };
 
+/* Owns all nodes of type `T` in a GeometricGraph.
+Nodes are constructed in place in chunked storage (a `std::deque`), so their addresses are stable,
+nodes created together sit next to each other in memory, and there is no separate heap allocation
+per node. Each node is numbered with a dense `id` in creation order, and can also be looked up by name.
+Nodes are only ever released all at once, by `clear()`. */
+template <std::derived_from<Node> T>
+class NodeArena {
+    std::deque<T> nodes;
+    std::unordered_map<std::string, std::uint32_t> ids_by_name;
+public:
+    /* Constructs a node from the arguments of a `T` constructor. The name of the node must not be taken
+    yet (see `contains()`). */
+    template <typename... Args>
+    T* emplace(Args&&... args) {
+        T* n = &nodes.emplace_back(std::forward<Args>(args)...);
+        n->id = static_cast<std::uint32_t>(nodes.size() - 1);
+        ids_by_name.emplace(n->name, n->id);
+        return n;
+    }
+
+    T* operator[](std::uint32_t id) { return &nodes[id]; }
+    /* Returns the node with the given name, or nullptr if there is none. */
+    T* find(const std::string& name) {
+        auto it = ids_by_name.find(name);
+        return (it == ids_by_name.end()) ? nullptr : &nodes[it->second];
+    }
+    bool contains(const std::string& name) const { return ids_by_name.contains(name); }
+    std::size_t size() const { return nodes.size(); }
+    void clear() {
+        nodes.clear();
+        ids_by_name.clear();
+    }
+};
+
+/* Set of nodes of a single type, stored as a vector of slots indexed by node `id`.
+Membership tests, insertions and erasures are O(1), and iteration visits nodes in `id` (i.e. creation)
+order, which unlike pointer order does not depend on where the nodes happen to be allocated.
+Nodes may be inserted or erased while the set is being iterated over. */
+template <std::derived_from<Node> T>
+class NodeSet {
+    std::vector<T*> slots;
+    std::size_t count = 0;
+
+public:
+    /* Iterators hold a slot index rather than a pointer, so they survive the slots being resized.
+    The end iterator is a sentinel, so nodes inserted during iteration with a larger `id` are visited. */
+    class iterator {
+        const NodeSet* s = nullptr;
+        std::size_t i = END;
+        constexpr void skip() {
+            while (i < s->slots.size() && !s->slots[i]) ++i;
+            if (i >= s->slots.size()) i = END;
+        }
+    public:
+        static constexpr std::size_t END = static_cast<std::size_t>(-1);
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T* const*;
+        using reference = T*;
+        iterator() = default;
+        iterator(const NodeSet* s, std::size_t i) : s(s), i(i) { if (i != END) skip(); }
+        T* operator*() const { return s->slots[i]; }
+        iterator& operator++() { ++i; skip(); return *this; }
+        iterator operator++(int) { iterator it = *this; ++(*this); return it; }
+        bool operator==(const iterator& other) const { return i == other.i; }
+    };
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, iterator::END); }
+
+    bool contains(T* n) const { return n->id < slots.size() && slots[n->id] == n; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    bool insert(T* n) {
+        if (n->id >= slots.size()) slots.resize(n->id + 1, nullptr);
+        if (slots[n->id]) return false;
+        slots[n->id] = n;
+        count++;
+        return true;
+    }
+    std::size_t erase(T* n) {
+        if (!contains(n)) return 0;
+        slots[n->id] = nullptr;
+        count--;
+        return 1;
+    }
+    void clear() {
+        slots.clear();
+        count = 0;
+    }
+};
+
+/* Orders nodes by `id`, i.e. in creation order, so that ordered containers keyed by nodes of a single type
+iterate in the same order on every run. Nodes outside of any arena share the same `id`, and fall back
+to address order; a null node comes first. Pairs of nodes are ordered lexicographically. */
+struct NodeOrder {
+    bool operator()(const Node* a, const Node* b) const {
+        if (!a || !b || a->id == b->id) return std::less<const Node*>()(a, b);
+        return a->id < b->id;
+    }
+    template <std::derived_from<Node> T, std::derived_from<Node> U>
+    bool operator()(const std::pair<T*, U*> &a, const std::pair<T*, U*> &b) const {
+        if (a.first != b.first) return (*this)(a.first, b.first);
+        return (*this)(a.second, b.second);
+    }
+};
+
 namespace NodeUtils {
 
     template <std::derived_from<Node> Key>
@@ -48,14 +202,18 @@ namespace NodeUtils {
         return static_cast<Key*>(n->parent);
     }
 
-    /* Returns the root of any `Node` object. 
-    This function has the secondary purpose of lazily updating the `root` pointer for every node it passes through to the correct root. */
+    /* Returns the root of any `Node` object, in O(1) if its cached `root` is still a root, and through
+    the union-find forest otherwise.
+    This function has the secondary purpose of lazily updating the `root` pointer of `n` to the correct root.
+    Nodes whose `root` pointer is already correct are not written to (see `GeometricGraph::compress_roots()`). */
     template <std::derived_from<Node> Key>
     constexpr Key* get_root(Key* n) {
-        if (!n->is_root()) {
-            n->root = get_root(n->root);
+        Node* r = n->root;
+        if (!r->is_root()) {
+            r = Node::find(n)->leader;
+            n->root = r;
         }
-        return static_cast<Key*>(n->root);
+        return static_cast<Key*>(r);
     }
 
     /* Returns the roots of all elements in an array of `Node` objects. */
@@ -114,7 +272,7 @@ namespace NodeUtils {
     Returns all distinct roots of all keys in the map. */
     template <std::derived_from<Node> Key, Constants::IsStdMap Map>
     Generator<Key*> all_roots_dedup(Map& m) {
-        std::set<Node*> yielded;
+        std::set<Node*, NodeOrder> yielded;
         for (const auto& [key, _] : m) {
             Node* r = get_root(key);
             if (!(yielded.contains(r))) {
@@ -155,7 +313,7 @@ namespace NodeUtils {
     /* Take in as input a set of pointers to `Value`s.
     Returns all pairs of values in the set. */
     template <std::derived_from<Node> Value>
-    Generator<std::pair<Value*, Value*>> all_pairs(std::set<Value*>& s) {
+    Generator<std::pair<Value*, Value*>> all_pairs(std::set<Value*, NodeOrder>& s) {
         for (auto it = s.begin(); it != s.end(); ++it) {
             for (auto jt = std::next(it); jt != s.end(); ++jt) {
                 co_yield {(*it), (*jt)};
@@ -167,7 +325,7 @@ namespace NodeUtils {
     /* Take in as input a set of pointers to `Value`s.
     Returns all ordered pairs of values in the set. */
     template <std::derived_from<Node> Value>
-    Generator<std::pair<Value*, Value*>> all_pairs_ordered(std::set<Value*>& s) {
+    Generator<std::pair<Value*, Value*>> all_pairs_ordered(std::set<Value*, NodeOrder>& s) {
         for (auto it = s.begin(); it != s.end(); ++it) {
             for (auto jt = std::next(it); jt != s.end(); ++jt) {
                 co_yield {(*it), (*jt)};
@@ -229,7 +387,7 @@ namespace NodeUtils {
     /* Take in as input a set of pointers to `Value`s.
     Returns all triples of values in the set. */
     template <std::derived_from<Node> Value>
-    Generator<std::tuple<Value*, Value*, Value*>> all_triples(std::set<Value*>& s) {
+    Generator<std::tuple<Value*, Value*, Value*>> all_triples(std::set<Value*, NodeOrder>& s) {
         for (auto it = s.begin(); it != s.end(); ++it) {
             for (auto jt = std::next(it); jt != s.end(); ++jt) {
                 for (auto kt = std::next(jt); kt != s.end(); ++kt) {
@@ -243,7 +401,7 @@ namespace NodeUtils {
     /* Takes in as input a set of pointers to `Value`s.
     Returns all ordered triples of values in the set. */
     template <std::derived_from<Node> Value>
-    Generator<std::tuple<Value*, Value*, Value*>> all_triples_ordered(std::set<Value*>& s) {
+    Generator<std::tuple<Value*, Value*, Value*>> all_triples_ordered(std::set<Value*, NodeOrder>& s) {
         auto unordered_gen = all_triples<Value>(s);
         while (unordered_gen) {
             auto [k1, k2, k3] = unordered_gen();
@@ -318,7 +476,7 @@ namespace NodeUtils {
     /* Take in as input a set of pointers to `Value`s.
     Returns all quadruplets of values in the set. */
     template<std::derived_from<Node> Value>
-    Generator<std::tuple<Value*, Value*, Value*, Value*>> all_quads(std::set<Value*>& s) {
+    Generator<std::tuple<Value*, Value*, Value*, Value*>> all_quads(std::set<Value*, NodeOrder>& s) {
         for (auto it = s.begin(); it != s.end(); ++it) {
             for (auto jt = std::next(it); jt != s.end(); ++jt) {
                 for (auto kt = std::next(jt); kt != s.end(); ++kt) {
@@ -334,7 +492,7 @@ namespace NodeUtils {
     /* Takes in as input a set of pointers to `Value`s.
     Returns all ordered quadruples of values in the set. */
     template<std::derived_from<Node> Value>
-    Generator<std::tuple<Value*, Value*, Value*, Value*>> all_quads_ordered(std::set<Value*>& s) {
+    Generator<std::tuple<Value*, Value*, Value*, Value*>> all_quads_ordered(std::set<Value*, NodeOrder>& s) {
         auto unordered_gen = all_quads(s);
         while (unordered_gen) {
             auto [k1, k2, k3, k4] = unordered_gen();
@@ -369,6 +527,70 @@ namespace NodeUtils {
         co_return;
     }
 
+    /* Range over all ordered `K`-tuples of distinct values in a set, in the same order as `all_pairs_ordered()`,
+    `all_triples_ordered()` and `all_quads_ordered()`: each `K`-subset in turn, followed by its permutations.
+    Unlike those generators, iterating over it allocates nothing, so it is used in the DDEngine's matchers. */
+    template <std::derived_from<Node> Value, int K>
+    class OrderedTuples {
+        const std::set<Value*, NodeOrder>& s;
+    public:
+        class iterator {
+            const std::set<Value*, NodeOrder>* s = nullptr;
+            std::array<typename std::set<Value*, NodeOrder>::const_iterator, K> its;
+            std::array<int, K> perm;
+            bool done = true;
+
+            /* Moves position `i` onwards to the next `K`-subset, returning false if there is none. */
+            bool advance(int i) {
+                for (; i >= 0; i--) {
+                    auto it = std::next(its[i]);
+                    int j = i;
+                    for (; j < K && it != s->end(); j++, ++it) its[j] = it;
+                    if (j == K) return true;
+                }
+                return false;
+            }
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = std::array<Value*, K>;
+            using difference_type = std::ptrdiff_t;
+            iterator() = default;
+            explicit iterator(const std::set<Value*, NodeOrder>* s) : s(s) {
+                if (s->size() < K) return;
+                auto it = s->begin();
+                for (int j = 0; j < K; j++, ++it) {
+                    its[j] = it;
+                    perm[j] = j;
+                }
+                done = false;
+            }
+            value_type operator*() const {
+                value_type res;
+                for (int j = 0; j < K; j++) res[j] = *its[perm[j]];
+                return res;
+            }
+            iterator& operator++() {
+                // std::next_permutation resets `perm` to the identity once all permutations are exhausted
+                if (!std::next_permutation(perm.begin(), perm.end())) {
+                    done = !advance(K - 1);
+                }
+                return *this;
+            }
+            bool operator==(const iterator& other) const { return done && other.done; }
+        };
+
+        OrderedTuples(const std::set<Value*, NodeOrder>& s) : s(s) {}
+        iterator begin() const { return iterator(&s); }
+        iterator end() const { return iterator(); }
+    };
+
+    template <std::derived_from<Node> Value>
+    OrderedTuples<Value, 2> ordered_pairs(const std::set<Value*, NodeOrder>& s) { return OrderedTuples<Value, 2>(s); }
+    template <std::derived_from<Node> Value>
+    OrderedTuples<Value, 3> ordered_triples(const std::set<Value*, NodeOrder>& s) { return OrderedTuples<Value, 3>(s); }
+    template <std::derived_from<Node> Value>
+    OrderedTuples<Value, 4> ordered_quads(const std::set<Value*, NodeOrder>& s) { return OrderedTuples<Value, 4>(s); }
+
     template<std::derived_from<Node> T>
     Generator<T*> all_children(T* node) {
         auto it = node->children.begin();
@@ -383,8 +605,8 @@ namespace NodeUtils {
         }
     }
 
-    template<std::derived_from<Node> T>
-    void all_children(T* node, std::set<T*> &s) {
+    template<std::derived_from<Node> T, typename Compare>
+    void all_children(T* node, std::set<T*, Compare> &s) {
         s.insert(node);
         auto it = node->children.begin();
         while (it != node->children.end()) {
@@ -394,4 +616,27 @@ namespace NodeUtils {
         }
     }
 
+    /* Key of an unordered pair of nodes, built from their `id`s. */
+    constexpr std::uint64_t id_key(const Node* a, const Node* b) {
+        std::uint64_t i = a->id, j = b->id;
+        if (i > j) std::swap(i, j);
+        return (i << 32) | j;
+    }
+
+    /* Key of an unordered triple of nodes, built from their sorted `id`s. */
+    using IdTriple = std::array<std::uint32_t, 3>;
+    constexpr IdTriple id_key(const Node* a, const Node* b, const Node* c) {
+        IdTriple k{a->id, b->id, c->id};
+        if (k[0] > k[1]) std::swap(k[0], k[1]);
+        if (k[1] > k[2]) std::swap(k[1], k[2]);
+        if (k[0] > k[1]) std::swap(k[0], k[1]);
+        return k;
+    }
+    struct IdTripleHash {
+        std::size_t operator()(const IdTriple& k) const {
+            std::uint64_t h = ((static_cast<std::uint64_t>(k[0]) << 32) | k[1]) * 0x9E3779B97F4A7C15ull;
+            return static_cast<std::size_t>(h ^ (h >> 29) ^ k[2]);
+        }
+    };
+
 } // namespace NodeUtils
\ No newline at end of file
@@ -286,7 +286,7 @@ Line::check_incident_lines(Point *p, Point *other_p) {
     of points [q1, q2] (which are numerically equivalent), so both point_to_line[q1] and point_to_line[q2] = l.
     However, because GeometricGraph::merge_lines() is idempotent, so returning {l, l2} twice is no biggie. */
 
-    std::map<Point*, Line*> point_to_line;
+    std::map<Point*, Line*, NodeOrder> point_to_line;
     for (auto it = p->on_root_line.begin(); it != p->on_root_line.end(); ++it) {
         Line* l1 = *it;
         l1->points.erase(other_p);
@@ -318,7 +318,7 @@ Line::check_incident_lines(Point *p, Point *other_p) {
 Generator<std::pair<Line*, std::pair<Point*, Point*>>> 
 Line::check_incident_lines(Line* l, Line* other_l) {
 
-    std::map<Line*, Point*> line_to_point;
+    std::map<Line*, Point*, NodeOrder> line_to_point;
     for (auto it = l->points.begin(); it != l->points.end(); ++it) {
         Point* p1 = *it;
         if (other_l->contains(p1)) continue;
@@ -376,7 +376,7 @@ Point* Circle::get_center() {
 Generator<Circle*> Circle::all_circles_through(Point* p1, Point* p2) {
     p1 = NodeUtils::get_root(p1);
     p2 = NodeUtils::get_root(p2);
-    std::set<Circle*> cs = Utils::intersect_sets(p1->on_root_circle, p2->on_root_circle);
+    std::set<Circle*, NodeOrder> cs = Utils::intersect_sets(p1->on_root_circle, p2->on_root_circle);
     for (Circle* c : cs) {
         co_yield c;
     }
@@ -411,8 +411,8 @@ std::optional<std::pair<Point*, Point*>> Circle::merge(Circle* other, Predicate*
 Generator<std::pair<std::pair<Point*, Point*>, std::pair<Circle*, Circle*>>> 
 Circle::check_incident_circles_by_intersections(Point *p, Point *other_p) {
 
-    std::map<std::pair<Point*, Point*>, Circle*> point_pair_to_circle;
-    std::map<Point*, Circle*> center_to_circle;
+    std::map<std::pair<Point*, Point*>, Circle*, NodeOrder> point_pair_to_circle;
+    std::map<Point*, Circle*, NodeOrder> center_to_circle;
     for (auto it = p->on_root_circle.begin(); it != p->on_root_circle.end(); ++it) {
         Circle* c1 = *it;
         c1->points.erase(other_p);
@@ -457,7 +457,7 @@ Circle::check_incident_circles_by_intersections(Point *p, Point *other_p) {
 Generator<std::pair<Point*, std::pair<Circle*, Circle*>>> 
 Circle::check_incident_circles_by_center(Point *p, Point *other_p) {
 
-    std::map<Point*, Circle*> point_to_circle;
+    std::map<Point*, Circle*, NodeOrder> point_to_circle;
     for (auto it = p->center_of_root_circle.begin(); it != p->center_of_root_circle.end(); ++it) {
         Circle* c1 = *it;
         for (auto p1 : c1->points) {
@@ -484,20 +484,20 @@ Circle::check_incident_circles_by_center(Point *p, Point *other_p) {
 Generator<std::tuple<Circle*, Point*, Point*, Point*, Point*>>
 Circle::check_incident_circles_by_intersections(Circle* c, Circle* other_c) {
 
-    std::set<Circle*> seen;
+    std::set<Circle*, NodeOrder> seen;
     auto c_pp_gen = c->all_point_pairs();
     while (c_pp_gen) {
         auto [p1, p2] = c_pp_gen();
         if (other_c->contains(p1) && other_c->contains(p2)) {
             continue;
         }
-        std::set<Circle*> circs = Utils::intersect_sets(
+        std::set<Circle*, NodeOrder> circs = Utils::intersect_sets(
             p1->on_root_circle, p2->on_root_circle
         );
         for (Circle* c1 : circs) {
             if (c1 != c && c1 != other_c) {
                 seen.insert(c1);
-                std::set<Point*> other_pts = Utils::intersect_sets(
+                std::set<Point*, NodeOrder> other_pts = Utils::intersect_sets(
                     c1->points, other_c->points
                 );
                 if (other_pts.empty()) continue;
@@ -521,12 +521,12 @@ Circle::check_incident_circles_by_intersections(Circle* c, Circle* other_c) {
         if (c->contains(p3) && c->contains(p4)) {
             continue;
         }
-        std::set<Circle*> circs = Utils::intersect_sets(
+        std::set<Circle*, NodeOrder> circs = Utils::intersect_sets(
             p3->on_root_circle, p4->on_root_circle
         );
         for (Circle* c1 : circs) {
             if (c1 != c && c1 != other_c && !seen.contains(c1)) {
-                std::set<Point*> other_pts = Utils::intersect_sets(
+                std::set<Point*, NodeOrder> other_pts = Utils::intersect_sets(
                     c1->points, c->points
                 );
                 if (other_pts.empty()) continue;
@@ -551,7 +551,7 @@ Circle::check_incident_circles_by_center(Circle* c, Circle* other_c) {
     if (c_center) {
         for (Circle* c1 : c_center->center_of_root_circle) {
             if (c1 == c) continue;
-            std::set<Point*> other_pts = Utils::intersect_sets(
+            std::set<Point*, NodeOrder> other_pts = Utils::intersect_sets(
                 c1->points, other_c->points
             );
             if (other_pts.empty()) continue;
@@ -572,7 +572,7 @@ Circle::check_incident_circles_by_center(Circle* c, Circle* other_c) {
     if (other_c_center) {
         for (Circle* c1 : other_c_center->center_of_root_circle) {
             if (c1 == other_c) continue;
-            std::set<Point*> other_pts = Utils::intersect_sets(
+            std::set<Point*, NodeOrder> other_pts = Utils::intersect_sets(
                 c1->points, c->points
             );
             if (other_pts.empty()) continue;
@@ -677,7 +677,7 @@ std::optional<std::pair<Length*, Length*>> Segment::merge(Segment* other, Predic
     return std::nullopt;
 }
 Generator<std::pair<Segment*, Segment*>> Segment::check_incident_segments(Point *p, Point *other_p) {
-    std::map<Point*, Segment*> endpoint_to_segment;
+    std::map<Point*, Segment*, NodeOrder> endpoint_to_segment;
     for (auto it = p->endpoint_of_root_segment.begin(); it != p->endpoint_of_root_segment.end(); ++it) {
         Segment* s = *it;
         Point* p1 = s->other_endpoint(p);
@@ -815,7 +815,7 @@ std::optional<std::pair<Dimension*, Dimension*>> Triangle::merge(Triangle* other
 
 Generator<std::pair<std::pair<Triangle*, Triangle*>, std::array<int, 3>>> 
 Triangle::check_incident_triangles(Point* p, Point* other_p) {
-    std::map<std::pair<Point*, Point*>, Triangle*> vertex_pair_to_triangle;
+    std::map<std::pair<Point*, Point*>, Triangle*, NodeOrder> vertex_pair_to_triangle;
     for (auto it = p->vertex_of_root_triangle.begin(); it != p->vertex_of_root_triangle.end(); ++it) {
         Triangle* t1 = *it;
         std::pair<Point*, Point*> vp1 = t1->other_vertices(p);
@@ -29,7 +29,7 @@ by root objects. */
 class Object : public Node {
 
 public:
-    std::set<Point*> points;
+    std::set<Point*, NodeOrder> points;
     Object(std::string name) : Node(name) {}
     Object(std::string name, std::initializer_list<Point*> pts) : Node(name), points(pts) {}
 
@@ -96,11 +96,11 @@ is handlded by `GeometricGraph::merge_points()`.
 */
 class Point : public Node {
 public:
-    std::set<Line*> on_root_line;
-    std::set<Circle*> on_root_circle;
-    std::set<Circle*> center_of_root_circle;
-    std::set<Segment*> endpoint_of_root_segment;
-    std::set<Triangle*> vertex_of_root_triangle;
+    std::set<Line*, NodeOrder> on_root_line;
+    std::set<Circle*, NodeOrder> on_root_circle;
+    std::set<Circle*, NodeOrder> center_of_root_circle;
+    std::set<Segment*, NodeOrder> endpoint_of_root_segment;
+    std::set<Triangle*, NodeOrder> vertex_of_root_triangle;
 
     Point(std::string name) : Node(name) {}
 
@@ -174,14 +174,14 @@ public:
     /* Merge two `on_` records in some `Point` object. This empties the second record. */
     template <std::derived_from<Object> Key>
     static void merge_dmaps(
-        std::map<Key*, std::map<Point*, PredSet>> &dest, 
-        std::map<Key*, std::map<Point*, PredSet>> &src, 
+        std::map<Key*, std::map<Point*, PredSet, NodeOrder>> &dest, 
+        std::map<Key*, std::map<Point*, PredSet, NodeOrder>> &src, 
         Predicate* pred
     ) {
         for (auto it = src.begin(); it != src.end(); ) {
             Key* obj = it->first;
             if (!dest.contains(obj)) {
-                dest[obj] = std::map<Point*, PredSet>();
+                dest[obj] = std::map<Point*, PredSet, NodeOrder>();
             }
             // Note: dest[obj] and src[obj] should not have any overlapping keys, since the only possible
             // keys are the children of dest and src respectively
@@ -39,10 +39,9 @@ public:
     Direction* direction2;
     Measure* measure = nullptr;
 
-    Angle(std::string name, Direction* d1, Direction* d2) : Object2(name), direction1(d1), direction2(d2) {
-        d1->on_angles_1.insert(this);
-        d2->on_angles_2.insert(this);
-    }
+    /* Note: the angle is only added to the `on_angles_1` and `on_angles_2` sets of its directions by
+    `GeometricGraph::__add_new_angle()`, once its `NodeArena` has assigned its `id`. */
+    Angle(std::string name, Direction* d1, Direction* d2) : Object2(name), direction1(d1), direction2(d2) {}
     
     /* Adds the root node of `m` as the measure of the root node of `this`.
     This updates the `obj2s` and `root_obj2s` of `root_m`, as well as the `measure` of `root_this`.
@@ -90,10 +89,9 @@ public:
     Length* length2;
     Fraction* fraction = nullptr;
 
-    Ratio(std::string name, Length* l1, Length* l2) : Object2(name), length1(l1), length2(l2) {
-        l1->on_ratio_1.insert(this);
-        l2->on_ratio_2.insert(this);
-    }
+    /* Note: the ratio is only added to the `on_ratio_1` and `on_ratio_2` sets of its lengths by
+    `GeometricGraph::__add_new_ratio()`, once its `NodeArena` has assigned its `id`. */
+    Ratio(std::string name, Length* l1, Length* l2) : Object2(name), length1(l1), length2(l2) {}
 
     /* Adds the root node of `f` as the fraction of the root node of `this`.
     This updates the `obj2s` and `root_obj2s` of `root_f`, as well as the `fraction` of `root_this`.
@@ -158,7 +156,7 @@ vertices B and C are equal. If ABC is equilateral, then the false will be {true,
 */
 class Dimension : public Object2 {
 public:
-    std::set<Triangle*> root_triangles;
+    std::set<Triangle*, NodeOrder> root_triangles;
     Shape* shape = nullptr;
     std::array<bool, 3> isosceles_mask = {false, false, false};
 
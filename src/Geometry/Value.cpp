@@ -106,8 +106,8 @@ void Direction::merge(Direction* other, Predicate* pred) {
 }
 
 Generator<std::pair<std::pair<Angle*, Angle*>, bool>> Direction::check_incident_angles(Direction* d, Direction* other_d) {
-    std::map<Direction*, Angle*> dir1_to_angle;
-    std::map<Direction*, Angle*> dir2_to_angle;
+    std::map<Direction*, Angle*, NodeOrder> dir1_to_angle;
+    std::map<Direction*, Angle*, NodeOrder> dir2_to_angle;
     for (Angle* a : d->on_angles_1) {
         Direction* d2 = a->direction2;
         if (d != d2) {
@@ -210,8 +210,8 @@ void Length::merge(Length* other, Predicate* pred) {
 }
 
 Generator<std::pair<std::pair<Ratio*, Ratio*>, bool>> Length::check_incident_ratios(Length* l, Length* other_l) {
-    std::map<Length*, Ratio*> len1_to_ratio;
-    std::map<Length*, Ratio*> len2_to_ratio;
+    std::map<Length*, Ratio*, NodeOrder> len1_to_ratio;
+    std::map<Length*, Ratio*, NodeOrder> len2_to_ratio;
     for (Ratio* r : l->on_ratio_1) {
         Length* l2 = r->length2;
         if (l != l2) {
@@ -256,8 +256,8 @@ Generator<std::pair<std::pair<Ratio*, Ratio*>, bool>> Length::check_incident_rat
 }
 Generator<std::pair<std::array<Point*, 3>, std::pair<Segment*, Segment*>>> 
 Length::check_incident_isosceles_triangles(Length* l, Length* other_l) {
-    std::map<Point*, std::set<Point*>> point_to_cong_endpoints;
-    std::map<std::pair<Point*, Point*>, Segment*> point_pair_to_segments;
+    std::map<Point*, std::set<Point*, NodeOrder>, NodeOrder> point_to_cong_endpoints;
+    std::map<std::pair<Point*, Point*>, Segment*, NodeOrder> point_pair_to_segments;
     for (Segment* s : l->root_objs) {
         Point* p1 = s->endpoints[0];
         Point* p = s->endpoints[1];
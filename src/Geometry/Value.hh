@@ -16,7 +16,7 @@ Only root Value nodes populate their `root_objs` sets. */
 template <std::derived_from<Object> T>
 class Value : public Node {
 public:
-    std::set<T*> root_objs;
+    std::set<T*, NodeOrder> root_objs;
 
     Value(std::string name) : Node(name) {}
 };
@@ -33,8 +33,8 @@ class Direction : public Value<Line> {
 public:
 
     Direction* perp = nullptr;
-    std::set<Angle*> on_angles_1;
-    std::set<Angle*> on_angles_2;
+    std::set<Angle*, NodeOrder> on_angles_1;
+    std::set<Angle*, NodeOrder> on_angles_2;
 
     Direction(std::string name) : Value(name) {}
 
@@ -112,8 +112,8 @@ Every Length stores the set of Ratios for which it is the numerator (length1) an
 respectively. These must always be root Ratios. Only root Lengths maintain these sets. */
 class Length : public Value<Segment> {
 public:
-    std::set<Ratio*> on_ratio_1;
-    std::set<Ratio*> on_ratio_2;
+    std::set<Ratio*, NodeOrder> on_ratio_1;
+    std::set<Ratio*, NodeOrder> on_ratio_2;
     Length(std::string name) : Value(name) {}
 
     /* Associate the segment `s` with the root length of `this`, by adding the former to the `objs` 
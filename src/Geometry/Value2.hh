@@ -25,7 +25,7 @@ by invoking functions. */
 template <std::derived_from<Object2> T>
 class Value2 : public Node {
 public:
-    std::set<T*> root_obj2s;
+    std::set<T*, NodeOrder> root_obj2s;
     Frac val = -1;
 
     Value2(std::string name) : Node(name) {}
@@ -82,7 +82,7 @@ std::string OutputParser::__format_predicate(Predicate* pred) {
 }
 std::string OutputParser::format_predicate_with_why(Predicate* pred, Predicate* base_pred) {
     std::string res;
-    for (Predicate* why : pred->why.preds) {
+    for (Predicate* why : pred->why) {
         if (why == base_pred) continue;
         std::string pred_str = __format_predicate(why);
         if (!pred_str.empty()) {
@@ -137,7 +137,7 @@ void OutputParser::format_failed_numeric_diagram(NumInstance& num_instance) {
 
 
 void OutputParser::format_solution_from_predset(
-    std::map<int, std::set<Predicate*>>& predset, DDEngine& dd
+    std::map<int, std::set<Predicate*, PredicateOrder>>& predset, DDEngine& dd
 ) {
     os << "---------------------------------------" << std::endl;
     Predicate* base_pred = dd.base_pred.get();
@@ -170,6 +170,8 @@ void OutputParser::output_profiler_data(std::string problem_name, Profiler& prof
         profs << "solve_iterations=" << profiler.ggraph_p.iterations << "\n";
         profs << "dd_duration=" << StrUtils::to_string(profiler.dd_p.duration) << "\n";
         profs << "dd_total_preds=" << StrUtils::to_string(profiler.dd_p.total_preds) << "\n";
+        profs << "dd_skipped_theorems=" << StrUtils::to_string(profiler.dd_p.skipped_theorems) << "\n";
+        profs << "dd_frames=" << StrUtils::to_string(profiler.dd_p.frames) << "\n";
         for (const auto& [theorem_name, durations] : profiler.dd_p.theorem_duration) {
             profs << "dd_thm_duration:" << theorem_name << "=" << StrUtils::to_string(durations) << "\n";
         }
@@ -183,11 +185,14 @@ void OutputParser::output_profiler_data(std::string problem_name, Profiler& prof
         profs << "ar_displacement_table_eqs=" << StrUtils::to_string(profiler.ar_p.displacement_table_eqs) << "\n";
         profs << "ar_total_cols=" << StrUtils::to_string(profiler.ar_p.total_cols) << "\n";
         profs << "ar_total_rows=" << StrUtils::to_string(profiler.ar_p.total_rows) << "\n";
+        profs << "ar_frames=" << StrUtils::to_string(profiler.ar_p.frames) << "\n";
 
         profs << "ggraph_duration_dd=" << StrUtils::to_string(profiler.ggraph_p.duration_dd) << "\n";
         profs << "ggraph_duration_ar=" << StrUtils::to_string(profiler.ggraph_p.duration_ar) << "\n";
         profs << "ggraph_num_preds_dd=" << StrUtils::to_string(profiler.ggraph_p.num_preds_dd) << "\n";
         profs << "ggraph_num_preds_ar=" << StrUtils::to_string(profiler.ggraph_p.num_preds_ar) << "\n";
+        profs << "ggraph_frames_dd=" << StrUtils::to_string(profiler.ggraph_p.frames_dd) << "\n";
+        profs << "ggraph_frames_ar=" << StrUtils::to_string(profiler.ggraph_p.frames_ar) << "\n";
         profs << "ggraph_total_nodes=" << StrUtils::to_string(profiler.ggraph_p.total_nodes) << std::endl;
     }
     
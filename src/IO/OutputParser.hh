@@ -27,7 +27,7 @@ public:
     void format_problem_description(std::string problem_name, std::string problem_string);
     void format_numeric_diagram(NumInstance& num_instance);
     void format_failed_numeric_diagram(NumInstance& num_instance);
-    void format_solution_from_predset(std::map<int, std::set<Predicate*>>& predset, DDEngine& dd);
+    void format_solution_from_predset(std::map<int, std::set<Predicate*, PredicateOrder>>& predset, DDEngine& dd);
 
 
     void output_profiler_data(std::string problem_name, Profiler& profiler);
@@ -18,6 +18,8 @@ class Profiler {
 
         std::vector<long> duration;
         std::vector<int> total_preds;
+        std::vector<int> skipped_theorems;
+        std::vector<long> frames;
     };
     struct AREngineProfile {
         std::vector<int> angle_table_eqs;
@@ -27,6 +29,7 @@ class Profiler {
         std::vector<long> duration;
         std::vector<int> total_cols;
         std::vector<int> total_rows;
+        std::vector<long> frames;
     };
     struct GeometricGraphProfile {
         std::vector<int> num_preds_dd;
@@ -34,6 +37,8 @@ class Profiler {
 
         std::vector<long> duration_dd;
         std::vector<long> duration_ar;
+        std::vector<long> frames_dd;
+        std::vector<long> frames_ar;
         std::vector<int> total_nodes;
         long total_duration;
         int iterations;
@@ -296,25 +296,25 @@ CartesianPoint get_random_point_on_ray(CartesianRay &ray, double r, CartesianPoi
     }
     throw NumericsInternalError("Unable to satisfy max_dist requirement getting random point on ray.");
 }
-std::pair<std::vector<CartesianPoint>, double> get_random_points(std::vector<CartesianObject> &objs, CartesianPoint near, double max_dist) {
+std::pair<std::vector<CartesianPoint>, double> get_random_points(std::mt19937& gen, std::vector<CartesianObject> &objs, CartesianPoint near, double max_dist) {
     std::vector<CartesianPoint> res;
     return std::visit( overloaded {
         [&](CartesianLine &line) {
-            double r = NumUtils::urand(0.1, 0.9);
+            double r = NumUtils::urand(gen, 0.1, 0.9);
             for (auto &obj : objs) {
                 res.emplace_back(get_random_point_on_line(std::get<CartesianLine>(obj), r, near, max_dist));
             }
             return std::pair<std::vector<CartesianPoint>, double>{res, r};
         },
         [&](CartesianCircle &circle) {
-            double theta = NumUtils::urand(0, 2 * M_PI);
+            double theta = NumUtils::urand(gen, 0, 2 * M_PI);
             for (auto &obj : objs) {
                 res.emplace_back(get_random_point_on_circle(std::get<CartesianCircle>(obj), theta));
             }
             return std::pair<std::vector<CartesianPoint>, double>{res, theta};
         },
         [&](CartesianRay &ray)  {
-            double r = NumUtils::urand(0.1, 0.9);
+            double r = NumUtils::urand(gen, 0.1, 0.9);
             for (auto &obj : objs) {
                 res.emplace_back(get_random_point_on_ray(std::get<CartesianRay>(obj), r, near, max_dist));
             }
@@ -336,13 +336,13 @@ CartesianPoint from_polar(double r, double theta) {
 
 
 
-CartesianPoint random_point() {
-    return CartesianPoint(NumUtils::urand(-1, 1), NumUtils::urand(-1, 1));
+CartesianPoint random_point(std::mt19937& gen) {
+    return CartesianPoint(NumUtils::urand(gen, -1, 1), NumUtils::urand(gen, -1, 1));
 }
-std::vector<CartesianPoint> random_points(int n) {
-    std::vector<CartesianPoint> pts(n, random_point());
+std::vector<CartesianPoint> random_points(std::mt19937& gen, int n) {
+    std::vector<CartesianPoint> pts(n, random_point(gen));
     for (int i = 0; i < n; ++i) {
-        pts.emplace_back(random_point());
+        pts.emplace_back(random_point(gen));
     }
     return pts;
 }
@@ -418,6 +418,19 @@ CartesianPoint reflect(const CartesianPoint &p, const CartesianLine &l) {
     return f * 2 - p;
 }
 
+void batch_is_coll(const double* xs, const double* ys, std::size_t n,
+    const CartesianPoint &p1, const CartesianPoint &p2, std::uint8_t* out) {
+    for (std::size_t i = 0; i < n; i++) {
+        out[i] = NumUtils::is_close(0.5 * std::abs(p1.x * (p2.y - ys[i]) + p2.x * (ys[i] - p1.y) + xs[i] * (p1.y - p2.y)), 0.0);
+    }
+}
+void batch_is_same(const double* xs, const double* ys, std::size_t n,
+    const CartesianPoint &p, std::uint8_t* out) {
+    for (std::size_t i = 0; i < n; i++) {
+        out[i] = NumUtils::is_close(xs[i], p.x) & NumUtils::is_close(ys[i], p.y);
+    }
+}
+
 
 
 } // namespace Cartesian
\ No newline at end of file
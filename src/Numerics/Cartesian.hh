@@ -6,6 +6,9 @@
 #include <vector>
 #include <variant>
 #include <cmath>
+#include <random>
+#include <cstddef>
+#include <cstdint>
 
 #include "Common/Constants.hh"
 #include "Common/Exceptions.hh"
@@ -65,8 +68,8 @@ namespace Cartesian {
 
     CartesianPoint from_polar(double r, double theta);
 
-    CartesianPoint random_point();
-    std::vector<CartesianPoint> random_points(int n=3);
+    CartesianPoint random_point(std::mt19937& gen);
+    std::vector<CartesianPoint> random_points(std::mt19937& gen, int n=3);
 
     /* Computes the distance between two points p1, p2. */
     double distance(const CartesianPoint &p1, const CartesianPoint &p2);
@@ -168,7 +171,7 @@ namespace Cartesian {
     /* Given a vector of CartesianObjects (of the same type), generates a random point on each of the
     CartesianObjects using the same random parameter */
     std::pair<std::vector<CartesianPoint>, double> get_random_points(
-        std::vector<CartesianObject> &objs, CartesianPoint near = {0,0}, double max_dist = 10.0
+        std::mt19937& gen, std::vector<CartesianObject> &objs, CartesianPoint near = {0,0}, double max_dist = 10.0
     );
 
     /* Applies a random affine transform on a set of points.
@@ -176,12 +179,12 @@ namespace Cartesian {
     in the affine transform. */
     template <typename... T>
     requires (std::same_as<T, CartesianPoint> && ...)
-    std::array<double, 4> random_affine(T&... points) {
+    std::array<double, 4> random_affine(std::mt19937& gen, T&... points) {
         CartesianPoint c;
         c = (points + ...) / sizeof...(points);
-        double angle = NumUtils::urand(0, 2 * M_PI);
-        double scale = NumUtils::urand(0.25, 1.75);
-        CartesianPoint shift = CartesianPoint(NumUtils::urand(-1, 1), NumUtils::urand(-1, 1));
+        double angle = NumUtils::urand(gen, 0, 2 * M_PI);
+        double scale = NumUtils::urand(gen, 0.25, 1.75);
+        CartesianPoint shift = CartesianPoint(NumUtils::urand(gen, -1, 1), NumUtils::urand(gen, -1, 1));
         (points.shift(-c).rotate(angle).scale(scale).shift(shift), ...);
         return {angle, scale, shift.x, shift.y};
     }
@@ -280,4 +283,13 @@ namespace Cartesian {
     constexpr bool acute_angle(const CartesianPoint &a, const CartesianPoint &b, const CartesianPoint &c) {
         return Cartesian::dot(b - a, c - a) > 0;
     }
+
+    /* Batch kernels over `n` points stored as a structure of arrays `xs`, `ys`. Each sets `out[i]` to the
+    result of the corresponding single-point check with the i-th point as its last argument, with the
+    same floating-point operations. The loops are branch-free over contiguous arrays, so that the
+    compiler vectorises them. */
+    void batch_is_coll(const double* xs, const double* ys, std::size_t n,
+        const CartesianPoint &p1, const CartesianPoint &p2, std::uint8_t* out);
+    void batch_is_same(const double* xs, const double* ys, std::size_t n,
+        const CartesianPoint &p, std::uint8_t* out);
 };
\ No newline at end of file
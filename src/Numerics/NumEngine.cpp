@@ -2,6 +2,10 @@
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <limits>
+#include <exception>
 
 #include "NumEngine.hh"
 #include "Common/Exceptions.hh"
@@ -28,13 +32,13 @@ Numeric* NumEngine::insert_numeric(std::unique_ptr<Numeric> &&num) {
 }
 
 void NumEngine::compute_free(NumInstance& inst, Numeric* num) {
-    CartesianPoint a = Cartesian::random_point();
+    CartesianPoint a = Cartesian::random_point(inst.gen);
     inst.record_out(num, 0, a);
     inst.record_params({a.x, a.y});
 }
 // TODO: Make these random generators better
 void NumEngine::compute_segment(NumInstance& inst, Numeric* num) {
-    CartesianPoint a = Cartesian::random_point(), b = Cartesian::random_point();
+    CartesianPoint a = Cartesian::random_point(inst.gen), b = Cartesian::random_point(inst.gen);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_params({a.x, a.y, b.x, b.y});
@@ -43,32 +47,32 @@ void NumEngine::compute_segment(NumInstance& inst, Numeric* num) {
 void NumEngine::compute_triangle(NumInstance& inst, Numeric* num) {
     CartesianPoint b(0, 0), c(1, 0);
     // write code that generates a random point a such that a, b, c form an acute triangle
-    double angle = NumUtils::urand(M_PI / 20, 9 * M_PI / 20);
-    double r = NumUtils::urand(std::cos(angle), 1 / std::cos(angle));
+    double angle = NumUtils::urand(inst.gen, M_PI / 20, 9 * M_PI / 20);
+    double r = NumUtils::urand(inst.gen, std::cos(angle), 1 / std::cos(angle));
     CartesianPoint a = b + r * CartesianPoint(std::cos(angle), std::sin(angle));
-    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(a, b, c);
+    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(inst.gen, a, b, c);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_out(num, 2, c);
     inst.record_params({angle, r, aff_a, aff_sc, aff_shx, aff_shy});
 }
 void NumEngine::compute_iso_triangle(NumInstance& inst, Numeric* num) {
-    double angle = NumUtils::urand(M_PI / 20, 9 * M_PI / 20);
+    double angle = NumUtils::urand(inst.gen, M_PI / 20, 9 * M_PI / 20);
     CartesianPoint b(0, 0);
     CartesianPoint a(1, std::tan(angle));
     CartesianPoint c(2, 0);
-    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(a, b, c);
+    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(inst.gen, a, b, c);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_out(num, 2, c);
     inst.record_params({angle, aff_a, aff_sc, aff_shx, aff_shy});
 }
 void NumEngine::compute_r_triangle(NumInstance& inst, Numeric* num) {
-    double angle = NumUtils::urand(M_PI / 20, 9 * M_PI / 20);
+    double angle = NumUtils::urand(inst.gen, M_PI / 20, 9 * M_PI / 20);
     CartesianPoint a(0, 0);
     CartesianPoint b(1, 0);
     CartesianPoint c(0, std::tan(angle));
-    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(a, b, c);
+    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(inst.gen, a, b, c);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_out(num, 2, c);
@@ -78,7 +82,7 @@ void NumEngine::compute_riso_triangle(NumInstance& inst, Numeric* num) {
     CartesianPoint a(0, 0);
     CartesianPoint b(1, 0);
     CartesianPoint c(0, 1);
-    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(a, b, c);
+    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(inst.gen, a, b, c);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_out(num, 2, c);
@@ -88,7 +92,7 @@ void NumEngine::compute_equi_triangle(NumInstance& inst, Numeric* num) {
     CartesianPoint a(0, 0);
     CartesianPoint b(1, 0);
     CartesianPoint c(0.5, std::sqrt(3) / 2);
-    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(a, b, c);
+    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(inst.gen, a, b, c);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_out(num, 2, c);
@@ -121,8 +125,8 @@ void NumEngine::compute_equi_triangle_p(NumInstance& inst, Numeric* num) {
     }
 }
 void NumEngine::compute_quadrilateral(NumInstance& inst, Numeric* num) {
-    double angle1 = NumUtils::urand(M_PI / 10, 9 * M_PI / 10);
-    double angle2 = NumUtils::urand(M_PI / 10, 9 * M_PI / 10);
+    double angle1 = NumUtils::urand(inst.gen, M_PI / 10, 9 * M_PI / 10);
+    double angle2 = NumUtils::urand(inst.gen, M_PI / 10, 9 * M_PI / 10);
     CartesianPoint a(0, 0);
     CartesianPoint b(1, 0);
     CartesianPoint c0(-std::tan(M_PI_2 - angle1), 1);
@@ -131,15 +135,15 @@ void NumEngine::compute_quadrilateral(NumInstance& inst, Numeric* num) {
     if (angle1 + angle2 < M_PI) {
         double max_height = std::tan(M_PI_2 - angle1) + std::tan(M_PI_2 - angle2);
         max_height = std::min(max_height, 1.75);
-        hc = NumUtils::urand(0.25, max_height);
-        hd = NumUtils::urand(0.25, max_height);
+        hc = NumUtils::urand(inst.gen, 0.25, max_height);
+        hd = NumUtils::urand(inst.gen, 0.25, max_height);
     } else {
-        hc = NumUtils::urand(0.25, 1.75);
-        hd = NumUtils::urand(0.25, 1.75);
+        hc = NumUtils::urand(inst.gen, 0.25, 1.75);
+        hd = NumUtils::urand(inst.gen, 0.25, 1.75);
     }
     CartesianPoint c = b + c0 * hc;
     CartesianPoint d = a + d0 * hd;
-    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(a, b, c, d);
+    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(inst.gen, a, b, c, d);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_out(num, 2, c);
@@ -147,14 +151,14 @@ void NumEngine::compute_quadrilateral(NumInstance& inst, Numeric* num) {
     inst.record_params({angle1, angle2, hc, hd, aff_a, aff_sc, aff_shx, aff_shy});
 }
 void NumEngine::compute_cyclic_quad(NumInstance& inst, Numeric* num) {
-    double angle_c = NumUtils::urand(3 * M_PI / 10, M_PI);
-    double angle_b = NumUtils::urand(M_PI / 10, angle_c - M_PI / 10);
-    double angle_d = NumUtils::urand(M_PI / 10, 19 * M_PI / 10 - angle_c);
+    double angle_c = NumUtils::urand(inst.gen, 3 * M_PI / 10, M_PI);
+    double angle_b = NumUtils::urand(inst.gen, M_PI / 10, angle_c - M_PI / 10);
+    double angle_d = NumUtils::urand(inst.gen, M_PI / 10, 19 * M_PI / 10 - angle_c);
     CartesianPoint a = Cartesian::from_polar(1, 0);
     CartesianPoint b = Cartesian::from_polar(1, angle_b);
     CartesianPoint c = Cartesian::from_polar(1, angle_c);
     CartesianPoint d = Cartesian::from_polar(1, -angle_d);
-    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(a, b, c, d);
+    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(inst.gen, a, b, c, d);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_out(num, 2, c);
@@ -162,13 +166,13 @@ void NumEngine::compute_cyclic_quad(NumInstance& inst, Numeric* num) {
     inst.record_params({angle_b, angle_c, angle_d, aff_a, aff_sc, aff_shx, aff_shy});
 }
 void NumEngine::compute_rectangle(NumInstance& inst, Numeric* num) {
-    double width = NumUtils::urand(0.5, 1.5);
-    double height = NumUtils::urand(0.5, 1.5);
+    double width = NumUtils::urand(inst.gen, 0.5, 1.5);
+    double height = NumUtils::urand(inst.gen, 0.5, 1.5);
     CartesianPoint a(0, 0);
     CartesianPoint b(width, 0);
     CartesianPoint c(width, height);
     CartesianPoint d(0, height);
-    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(a, b, c, d);
+    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(inst.gen, a, b, c, d);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_out(num, 2, c);
@@ -176,12 +180,12 @@ void NumEngine::compute_rectangle(NumInstance& inst, Numeric* num) {
     inst.record_params({width, height, aff_a, aff_sc, aff_shx, aff_shy});
 }
 void NumEngine::compute_square(NumInstance& inst, Numeric* num) {
-    double side = NumUtils::urand(0.5, 1.5);
+    double side = NumUtils::urand(inst.gen, 0.5, 1.5);
     CartesianPoint a(0, 0);
     CartesianPoint b(side, 0);
     CartesianPoint c(side, side);
     CartesianPoint d(0, side);
-    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(a, b, c, d);
+    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(inst.gen, a, b, c, d);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_out(num, 2, c);
@@ -199,15 +203,15 @@ void NumEngine::compute_square_off_p(NumInstance& inst, Numeric* num) {
     }
 }
 void NumEngine::compute_trapezoid(NumInstance& inst, Numeric* num) {
-    double base1 = NumUtils::urand(0.5, 1.5);
-    double base2 = NumUtils::urand(0.5, 1.5);
-    double e = NumUtils::urand(-0.5, 0.5);
-    double height = NumUtils::urand(0.5, 1.5);
+    double base1 = NumUtils::urand(inst.gen, 0.5, 1.5);
+    double base2 = NumUtils::urand(inst.gen, 0.5, 1.5);
+    double e = NumUtils::urand(inst.gen, -0.5, 0.5);
+    double height = NumUtils::urand(inst.gen, 0.5, 1.5);
     CartesianPoint a(0, 0);
     CartesianPoint b(base1, 0);
     CartesianPoint c((base1 + base2) / 2 + e, height);
     CartesianPoint d((base1 - base2) / 2 + e, height);
-    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(a, b, c, d);
+    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(inst.gen, a, b, c, d);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_out(num, 2, c);
@@ -215,14 +219,14 @@ void NumEngine::compute_trapezoid(NumInstance& inst, Numeric* num) {
     inst.record_params({base2/base1, e/base1, height/base1, aff_a, aff_sc, aff_shx, aff_shy});
 }
 void NumEngine::compute_eq_trapezoid(NumInstance& inst, Numeric* num) {
-    double base1 = NumUtils::urand(0.25, 0.75);
-    double base2 = NumUtils::urand(0.25, 0.75);
-    double height = NumUtils::urand(0.5, 1.5);
+    double base1 = NumUtils::urand(inst.gen, 0.25, 0.75);
+    double base2 = NumUtils::urand(inst.gen, 0.25, 0.75);
+    double height = NumUtils::urand(inst.gen, 0.5, 1.5);
     CartesianPoint a(-base1, 0);
     CartesianPoint b(base1, 0);
     CartesianPoint c(-base2, height);
     CartesianPoint d(base2, height);
-    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(a, b, c, d);
+    auto [aff_a, aff_sc, aff_shx, aff_shy] = Cartesian::random_affine(inst.gen, a, b, c, d);
     inst.record_out(num, 0, a);
     inst.record_out(num, 1, b);
     inst.record_out(num, 2, c);
@@ -393,7 +397,7 @@ void NumEngine::compute_reflect(NumInstance& inst, Numeric* num) {
 
 
 void NumEngine::compute_angle_eq2(NumInstance& inst, Numeric* num) {
-    double ks = NumUtils::urand(0, 1);
+    double ks = NumUtils::urand(inst.gen, 0, 1);
     for (CartesianPoint a : inst.get_arg_coords(num, 0)) {
         for (CartesianPoint b : inst.get_arg_coords(num, 1)) {
             for (CartesianPoint c : inst.get_arg_coords(num, 2)) {
@@ -699,7 +703,10 @@ void NumEngine::compute_common_tangent2(NumInstance& inst, Numeric* num) {
 
 
 void NumEngine::get_operation_order() {
-    std::map<Point*, NumInstance::ComputationStatus> point_status;
+    // Resolve points in name order, so that the random draws don't depend on where the points
+    // happen to live in memory
+    auto by_name = [](Point* p1, Point* p2) { return p1->name < p2->name; };
+    std::map<Point*, NumInstance::ComputationStatus, decltype(by_name)> point_status(by_name);
     for (Point* p : all_points) {
         point_status[p] = NumInstance::ComputationStatus::UNCOMPUTED;
     }
@@ -763,19 +770,19 @@ void NumEngine::compute_one(NumInstance& inst, Numeric* num) {
 
     int i = 0, l = num->outs.size();
     if (compute_function_map_point.contains(name)) {
-        (this->*compute_function_map_point[name])(inst, num);
+        (this->*compute_function_map_point.at(name))(inst, num);
 
     } else if (compute_function_map_line.contains(name)) {
         inst.next_outs(num);
-        (this->*compute_function_map_line[name])(inst, num);
+        (this->*compute_function_map_line.at(name))(inst, num);
 
     } else if (compute_function_map_ray.contains(name)) {
         inst.next_outs(num);
-        (this->*compute_function_map_ray[name])(inst, num);
+        (this->*compute_function_map_ray.at(name))(inst, num);
 
     } else if (compute_function_map_circle.contains(name)) {
         inst.next_outs(num);
-        (this->*compute_function_map_circle[name])(inst, num);
+        (this->*compute_function_map_circle.at(name))(inst, num);
 
     } else {
         throw NumericsInternalError("NumEngine::compute_one(): No compute function for numeric " + num->to_string());
@@ -798,6 +805,7 @@ void NumEngine::resolve_one(NumInstance &inst, Point* p) {
             // We only have one Numeric worth of CartesianObjects to work with
             // Simply pick random points off these CartesianObjects using the same random parameter
             auto [pts, rand] = Cartesian::get_random_points(
+                inst.gen,
                 inst.point_to_cartesian_objs[p][0],
                 inst.centroid_of_resolved_points,
                 inst.max_dist
@@ -961,14 +969,67 @@ bool NumEngine::compute(NumInstance& inst) {
 bool NumEngine::first_draw() {
     get_operation_order();
 
-    NumInstance inst(all_points);
+    int k = std::max(1, num_draws);
+    instances.assign(k, NumInstance());
+    std::atomic<int> next_draw = 0;
+    std::atomic<bool> stop = false;
+    // Any other exception thrown by a draw is rethrown on this thread, as if the draws ran in order
+    std::vector<std::exception_ptr> errors(k);
+
+    /* Draws are handed out in index order, so the draws that were started always form a prefix
+    of [0, k). This makes the first valid draw independent of how the threads are scheduled. */
+    auto worker = [&]() {
+        for (int i; !stop && (i = next_draw++) < k; ) {
+            NumInstance& inst = instances[i];
+            inst = NumInstance(all_points);
+            inst.gen.seed(NumUtils::mix_seed(seed, i));
+            try {
+                if (compute(inst)) stop = true;
+            } catch (const NumericsInternalError& e) {
+                LOG("Draw " << i << " failed: " << e.what());
+                inst = NumInstance(all_points);
+                inst.loss = std::numeric_limits<double>::infinity();
+            } catch (const GGraphInternalError& e) {
+                LOG("Draw " << i << " failed: " << e.what());
+                inst = NumInstance(all_points);
+                inst.loss = std::numeric_limits<double>::infinity();
+            } catch (...) {
+                errors[i] = std::current_exception();
+                stop = true;
+            }
+        }
+    };
+
+    // Every job gets its share of the hardware threads, so that `--jobs` does not oversubscribe
+    int hw_threads = std::max(1u, std::thread::hardware_concurrency());
+    int num_threads = std::min(k, std::max(1, hw_threads / std::max(1, num_jobs)));
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; t++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : threads) {
+        t.join();
+    }
 
-    if (compute(inst)) {
-        final_inst = inst;
-    } else {
-        std::cout << "Invalid instance with loss " << inst.loss << std::endl;
+    /* Keep the first valid draw, or failing that, the draw with the lowest loss. A draw which threw
+    before any valid draw ends the search, as it would have if the draws had been made one by one. */
+    int drawn = std::min(k, next_draw.load()), best = 0;
+    for (int i = 0; i < drawn; i++) {
+        if (errors[i]) std::rethrow_exception(errors[i]);
+        if (instances[i].is_valid()) {
+            best = i;
+            break;
+        }
+        if (instances[i].loss < instances[best].loss) best = i;
     }
-    return inst.is_valid();
+    instances.resize(drawn);
+
+    final_inst = instances[best];
+    if (!final_inst.is_valid()) {
+        std::cout << "Invalid instance with loss " << final_inst.loss << " after " << drawn << " draw(s)" << std::endl;
+    }
+    return final_inst.is_valid();
 }
 
 
@@ -14,12 +14,21 @@ the numeric resolution sequence proceeds as follows: compute a0 numerics, then
 resolve the first a1 points in `order_of_resolution`, and so on and so forth. 
 
 `progress`: integer indicating the number of operations performed so far until the
-first resolution conflict. */
+first resolution conflict.
+
+`seed`: seed of the current problem. The i-th draw seeds its NumInstance's generator with
+`NumUtils::mix_seed(seed, i)`.
+
+`num_draws`: maximum number of candidate instances drawn concurrently by `first_draw()`. The
+drawn instances are kept in `instances`.
+
+`num_jobs`: number of problems solved concurrently (see `--jobs`). The draws of `first_draw()`
+share the hardware threads with the other jobs. */
 class NumEngine {
 public:
     std::vector<std::unique_ptr<Numeric>> numerics;
 
-    std::set<Point*> all_points;
+    std::set<Point*, NodeOrder> all_points;
 
     std::vector<int> order_of_ops;
     std::vector<Point*> order_of_resolution;
@@ -27,6 +36,10 @@ public:
     std::vector<NumInstance> instances;
     NumInstance final_inst;
 
+    std::uint64_t seed = 0;
+    int num_draws = 1;
+    int num_jobs = 1;
+
     Numeric* insert_numeric(std::unique_ptr<Numeric>&& num);
 
     void compute_free(NumInstance& inst, Numeric* num);
@@ -203,11 +216,16 @@ public:
     /* Resolves one point `p` to its Cartesian coordinates. */
     void resolve_one(NumInstance& inst, Point* p);
 
+    /* Computes all numerics and resolves all points of `inst`. Only reads from the NumEngine, so
+    different instances may be computed concurrently. */
     bool compute(NumInstance& inst);
 
 
 
-    /* Draw a valid NumInstance. */
+    /* Draws up to `num_draws` candidate NumInstances with different seeds, stopping early once
+    one of them is valid. Keeps the first valid instance (by draw index), or else the one with
+    the lowest loss, as `final_inst`. A draw that fails to resolve a point counts as invalid. Any
+    other exception thrown by a draw is rethrown on the calling thread. */
     bool first_draw();
 
 
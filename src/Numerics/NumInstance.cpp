@@ -5,7 +5,7 @@
 #include "Common/Constants.hh"
 
 
-NumInstance::NumInstance(const std::set<Point*> &points) {
+NumInstance::NumInstance(const std::set<Point*, NodeOrder> &points) {
     for (Point* p : points) {
         point_to_cartesian_objs[p] = {}; 
         point_coord_occurences[p] = {};
@@ -4,6 +4,7 @@
 #include <map>
 #include <vector>
 #include <span>
+#include <random>
 
 #include "Geometry/Object.hh"
 #include "Numerics.hh"
@@ -11,9 +12,9 @@
 
 class NumInstance {
 public:
-    std::map<Point*, std::vector<std::vector<CartesianObject>>> point_to_cartesian_objs;
-    std::map<Point*, std::vector<int>> point_coord_occurences;
-    std::map<Point*, std::vector<CartesianPoint>> point_to_coords;
+    std::map<Point*, std::vector<std::vector<CartesianObject>>, NodeOrder> point_to_cartesian_objs;
+    std::map<Point*, std::vector<int>, NodeOrder> point_coord_occurences;
+    std::map<Point*, std::vector<CartesianPoint>, NodeOrder> point_to_coords;
 
     enum ComputationStatus {
         UNCOMPUTED,
@@ -22,15 +23,19 @@ public:
         RESOLVED,
         RESOLVED_WITH_DISCREPANCY
     };
-    std::map<Point*, ComputationStatus> point_status;
+    std::map<Point*, ComputationStatus, NodeOrder> point_status;
     std::vector<std::vector<double>> params;
 
     CartesianPoint centroid_of_resolved_points;
     int num_resolved = 0;
     double max_dist;
 
+    /* Random number generator for every random parameter drawn for this instance. Owning it here
+    keeps instances independent of each other, so that a draw is reproducible from its seed alone. */
+    std::mt19937 gen;
+
     NumInstance() = default;
-    NumInstance(const std::set<Point*> &points);
+    NumInstance(const std::set<Point*, NodeOrder> &points);
     NumInstance(const std::map<std::string, std::unique_ptr<Point>>& point_map);
 
     constexpr std::span<const CartesianPoint> get_arg_coords(Numeric* num, int i) const {
@@ -394,7 +394,7 @@ void TracebackEngine::set_fraction_val(Fraction* f, Frac val, PredSet pred) {
 
 Direction* TracebackEngine::__earliest_direction_of(
     Line* l, 
-    std::map<Line*, Direction*>& earliest_direction_cache
+    std::map<Line*, Direction*, NodeOrder>& earliest_direction_cache
 ) {
     if (earliest_direction_cache.contains(l)) {
         return earliest_direction_cache[l];
@@ -413,7 +413,7 @@ Direction* TracebackEngine::__earliest_direction_of(
 }
 Length* TracebackEngine::__earliest_length_of(
     Segment* s,
-    std::map<Segment*, Length*>& earliest_length_cache
+    std::map<Segment*, Length*, NodeOrder>& earliest_length_cache
 ) {
     if (earliest_length_cache.contains(s)) {
         return earliest_length_cache[s];
@@ -433,7 +433,7 @@ Length* TracebackEngine::__earliest_length_of(
 
 std::pair<Angle*, Measure*> TracebackEngine::__earliest_measure_of(
     Angle* a,
-    std::map<Angle*, Measure*>& earliest_measure_cache
+    std::map<Angle*, Measure*, NodeOrder>& earliest_measure_cache
 ) {
     if (earliest_measure_cache.contains(a)) {
         return {a, earliest_measure_cache[a]};
@@ -452,7 +452,7 @@ std::pair<Angle*, Measure*> TracebackEngine::__earliest_measure_of(
 }
 std::pair<Ratio*, Fraction*> TracebackEngine::__earliest_fraction_of(
     Ratio* r,
-    std::map<Ratio*, Fraction*>& earliest_fraction_cache
+    std::map<Ratio*, Fraction*, NodeOrder>& earliest_fraction_cache
 ) {
     if (earliest_fraction_cache.contains(r)) {
         return {r, earliest_fraction_cache[r]};
@@ -474,13 +474,13 @@ std::pair<Ratio*, Fraction*> TracebackEngine::__earliest_fraction_of(
 
 
 
-std::tuple<std::map<Line*, PredSet>, Line*> TracebackEngine::lca_lines_and_why(
+std::tuple<std::map<Line*, PredSet, NodeOrder>, Line*> TracebackEngine::lca_lines_and_why(
     Point* p1, Point* p2,
-    std::map<std::pair<Point*, Point*>, PredSet>& why_point_ancestor_cache,
-    std::map<std::pair<Line*, Line*>, PredSet>& why_line_ancestor_cache
+    std::map<std::pair<Point*, Point*>, PredSet, NodeOrder>& why_point_ancestor_cache,
+    std::map<std::pair<Line*, Line*>, PredSet, NodeOrder>& why_line_ancestor_cache
 ) {    
     /* Step 1: Extract all children of p1 and p2 */
-    std::array<std::set<Point*>, 2> pcs;
+    std::array<std::set<Point*, NodeOrder>, 2> pcs;
     int i = 0;
     for (Point* p : std::array<Point*, 2>{p1, p2}) {
         NodeUtils::all_children(p, pcs[i]);
@@ -490,7 +490,7 @@ std::tuple<std::map<Line*, PredSet>, Line*> TracebackEngine::lca_lines_and_why(
     /* Step 2: For each child point, extract all lines it was placed on.
     It suffices to consider lines whose roots have Directions */
     std::array<std::vector<std::pair<Line*, Point*>>, 2> l2ps;
-    std::array<std::set<Line*>, 2> rls;
+    std::array<std::set<Line*, NodeOrder>, 2> rls;
     for (i = 0; i < 2; i++) {
         for (Point* p : pcs[i]) {
             for (auto [l, pred] : point_on_lines[p]) {
@@ -530,7 +530,7 @@ std::tuple<std::map<Line*, PredSet>, Line*> TracebackEngine::lca_lines_and_why(
     `(q1, q2)` and `(r1, r2)`, and both `qi, ri` were merged into `pi`, it is not inconceivable 
     that there might be some `lca1` containing `(q1, q2)` and some other `lca1` containing 
     `(r1, r2)`. */
-    std::map<Line*, PredSet> lcas;
+    std::map<Line*, PredSet, NodeOrder> lcas;
     for (auto [l_p1, cp1] : l2ps[0]) {
         for (auto [l_p2, cp2] : l2ps[1]) {
             auto lca_ = TracebackUtils::lowest_common_ancestor(l_p1, l_p2);
@@ -551,13 +551,13 @@ std::tuple<std::map<Line*, PredSet>, Line*> TracebackEngine::lca_lines_and_why(
     return {lcas, common_root};
 }
 
-std::tuple<std::map<Segment*, PredSet>, Segment*> TracebackEngine::lca_segments_and_why(
+std::tuple<std::map<Segment*, PredSet, NodeOrder>, Segment*> TracebackEngine::lca_segments_and_why(
     Point* p1, Point* p2,
-    std::map<std::pair<Point*, Point*>, PredSet>& why_point_ancestor_cache,
-    std::map<std::pair<Segment*, Segment*>, PredSet>& why_segment_ancestor_cache
+    std::map<std::pair<Point*, Point*>, PredSet, NodeOrder>& why_point_ancestor_cache,
+    std::map<std::pair<Segment*, Segment*>, PredSet, NodeOrder>& why_segment_ancestor_cache
 ) {
     /* Step 1: Extract all children of p1 and p2 */
-    std::array<std::set<Point*>, 2> pcs;
+    std::array<std::set<Point*, NodeOrder>, 2> pcs;
     int i = 0;
     for (Point* p : std::array<Point*, 2>{p1, p2}) {
         NodeUtils::all_children(p, pcs[i]);
@@ -567,7 +567,7 @@ std::tuple<std::map<Segment*, PredSet>, Segment*> TracebackEngine::lca_segments_
     /* Step 2: For each child point, extract all segments it was placed on.
     It suffices to consider segments whose roots have Lengths */
     std::array<std::vector<std::pair<Segment*, Point*>>, 2> s2ps;
-    std::array<std::set<Segment*>, 2> rss;
+    std::array<std::set<Segment*, NodeOrder>, 2> rss;
     for (i = 0; i < 2; i++) {
         for (Point* p : pcs[i]) {
             for (auto [l, pred] : point_as_segment_endpoint[p]) {
@@ -602,7 +602,7 @@ std::tuple<std::map<Segment*, PredSet>, Segment*> TracebackEngine::lca_segments_
 
     /* Step 5: Iterate over all pairs of segments in `s2ps` of `s1, s2`, identifying the
     LCAs of each pair and its associated why's. */
-    std::map<Segment*, PredSet> lcas;
+    std::map<Segment*, PredSet, NodeOrder> lcas;
     for (auto [s_p1, cp1] : s2ps[0]) {
         for (auto [s_p2, cp2] : s2ps[1]) {
             auto lca_ = TracebackUtils::lowest_common_ancestor(s_p1, s_p2);
@@ -631,11 +631,11 @@ std::tuple<std::map<Segment*, PredSet>, Segment*> TracebackEngine::lca_segments_
 
 std::pair<std::pair<Direction*, Line*>, PredSet> TracebackEngine::most_explainable_direction_of_line(
     Line* l, Direction* d,
-    std::map<std::pair<Direction*, Direction*>, PredSet>& why_direction_ancestor_cache,
-    std::map<std::pair<Line*, Line*>, PredSet>& why_line_ancestor_cache
+    std::map<std::pair<Direction*, Direction*>, PredSet, NodeOrder>& why_direction_ancestor_cache,
+    std::map<std::pair<Line*, Line*>, PredSet, NodeOrder>& why_line_ancestor_cache
 ) {
     /* Extract all children of `l` which were assigned directions */
-    std::set<Line*> l_cs;
+    std::set<Line*, NodeOrder> l_cs;
     std::vector<std::pair<Direction*, Line*>> d2ls;
 
     NodeUtils::all_children(l, l_cs);
@@ -673,11 +673,11 @@ std::pair<std::pair<Direction*, Line*>, PredSet> TracebackEngine::most_explainab
 }
 std::pair<std::pair<Length*, Segment*>, PredSet> TracebackEngine::most_explainable_length_of_segment(
     Segment* s, Length* len,
-    std::map<std::pair<Length*, Length*>, PredSet>& why_length_ancestor_cache,
-    std::map<std::pair<Segment*, Segment*>, PredSet>& why_segment_ancestor_cache
+    std::map<std::pair<Length*, Length*>, PredSet, NodeOrder>& why_length_ancestor_cache,
+    std::map<std::pair<Segment*, Segment*>, PredSet, NodeOrder>& why_segment_ancestor_cache
 ) {
     /* Extract all children of `s` which were assigned lengths */
-    std::set<Segment*> s_cs;
+    std::set<Segment*, NodeOrder> s_cs;
     std::vector<std::pair<Length*, Segment*>> l2ss;
 
     NodeUtils::all_children(s, s_cs);
@@ -714,11 +714,11 @@ std::pair<std::pair<Length*, Segment*>, PredSet> TracebackEngine::most_explainab
 }
 std::pair<std::pair<Measure*, Angle*>, PredSet> TracebackEngine::most_explainable_measure_of_angle(
     Angle* a, Measure* m,
-    std::map<std::pair<Measure*, Measure*>, PredSet>& why_measure_ancestor_cache,
-    std::map<std::pair<Angle*, Angle*>, PredSet>& why_angle_ancestor_cache
+    std::map<std::pair<Measure*, Measure*>, PredSet, NodeOrder>& why_measure_ancestor_cache,
+    std::map<std::pair<Angle*, Angle*>, PredSet, NodeOrder>& why_angle_ancestor_cache
 ) {
     /* Extract all children of `a` which were assigned measures */
-    std::set<Angle*> a_cs;
+    std::set<Angle*, NodeOrder> a_cs;
     std::vector<std::pair<Measure*, Angle*>> m2as;
 
     NodeUtils::all_children(a, a_cs);
@@ -755,11 +755,11 @@ std::pair<std::pair<Measure*, Angle*>, PredSet> TracebackEngine::most_explainabl
 }
 std::pair<std::pair<Fraction*, Ratio*>, PredSet> TracebackEngine::most_explainable_fraction_of_ratio(
     Ratio* r, Fraction* f,
-    std::map<std::pair<Fraction*, Fraction*>, PredSet>& why_fraction_ancestor_cache,
-    std::map<std::pair<Ratio*, Ratio*>, PredSet>& why_ratio_ancestor_cache
+    std::map<std::pair<Fraction*, Fraction*>, PredSet, NodeOrder>& why_fraction_ancestor_cache,
+    std::map<std::pair<Ratio*, Ratio*>, PredSet, NodeOrder>& why_ratio_ancestor_cache
 ) {
     /* Extract all children of `r` which were assigned fractions */
-    std::set<Ratio*> r_cs;
+    std::set<Ratio*, NodeOrder> r_cs;
     std::vector<std::pair<Fraction*, Ratio*>> f2rs;
 
     NodeUtils::all_children(r, r_cs);
@@ -802,13 +802,13 @@ std::pair<std::pair<Fraction*, Ratio*>, PredSet> TracebackEngine::most_explainab
 
 PredSet TracebackEngine::why_coll(Point* p1, Point* p2, Point* p3) {
     PredSet res;
-    std::map<std::pair<Point*, Point*>, PredSet> why_point_ancestor_cache;
-    std::map<std::pair<Line*, Line*>, PredSet> why_line_ancestor_cache;
+    std::map<std::pair<Point*, Point*>, PredSet, NodeOrder> why_point_ancestor_cache;
+    std::map<std::pair<Line*, Line*>, PredSet, NodeOrder> why_line_ancestor_cache;
 
     const std::array<Point*, 3> ps{p1, p2, p3};
 
     /* Step 1: Extract all children of p1, p2 and p3 */
-    std::array<std::set<Point*>, 3> pcs;
+    std::array<std::set<Point*, NodeOrder>, 3> pcs;
     int i = 0;
     for (Point* p : ps) {
         NodeUtils::all_children(p, pcs[i]);
@@ -818,7 +818,7 @@ PredSet TracebackEngine::why_coll(Point* p1, Point* p2, Point* p3) {
     /* Step 2: For each child point, extract all lines it was placed on. This is
     stored in `l2ps`. We also store the root versions of these lines in `rls`. */
     std::array<std::vector<std::pair<Line*, Point*>>, 3> l2ps;
-    std::array<std::set<Line*>, 3> rls;
+    std::array<std::set<Line*, NodeOrder>, 3> rls;
     for (i = 0; i < 3; i++) {
         for (Point* p : pcs[i]) {
             for (auto [l, pred] : point_on_lines[p]) {
@@ -903,13 +903,13 @@ PredSet TracebackEngine::why_coll(Point* p1, Point* p2, Point* p3) {
 
 PredSet TracebackEngine::why_cyclic(Point* p1, Point* p2, Point* p3, Point* p4) {
     PredSet res;
-    std::map<std::pair<Point*, Point*>, PredSet> why_point_ancestor_cache;
-    std::map<std::pair<Circle*, Circle*>, PredSet> why_circle_ancestor_cache;
+    std::map<std::pair<Point*, Point*>, PredSet, NodeOrder> why_point_ancestor_cache;
+    std::map<std::pair<Circle*, Circle*>, PredSet, NodeOrder> why_circle_ancestor_cache;
 
     const std::array<Point*, 4> ps{p1, p2, p3, p4};
 
     /* Step 1: Extract all children of p1, p2, p3, p4 */ 
-    std::array<std::set<Point*>, 4> pcs;
+    std::array<std::set<Point*, NodeOrder>, 4> pcs;
     int i = 0;
     for (Point* p : ps) {
         NodeUtils::all_children(p, pcs[i]);
@@ -918,7 +918,7 @@ PredSet TracebackEngine::why_cyclic(Point* p1, Point* p2, Point* p3, Point* p4)
 
     /* Step 2: For each child point, extract all circles it was placed on */
     std::array<std::vector<std::pair<Circle*, Point*>>, 4> c2ps;
-    std::array<std::set<Circle*>, 4> rcs;
+    std::array<std::set<Circle*, NodeOrder>, 4> rcs;
     for (i = 0; i < 4; i++) {
         for (Point* p : pcs[i]) {
             for (auto [c, pred] : point_on_circles[p]) {
@@ -996,14 +996,14 @@ PredSet TracebackEngine::why_cyclic(Point* p1, Point* p2, Point* p3, Point* p4)
 
 PredSet TracebackEngine::why_circle(Point* c, Point* p1, Point* p2, Point* p3) {
     PredSet res;
-    std::map<std::pair<Point*, Point*>, PredSet> why_point_ancestor_cache;
-    std::map<std::pair<Circle*, Circle*>, PredSet> why_circle_ancestor_cache;
+    std::map<std::pair<Point*, Point*>, PredSet, NodeOrder> why_point_ancestor_cache;
+    std::map<std::pair<Circle*, Circle*>, PredSet, NodeOrder> why_circle_ancestor_cache;
 
     const std::array<Point*, 3> ps{p1, p2, p3};
 
     /* Step 1: Extract all children of c, p1, p2 and p3 */
-    std::set<Point*> ccs; 
-    std::array<std::set<Point*>, 3> pcs;
+    std::set<Point*, NodeOrder> ccs; 
+    std::array<std::set<Point*, NodeOrder>, 3> pcs;
     NodeUtils::all_children(c, ccs);
     int i = 0;
     for (Point* p : ps) {
@@ -1013,7 +1013,7 @@ PredSet TracebackEngine::why_circle(Point* c, Point* p1, Point* p2, Point* p3) {
 
     /* Step 2: Extract all circles for which a child of c was set as center */
     std::vector<std::pair<Circle*, Point*>> circ2c;
-    std::set<Circle*> root_circ_cs;
+    std::set<Circle*, NodeOrder> root_circ_cs;
     for (Point* cc : ccs) {
         for (auto [circ, pred] : point_as_circle_center[cc]) {
             circ2c.emplace_back(circ, cc);
@@ -1045,7 +1045,7 @@ PredSet TracebackEngine::why_circle(Point* c, Point* p1, Point* p2, Point* p3) {
 
     /* Step 5: For each pi, extract all children of common_root which it was
     placed on */
-    std::array<std::map<Circle*, Point*>, 3> p2cs;
+    std::array<std::map<Circle*, Point*, NodeOrder>, 3> p2cs;
     for (i = 0; i < 3; i++) {
         for (Point* p : pcs[i]) {
             for (auto [c, pred] : point_on_circles[p]) {
@@ -1110,16 +1110,16 @@ PredSet TracebackEngine::why_para(Point* p1, Point* p2, Point* p3, Point* p4) {
         return {};
     }
     PredSet res;
-    std::map<std::pair<Point*, Point*>, PredSet> why_point_ancestor_cache;
-    std::map<std::pair<Line*, Line*>, PredSet> why_line_ancestor_cache;
-    std::map<std::pair<Direction*, Direction*>, PredSet> why_direction_ancestor_cache;
-    std::map<Line*, Direction*> earliest_direction_cache;
+    std::map<std::pair<Point*, Point*>, PredSet, NodeOrder> why_point_ancestor_cache;
+    std::map<std::pair<Line*, Line*>, PredSet, NodeOrder> why_line_ancestor_cache;
+    std::map<std::pair<Direction*, Direction*>, PredSet, NodeOrder> why_direction_ancestor_cache;
+    std::map<Line*, Direction*, NodeOrder> earliest_direction_cache;
 
     // std::cout << "---- why_para " << p1->to_string() << " " << p2->to_string() << " " << p3->to_string() << " " << p4->to_string() << std::endl;
 
     /* Steps 1-5: Fetch the lca_lines of `p1p2` and `p3p4` */
     Line* common_root_12 = nullptr, *common_root_34 = nullptr;
-    std::map<Line*, PredSet> lca1s, lca2s;
+    std::map<Line*, PredSet, NodeOrder> lca1s, lca2s;
     std::tie(lca1s, common_root_12) = lca_lines_and_why(p1, p2, why_point_ancestor_cache, why_line_ancestor_cache);
     std::tie(lca2s, common_root_34) = lca_lines_and_why(p3, p4, why_point_ancestor_cache, why_line_ancestor_cache);
 
@@ -1224,14 +1224,14 @@ PredSet TracebackEngine::why_para(Point* p1, Point* p2, Point* p3, Point* p4) {
 
 PredSet TracebackEngine::why_perp(Point* p1, Point* p2, Point* p3, Point* p4) {
     PredSet res;
-    std::map<std::pair<Point*, Point*>, PredSet> why_point_ancestor_cache;
-    std::map<std::pair<Line*, Line*>, PredSet> why_line_ancestor_cache;
-    std::map<std::pair<Direction*, Direction*>, PredSet> why_direction_ancestor_cache;
-    std::map<Line*, Direction*> earliest_direction_cache;
+    std::map<std::pair<Point*, Point*>, PredSet, NodeOrder> why_point_ancestor_cache;
+    std::map<std::pair<Line*, Line*>, PredSet, NodeOrder> why_line_ancestor_cache;
+    std::map<std::pair<Direction*, Direction*>, PredSet, NodeOrder> why_direction_ancestor_cache;
+    std::map<Line*, Direction*, NodeOrder> earliest_direction_cache;
 
     /* Steps 1-5: Fetch the lca_lines of `p1p2` and `p3p4` */
     Line* common_root_12 = nullptr, *common_root_34 = nullptr;
-    std::map<Line*, PredSet> lca1s, lca2s;
+    std::map<Line*, PredSet, NodeOrder> lca1s, lca2s;
     std::tie(lca1s, common_root_12) = lca_lines_and_why(p1, p2, why_point_ancestor_cache, why_line_ancestor_cache);
     std::tie(lca2s, common_root_34) = lca_lines_and_why(p3, p4, why_point_ancestor_cache, why_line_ancestor_cache);
 
@@ -1241,7 +1241,7 @@ PredSet TracebackEngine::why_perp(Point* p1, Point* p2, Point* p3, Point* p4) {
 
     /* Step 6: Identify all instances at which children `(pd1, pd2)` of `(rd1, rd2)` were set to
     be perpendicular */
-    std::set<std::pair<Direction*, Direction*>> dir_pairs = perp_directions_root_map[{rd1, rd2}];
+    std::set<std::pair<Direction*, Direction*>, NodeOrder> dir_pairs = perp_directions_root_map[{rd1, rd2}];
     for (const auto& [pd2, pd1] : perp_directions_root_map[{rd2, rd1}]) {
         dir_pairs.insert({pd1, pd2});
     }
@@ -1314,14 +1314,14 @@ PredSet TracebackEngine::why_cong(Point* p1, Point* p2, Point* p3, Point* p4) {
         return {};
     }
     PredSet res;
-    std::map<std::pair<Point*, Point*>, PredSet> why_point_ancestor_cache;
-    std::map<std::pair<Segment*, Segment*>, PredSet> why_segment_ancestor_cache;
-    std::map<std::pair<Length*, Length*>, PredSet> why_length_ancestor_cache;
-    std::map<Segment*, Length*> earliest_length_cache;
+    std::map<std::pair<Point*, Point*>, PredSet, NodeOrder> why_point_ancestor_cache;
+    std::map<std::pair<Segment*, Segment*>, PredSet, NodeOrder> why_segment_ancestor_cache;
+    std::map<std::pair<Length*, Length*>, PredSet, NodeOrder> why_length_ancestor_cache;
+    std::map<Segment*, Length*, NodeOrder> earliest_length_cache;
 
     /* Steps 1-5: Fetch the lca_segments of `p1p2` and `p3p4` */
     Segment* common_root_12 = nullptr, *common_root_34 = nullptr;
-    std::map<Segment*, PredSet> lca1s, lca2s;
+    std::map<Segment*, PredSet, NodeOrder> lca1s, lca2s;
     std::tie(lca1s, common_root_12) = lca_segments_and_why(p1, p2, why_point_ancestor_cache, why_segment_ancestor_cache);
     std::tie(lca2s, common_root_34) = lca_segments_and_why(p3, p4, why_point_ancestor_cache, why_segment_ancestor_cache);
 
@@ -1399,18 +1399,18 @@ PredSet TracebackEngine::why_midp(Point* m, Point* p1, Point* p2) {
 
 PredSet TracebackEngine::why_eqangle(Point* p1, Point* p2, Point* p3, Point* p4, Point* p5, Point* p6, Point* p7, Point* p8) {
     PredSet res;
-    std::map<std::pair<Point*, Point*>, PredSet> why_point_ancestor_cache;
-    std::map<std::pair<Line*, Line*>, PredSet> why_line_ancestor_cache;
-    std::map<std::pair<Direction*, Direction*>, PredSet> why_direction_ancestor_cache;
-    std::map<std::pair<Angle*, Angle*>, PredSet> why_angle_ancestor_cache;
-    std::map<std::pair<Measure*, Measure*>, PredSet> why_measure_ancestor_cache;
+    std::map<std::pair<Point*, Point*>, PredSet, NodeOrder> why_point_ancestor_cache;
+    std::map<std::pair<Line*, Line*>, PredSet, NodeOrder> why_line_ancestor_cache;
+    std::map<std::pair<Direction*, Direction*>, PredSet, NodeOrder> why_direction_ancestor_cache;
+    std::map<std::pair<Angle*, Angle*>, PredSet, NodeOrder> why_angle_ancestor_cache;
+    std::map<std::pair<Measure*, Measure*>, PredSet, NodeOrder> why_measure_ancestor_cache;
 
-    std::map<Line*, Direction*> earliest_direction_cache;
-    std::map<Angle*, Measure*> earliest_measure_cache;
+    std::map<Line*, Direction*, NodeOrder> earliest_direction_cache;
+    std::map<Angle*, Measure*, NodeOrder> earliest_measure_cache;
 
     /* Steps 1-5: Fetch the lca_lines of `p1p2`, `p3p4`, `p5p6` and `p7p8` */
     Line* common_root_12 = nullptr, *common_root_34 = nullptr, *common_root_56 = nullptr, *common_root_78 = nullptr;
-    std::map<Line*, PredSet> lca1s, lca2s, lca3s, lca4s;
+    std::map<Line*, PredSet, NodeOrder> lca1s, lca2s, lca3s, lca4s;
     std::tie(lca1s, common_root_12) = lca_lines_and_why(p1, p2, why_point_ancestor_cache, why_line_ancestor_cache);
     std::tie(lca2s, common_root_34) = lca_lines_and_why(p3, p4, why_point_ancestor_cache, why_line_ancestor_cache);
     std::tie(lca3s, common_root_56) = lca_lines_and_why(p5, p6, why_point_ancestor_cache, why_line_ancestor_cache);
@@ -1419,8 +1419,8 @@ PredSet TracebackEngine::why_eqangle(Point* p1, Point* p2, Point* p3, Point* p4,
     Direction* rd1 = common_root_12->get_direction(), *rd2 = common_root_34->get_direction(),
         *rd3 = common_root_56->get_direction(), *rd4 = common_root_78->get_direction();
 
-    std::set<std::pair<Direction*, Direction*>> dir_pairs_12 = angle_directions_root_map[{rd1, rd2}];
-    std::set<std::pair<Direction*, Direction*>> dir_pairs_34 = angle_directions_root_map[{rd3, rd4}];
+    std::set<std::pair<Direction*, Direction*>, NodeOrder> dir_pairs_12 = angle_directions_root_map[{rd1, rd2}];
+    std::set<std::pair<Direction*, Direction*>, NodeOrder> dir_pairs_34 = angle_directions_root_map[{rd3, rd4}];
 
     /* Now we check every possible quadruplet of `lca`s */
     for (const auto& [lca1, why_ancestor_lines_points_12] : lca1s) {
@@ -1571,18 +1571,18 @@ PredSet TracebackEngine::why_eqangle(Point* p1, Point* p2, Point* p3, Point* p4,
 
 PredSet TracebackEngine::why_eqratio(Point* p1, Point* p2, Point* p3, Point* p4, Point* p5, Point* p6, Point* p7, Point* p8) {
     PredSet res;
-    std::map<std::pair<Point*, Point*>, PredSet> why_point_ancestor_cache;
-    std::map<std::pair<Segment*, Segment*>, PredSet> why_segment_ancestor_cache;
-    std::map<std::pair<Length*, Length*>, PredSet> why_length_ancestor_cache;
-    std::map<std::pair<Ratio*, Ratio*>, PredSet> why_ratio_ancestor_cache;
-    std::map<std::pair<Fraction*, Fraction*>, PredSet> why_fraction_ancestor_cache;
+    std::map<std::pair<Point*, Point*>, PredSet, NodeOrder> why_point_ancestor_cache;
+    std::map<std::pair<Segment*, Segment*>, PredSet, NodeOrder> why_segment_ancestor_cache;
+    std::map<std::pair<Length*, Length*>, PredSet, NodeOrder> why_length_ancestor_cache;
+    std::map<std::pair<Ratio*, Ratio*>, PredSet, NodeOrder> why_ratio_ancestor_cache;
+    std::map<std::pair<Fraction*, Fraction*>, PredSet, NodeOrder> why_fraction_ancestor_cache;
 
-    std::map<Segment*, Length*> earliest_length_cache;
-    std::map<Ratio*, Fraction*> earliest_fraction_cache;
+    std::map<Segment*, Length*, NodeOrder> earliest_length_cache;
+    std::map<Ratio*, Fraction*, NodeOrder> earliest_fraction_cache;
 
     /* Steps 1-5: Fetch the lca_segments of `p1p2`, `p3p4`, `p5p6` and `p7p8` */
     Segment* common_root_12 = nullptr, *common_root_34 = nullptr, *common_root_56 = nullptr, *common_root_78 = nullptr;
-    std::map<Segment*, PredSet> lca1s, lca2s, lca3s, lca4s;
+    std::map<Segment*, PredSet, NodeOrder> lca1s, lca2s, lca3s, lca4s;
     std::tie(lca1s, common_root_12) = lca_segments_and_why(p1, p2, why_point_ancestor_cache, why_segment_ancestor_cache);
     std::tie(lca2s, common_root_34) = lca_segments_and_why(p3, p4, why_point_ancestor_cache, why_segment_ancestor_cache);
     std::tie(lca3s, common_root_56) = lca_segments_and_why(p5, p6, why_point_ancestor_cache, why_segment_ancestor_cache);
@@ -1591,8 +1591,8 @@ PredSet TracebackEngine::why_eqratio(Point* p1, Point* p2, Point* p3, Point* p4,
     Length* rl1 = common_root_12->get_length(), *rl2 = common_root_34->get_length(),
         *rl3 = common_root_56->get_length(), *rl4 = common_root_78->get_length();
 
-    std::set<std::pair<Length*, Length*>> length_pairs_12 = ratio_lengths_root_map[{rl1, rl2}];
-    std::set<std::pair<Length*, Length*>> length_pairs_34 = ratio_lengths_root_map[{rl3, rl4}];
+    std::set<std::pair<Length*, Length*>, NodeOrder> length_pairs_12 = ratio_lengths_root_map[{rl1, rl2}];
+    std::set<std::pair<Length*, Length*>, NodeOrder> length_pairs_34 = ratio_lengths_root_map[{rl3, rl4}];
 
     /* Now we check every possible quadruplet of `lca`s */
     for (const auto& [lca1, why_ancestor_segments_points_12] : lca1s) {
@@ -1849,12 +1849,12 @@ void TracebackEngine::populate_why(Predicate* pred) {
 }
 
 
-std::pair<std::map<int, std::set<Predicate*>>, bool> TracebackEngine::get_minimal_predset(DDEngine& dd) {
+std::pair<std::map<int, std::set<Predicate*, PredicateOrder>>, bool> TracebackEngine::get_minimal_predset(DDEngine& dd) {
     Predicate* conc = dd.conclusion.get();
     Predicate* base_pred = dd.base_pred.get();
 
     std::deque<Predicate*> to_visit{conc};
-    std::map<int, std::set<Predicate*>> all_preds{{conc->level, {conc}}};
+    std::map<int, std::set<Predicate*, PredicateOrder>> all_preds{{conc->get_level(), {conc}}};
 
     while (true) {
         Predicate* curr = to_visit.front();
@@ -1864,8 +1864,8 @@ std::pair<std::map<int, std::set<Predicate*>>, bool> TracebackEngine::get_minima
             populate_why(curr);
         }
 
-        for (Predicate* p : curr->why.preds) {
-            int i = p->level;
+        for (Predicate* p : curr->why) {
+            int i = p->get_level();
             if (!all_preds[i].contains(p)) {
                 all_preds[i].insert(p);
                 to_visit.push_back(p);
@@ -61,37 +61,37 @@ class DDEngine;
 class TracebackEngine {
 
 public:
-    std::map<Point*, std::map<Line*, PredSet>> point_on_lines;
-    std::map<Point*, std::map<Line*, std::pair<Point*, Line*>>> point_line_root_map;
-    std::map<Point*, std::map<Circle*, PredSet>> point_on_circles;
-    std::map<Point*, std::map<Circle*, std::pair<Point*, Circle*>>> point_circle_root_map;
-    std::map<Point*, std::map<Circle*, PredSet>> point_as_circle_center;
-    std::map<Point*, std::map<Circle*, std::pair<Point*, Circle*>>> point_circle_center_root_map;
-    std::map<Point*, std::map<Segment*, PredSet>> point_as_segment_endpoint;
-    std::map<Point*, std::map<Segment*, std::pair<Point*, Segment*>>> point_segment_endpoint_root_map;
-    std::map<Point*, std::map<Triangle*, PredSet>> point_as_triangle_vertex;
-    std::map<Point*, std::map<Triangle*, std::pair<Point*, Triangle*>>> point_triangle_vertex_root_map;
-
-    std::map<std::pair<Direction*, Direction*>, PredSet> perp_directions;
-    std::map<std::pair<Direction*, Direction*>, std::set<std::pair<Direction*, Direction*>>> perp_directions_root_map;
-
-    std::map<Direction*, std::map<Line*, PredSet>> direction_of_lines;
-    std::map<Direction*, std::map<Line*, std::pair<Direction*, Line*>>> direction_line_root_map;
-    std::map<Length*, std::map<Segment*, PredSet>> length_of_segments;
-    std::map<Length*, std::map<Segment*, std::pair<Length*, Segment*>>> length_segment_root_map;
-
-    std::map<std::pair<Direction*, Direction*>, Angle*> directions_of_angles;
-    std::map<std::pair<Direction*, Direction*>, std::set<std::pair<Direction*, Direction*>>> angle_directions_root_map;
-    std::map<std::pair<Length*, Length*>, Ratio*> lengths_of_ratios;
-    std::map<std::pair<Length*, Length*>, std::set<std::pair<Length*, Length*>>> ratio_lengths_root_map;
-
-    std::map<Measure*, std::map<Angle*, PredSet>> measure_of_angles;
-    std::map<Measure*, std::map<Angle*, std::pair<Measure*, Angle*>>> measure_angle_root_map;
-    std::map<Fraction*, std::map<Ratio*, PredSet>> fraction_of_ratios;
-    std::map<Fraction*, std::map<Ratio*, std::pair<Fraction*, Ratio*>>> fraction_ratio_root_map;
-
-    std::map<Measure*, std::pair<Frac, PredSet>> measure_vals;
-    std::map<Fraction*, std::pair<Frac, PredSet>> fraction_vals;
+    std::map<Point*, std::map<Line*, PredSet, NodeOrder>, NodeOrder> point_on_lines;
+    std::map<Point*, std::map<Line*, std::pair<Point*, Line*>, NodeOrder>, NodeOrder> point_line_root_map;
+    std::map<Point*, std::map<Circle*, PredSet, NodeOrder>, NodeOrder> point_on_circles;
+    std::map<Point*, std::map<Circle*, std::pair<Point*, Circle*>, NodeOrder>, NodeOrder> point_circle_root_map;
+    std::map<Point*, std::map<Circle*, PredSet, NodeOrder>, NodeOrder> point_as_circle_center;
+    std::map<Point*, std::map<Circle*, std::pair<Point*, Circle*>, NodeOrder>, NodeOrder> point_circle_center_root_map;
+    std::map<Point*, std::map<Segment*, PredSet, NodeOrder>, NodeOrder> point_as_segment_endpoint;
+    std::map<Point*, std::map<Segment*, std::pair<Point*, Segment*>, NodeOrder>, NodeOrder> point_segment_endpoint_root_map;
+    std::map<Point*, std::map<Triangle*, PredSet, NodeOrder>, NodeOrder> point_as_triangle_vertex;
+    std::map<Point*, std::map<Triangle*, std::pair<Point*, Triangle*>, NodeOrder>, NodeOrder> point_triangle_vertex_root_map;
+
+    std::map<std::pair<Direction*, Direction*>, PredSet, NodeOrder> perp_directions;
+    std::map<std::pair<Direction*, Direction*>, std::set<std::pair<Direction*, Direction*>, NodeOrder>, NodeOrder> perp_directions_root_map;
+
+    std::map<Direction*, std::map<Line*, PredSet, NodeOrder>, NodeOrder> direction_of_lines;
+    std::map<Direction*, std::map<Line*, std::pair<Direction*, Line*>, NodeOrder>, NodeOrder> direction_line_root_map;
+    std::map<Length*, std::map<Segment*, PredSet, NodeOrder>, NodeOrder> length_of_segments;
+    std::map<Length*, std::map<Segment*, std::pair<Length*, Segment*>, NodeOrder>, NodeOrder> length_segment_root_map;
+
+    std::map<std::pair<Direction*, Direction*>, Angle*, NodeOrder> directions_of_angles;
+    std::map<std::pair<Direction*, Direction*>, std::set<std::pair<Direction*, Direction*>, NodeOrder>, NodeOrder> angle_directions_root_map;
+    std::map<std::pair<Length*, Length*>, Ratio*, NodeOrder> lengths_of_ratios;
+    std::map<std::pair<Length*, Length*>, std::set<std::pair<Length*, Length*>, NodeOrder>, NodeOrder> ratio_lengths_root_map;
+
+    std::map<Measure*, std::map<Angle*, PredSet, NodeOrder>, NodeOrder> measure_of_angles;
+    std::map<Measure*, std::map<Angle*, std::pair<Measure*, Angle*>, NodeOrder>, NodeOrder> measure_angle_root_map;
+    std::map<Fraction*, std::map<Ratio*, PredSet, NodeOrder>, NodeOrder> fraction_of_ratios;
+    std::map<Fraction*, std::map<Ratio*, std::pair<Fraction*, Ratio*>, NodeOrder>, NodeOrder> fraction_ratio_root_map;
+
+    std::map<Measure*, std::pair<Frac, PredSet>, NodeOrder> measure_vals;
+    std::map<Fraction*, std::pair<Frac, PredSet>, NodeOrder> fraction_vals;
 
     void record_merge(Point* dest, Point* src);
     void record_merge(Line* dest, Line* src);
@@ -154,7 +154,7 @@ public:
     in `direction_line_root_map`.) */
     Direction* __earliest_direction_of(
         Line* l,
-        std::map<Line*, Direction*>& earliest_direction_cache
+        std::map<Line*, Direction*, NodeOrder>& earliest_direction_cache
     );
     /* Identifies the earliest known instance at which the segment `s`, or an ancestor of
     it, was assigned some length `len`. Returns this length `len`. (Thus, `len` is also
@@ -162,7 +162,7 @@ public:
     `length_segment_root_map`.) */
     Length* __earliest_length_of(
         Segment* s,
-        std::map<Segment*, Length*>& earliest_length_cache
+        std::map<Segment*, Length*, NodeOrder>& earliest_length_cache
     );
     
     /* Identifies the earliest known instance at which the angle `a`, or an ancestor of
@@ -170,14 +170,14 @@ public:
     angle `aa` at which `m` was assigned (as recorded in `measure_angle_root_map`). */
     std::pair<Angle*, Measure*> __earliest_measure_of(
         Angle* a,
-        std::map<Angle*, Measure*>& earliest_measure_cache
+        std::map<Angle*, Measure*, NodeOrder>& earliest_measure_cache
     );
     /* Identifies the earliest known instance at which the ratio `r`, or an ancestor of
     it, was assigned some fraction `f`. Returns this fraction `f` as well as the ancestor
     ratio `ra` at which `f` was assigned (as recorded in `fraction_ratio_root_map`). */
     std::pair<Ratio*, Fraction*> __earliest_fraction_of(
         Ratio* r,
-        std::map<Ratio*, Fraction*>& earliest_fraction_cache
+        std::map<Ratio*, Fraction*, NodeOrder>& earliest_fraction_cache
     );
 
 
@@ -191,10 +191,10 @@ public:
     - why_ancestor(l1, l)
     - why_ancestor(l2, l) 
     Only extracts Lines with Directions. */
-    std::tuple<std::map<Line*, PredSet>, Line*> lca_lines_and_why(
+    std::tuple<std::map<Line*, PredSet, NodeOrder>, Line*> lca_lines_and_why(
         Point* p1, Point* p2,
-        std::map<std::pair<Point*, Point*>, PredSet>& why_point_ancestor_cache,
-        std::map<std::pair<Line*, Line*>, PredSet>& why_line_ancestor_cache
+        std::map<std::pair<Point*, Point*>, PredSet, NodeOrder>& why_point_ancestor_cache,
+        std::map<std::pair<Line*, Line*>, PredSet, NodeOrder>& why_line_ancestor_cache
     );
     /* Given a pair of points `p1, p2`, identifies all LCA segments `s` containing a child 
     point `cp1` of `p1` as an endpoint, and `cp2` of `p2` as another; for each LCA segment,
@@ -207,10 +207,10 @@ public:
     - why_ancestor(s1, s)
     - why_ancestor(s2, s) 
     Only extracts Segments with Lengths. */
-    std::tuple<std::map<Segment*, PredSet>, Segment*> lca_segments_and_why(
+    std::tuple<std::map<Segment*, PredSet, NodeOrder>, Segment*> lca_segments_and_why(
         Point* p1, Point* p2,
-        std::map<std::pair<Point*, Point*>, PredSet>& why_point_ancestor_cache,
-        std::map<std::pair<Segment*, Segment*>, PredSet>& why_segment_ancestor_cache
+        std::map<std::pair<Point*, Point*>, PredSet, NodeOrder>& why_point_ancestor_cache,
+        std::map<std::pair<Segment*, Segment*>, PredSet, NodeOrder>& why_segment_ancestor_cache
     );
 
     
@@ -223,8 +223,8 @@ public:
     is the smallest possible. */
     std::pair<std::pair<Direction*, Line*>, PredSet> most_explainable_direction_of_line(
         Line* l, Direction* d,
-        std::map<std::pair<Direction*, Direction*>, PredSet>& why_direction_ancestor_cache,
-        std::map<std::pair<Line*, Line*>, PredSet>& why_line_ancestor_cache
+        std::map<std::pair<Direction*, Direction*>, PredSet, NodeOrder>& why_direction_ancestor_cache,
+        std::map<std::pair<Line*, Line*>, PredSet, NodeOrder>& why_line_ancestor_cache
     );
     /* Given a segment `s` and a length `len`, identifies the children `cs` and `clen` such
     that `cs` was assigned length `clen` (as recorded in `length_of_segments`), and the
@@ -235,8 +235,8 @@ public:
     is the smallest possible. */
     std::pair<std::pair<Length*, Segment*>, PredSet> most_explainable_length_of_segment(
         Segment* s, Length* len,
-        std::map<std::pair<Length*, Length*>, PredSet>& why_length_ancestor_cache,
-        std::map<std::pair<Segment*, Segment*>, PredSet>& why_segment_ancestor_cache
+        std::map<std::pair<Length*, Length*>, PredSet, NodeOrder>& why_length_ancestor_cache,
+        std::map<std::pair<Segment*, Segment*>, PredSet, NodeOrder>& why_segment_ancestor_cache
     );
 
 
@@ -249,8 +249,8 @@ public:
     is the smallest possible. */
     std::pair<std::pair<Measure*, Angle*>, PredSet> most_explainable_measure_of_angle(
         Angle* a, Measure* m,
-        std::map<std::pair<Measure*, Measure*>, PredSet>& why_measure_ancestor_cache,
-        std::map<std::pair<Angle*, Angle*>, PredSet>& why_angle_ancestor_cache
+        std::map<std::pair<Measure*, Measure*>, PredSet, NodeOrder>& why_measure_ancestor_cache,
+        std::map<std::pair<Angle*, Angle*>, PredSet, NodeOrder>& why_angle_ancestor_cache
     );
 
     /* Given a ratio `r` and a fraction `f`, identifies the children `cr` and `cf` such
@@ -262,8 +262,8 @@ public:
     is the smallest possible. */
     std::pair<std::pair<Fraction*, Ratio*>, PredSet> most_explainable_fraction_of_ratio(
         Ratio* r, Fraction* f,
-        std::map<std::pair<Fraction*, Fraction*>, PredSet>& why_fraction_ancestor_cache,
-        std::map<std::pair<Ratio*, Ratio*>, PredSet>& why_ratio_ancestor_cache
+        std::map<std::pair<Fraction*, Fraction*>, PredSet, NodeOrder>& why_fraction_ancestor_cache,
+        std::map<std::pair<Ratio*, Ratio*>, PredSet, NodeOrder>& why_ratio_ancestor_cache
     );
 
 
@@ -290,7 +290,7 @@ public:
     /* Fetch an approximately minimal set of predicates necessary to solve the problem.
     The predicate set is indexed by level and returned as `map<int, set<Predicate*>>`.
     Additionally, a `bool` is returned indicating whether the solution is complete.*/
-    std::pair<std::map<int, std::set<Predicate*>>, bool> get_minimal_predset(DDEngine& dd);
+    std::pair<std::map<int, std::set<Predicate*, PredicateOrder>>, bool> get_minimal_predset(DDEngine& dd);
 
 
     void reset_problem();
@@ -67,7 +67,8 @@ namespace TracebackUtils {
     template<std::derived_from<Node> T>
     PredSet why_ancestor(T* child, T* ancestor) {
         if (!child || !ancestor) return {};
-        PredSet res;
+        // Collected first and interned once, rather than growing the PredSet one predicate at a time
+        std::vector<Predicate*> res;
         while (child != ancestor) {
             if (child->is_root()) {
                 return {};
@@ -77,25 +78,25 @@ namespace TracebackUtils {
                 Predicate* pred = preds.front();
                 // Decompose all EQ predicates
                 if ((pred->name >= pred_t::EQ) && (pred->name < pred_t::LAST)) {
-                    for (Predicate* p_why : pred->why.preds) {
+                    for (Predicate* p_why : pred->why) {
                         if (p_why) preds.emplace_back(p_why);
                     }
                 } else {
-                    res += pred;
+                    res.emplace_back(pred);
                 }
                 preds.pop_front();
             }
             child = NodeUtils::get_parent(child);
         }
-        return res;
+        return PredSet(std::move(res));
     }
 
     template<std::derived_from<Node> T>
-    PredSet why_ancestor_with_cache(T* child, T* ancestor, std::map<std::pair<T*, T*>, PredSet> caches) {
-        if (caches.contains({child, ancestor})) {
-            return caches[{child, ancestor}];
+    PredSet why_ancestor_with_cache(T* child, T* ancestor, const std::map<std::pair<T*, T*>, PredSet, NodeOrder> &caches) {
+        if (auto it = caches.find({child, ancestor}); it != caches.end()) {
+            return it->second;
         }
-        PredSet res;
+        std::vector<Predicate*> res;
         while (child != ancestor) {
             if (child->is_root()) {
                 return {};
@@ -105,17 +106,17 @@ namespace TracebackUtils {
                 Predicate* pred = preds.front();
                 // Decompose all EQ predicates
                 if (pred->name >= pred_t::EQ && pred->name < pred_t::LAST) {
-                    for (Predicate* p_why : pred->why.preds) {
+                    for (Predicate* p_why : pred->why) {
                         if (p_why) preds.emplace_back(p_why);
                     }
                 } else {
-                    res += pred;
+                    res.emplace_back(pred);
                 }
                 preds.pop_front();
             }
             child = NodeUtils::get_parent(child);
         }
-        return res;
+        return PredSet(std::move(res));
     }
 
 
@@ -1,8 +1,45 @@
 #include <getopt.h>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <random>
 
 #include "GTPEngine.hh"
 
+/* Runs a single problem through the full pipeline on the given engine, then clears the engine
+so that it can be reused for the next problem. A problem that throws counts as unsolved, so that
+it does not bring down the rest of a batch. */
+bool solve_problem(GTPEngine& gtp, std::string input_filepath, std::string problem_name, std::string output_filepath) {
+    bool res = false;
+    try {
+        res = gtp.load_problem(
+            input_filepath,
+            problem_name,
+            output_filepath
+        )
+        && gtp.draw()
+        && gtp.solve(20)
+        && gtp.get_problem_solution();
+    } catch (const std::exception& e) {
+        std::cerr << "Error solving problem " << problem_name << ": " << e.what() << std::endl;
+    }
+
+    gtp.output_profiler_data();
+    gtp.clear_problem();
+    return res;
+}
+
+/* Appends the contents of a per-problem part file to the given stream, then deletes it. */
+void merge_part_file(std::ofstream& ofs, std::string part_filepath) {
+    std::ifstream ifs(part_filepath);
+    if (ifs.peek() != std::ifstream::traits_type::eof()) {
+        ofs << ifs.rdbuf();
+    }
+    ifs.close();
+    std::remove(part_filepath.c_str());
+}
+
 int main(int argc, char** argv) {
 
     // Parse input arguments
@@ -19,6 +56,11 @@ int main(int argc, char** argv) {
         {"construction_file", required_argument, 0, 'c'},
         {"output_file", required_argument, 0, 'o'},
         {"profiler_output_file", required_argument, 0, 'g'},
+        {"jobs", required_argument, 0, 'j'},
+        {"seed", required_argument, 0, 's'},
+        {"draws", required_argument, 0, 'd'},
+        {"dd_threads", required_argument, 0, 't'},
+        {"relevance_radius", required_argument, 0, 'R'},
         {0, 0, 0, 0}
     };
 
@@ -28,9 +70,11 @@ int main(int argc, char** argv) {
         construction_filepath="problems/constructions.txt", 
         output_filepath="",
         profiler_filepath="";
+    int jobs = 1, draws = 1, dd_threads = 1, relevance_radius = -1;
+    std::uint64_t seed = std::random_device{}();
 
     int opt, optindex;
-    while ( (opt = getopt_long(argc, argv, "f:p:r:c:o:g:", options, &optindex)) != -1 ) {
+    while ( (opt = getopt_long(argc, argv, "f:p:r:c:o:g:j:s:d:t:R:", options, &optindex)) != -1 ) {
         fprintf(stderr, "%s\n", optarg);
         switch(opt) {
             case 'f':
@@ -51,6 +95,21 @@ int main(int argc, char** argv) {
             case 'g':
                 profiler_filepath = std::string(optarg);
                 break;
+            case 'j':
+                jobs = std::max(1, std::atoi(optarg));
+                break;
+            case 's':
+                seed = std::stoull(optarg);
+                break;
+            case 'd':
+                draws = std::max(1, std::atoi(optarg));
+                break;
+            case 't':
+                dd_threads = std::max(1, std::atoi(optarg));
+                break;
+            case 'R':
+                relevance_radius = std::atoi(optarg);
+                break;
             default:
                 std::cerr << "Error: Invalid argument found!" << std::endl;
                 return 1;
@@ -63,44 +122,74 @@ int main(int argc, char** argv) {
     } else {
         std::cerr << "Inputs received!\n";
     }
-
-    GTPEngine gtp(
-        rule_filepath,
-        construction_filepath,
-        profiler_filepath
-    );
+    std::cout << "Using seed " << seed << std::endl;
 
     if (problem_name.empty()) {
-        // Iterate through every single problem in the input file
-        std::vector<std::string> problem_names = gtp.inputParser.extract_all_problem_names_from_file(input_filepath);
-        int total_problems = 0, solved_problems = 0;
+        // Iterate through every single problem in the input file. The rule and construction files
+        // are parsed once and shared (read-only) by the engines of all workers.
+        InputParser inputParser;
+        const std::vector<std::string> rules = inputParser.parse_rules_from_file(rule_filepath);
+        const auto constructions = inputParser.parse_constructions_from_file(construction_filepath);
+        std::vector<std::string> problem_names = inputParser.extract_all_problem_names_from_file(input_filepath);
+        int total_problems = problem_names.size(), solved_problems = 0;
         std::set<std::string> unsolved_problems;
+        jobs = std::max(1, std::min(jobs, total_problems));
 
         // Delete the output file if it exists
         std::ofstream ofs(output_filepath, std::ofstream::out | std::ofstream::trunc);
         ofs.close();
 
-        for (std::string problem_name : problem_names) {
+        // With more than one job, every problem writes to its own part files, which are merged
+        // back into the output and profiler files in input order once all workers are done.
+        auto part_filepath = [&](std::string filepath, int i) {
+            return (jobs == 1 || filepath.empty()) ? filepath : filepath + ".part" + std::to_string(i);
+        };
+
+        std::vector<char> results(total_problems, false);
+        std::atomic<int> next_problem = 0;
+        auto worker = [&]() {
+            GTPEngine gtp(rules, constructions, profiler_filepath);
+            gtp.seed = seed;
+            gtp.nm.num_draws = draws;
+            gtp.nm.num_jobs = jobs;
+            gtp.dd.num_threads = dd_threads;
+            gtp.dd.relevance_radius = relevance_radius;
+            for (int i; (i = next_problem++) < total_problems; ) {
+                gtp.profiler_filepath = part_filepath(profiler_filepath, i);
+                results[i] = solve_problem(
+                    gtp, 
+                    input_filepath, 
+                    problem_names[i], 
+                    part_filepath(output_filepath, i)
+                );
+            }
+        };
 
-            total_problems += 1;
+        std::vector<std::thread> workers;
+        for (int j = 1; j < jobs; j++) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& t : workers) {
+            t.join();
+        }
 
-            bool res = gtp.load_problem(
-                input_filepath,
-                problem_name,
-                output_filepath
-            )
-            && gtp.draw()
-            && gtp.solve(20)
-            && gtp.get_problem_solution();
+        if (jobs > 1) {
+            std::ofstream out_ofs(output_filepath, std::ios_base::app);
+            std::ofstream prof_ofs;
+            if (!profiler_filepath.empty()) prof_ofs.open(profiler_filepath, std::ios_base::app);
+            for (int i = 0; i < total_problems; i++) {
+                merge_part_file(out_ofs, part_filepath(output_filepath, i));
+                if (!profiler_filepath.empty()) merge_part_file(prof_ofs, part_filepath(profiler_filepath, i));
+            }
+        }
 
-            if (res) {
+        for (int i = 0; i < total_problems; i++) {
+            if (results[i]) {
                 solved_problems += 1;
             } else {
-                unsolved_problems.insert(problem_name);
+                unsolved_problems.insert(problem_names[i]);
             }
-
-            gtp.output_profiler_data();
-            gtp.clear_problem();
         }
 
         std::cout << "Solved " << solved_problems << " out of " << total_problems << " problems." << std::endl;
@@ -114,16 +203,15 @@ int main(int argc, char** argv) {
 
     } else {
         // Solve the specified problem
-        bool res = gtp.load_problem(
-            input_filepath,
-            problem_name,
-            output_filepath
-        )
-        && gtp.draw()
-        && gtp.solve(20)
-        && gtp.get_problem_solution();
-
-        gtp.output_profiler_data();
-        gtp.clear_problem();
+        GTPEngine gtp(
+            rule_filepath,
+            construction_filepath,
+            profiler_filepath
+        );
+        gtp.seed = seed;
+        gtp.nm.num_draws = draws;
+        gtp.dd.num_threads = dd_threads;
+        gtp.dd.relevance_radius = relevance_radius;
+        solve_problem(gtp, input_filepath, problem_name, output_filepath);
     }
 }
\ No newline at end of file
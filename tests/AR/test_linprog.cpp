@@ -123,4 +123,44 @@ TEST_SUITE("LinProg") {
             old_result = result;
         }
     }
+    /* Same matrix as the complex test case, but populated in two stages onto one LinProg.
+    The reused LinProg should agree with a freshly populated one. */
+    TEST_CASE("Reusing a LinProg after extending the matrix") {
+        LinProg lp;
+        SparseMatrix A(4, 0, 3);
+        A.extend_columns({{0, 1}, {1, -2}, {2, 1}});
+        A.extend_columns({{0, 1}, {2, 2}});
+        A.extend_columns({{2, 1}, {3, 1}});
+
+        std::vector<double> c = {1, 1, 1};
+        std::vector<double> b = {1, -2, 2, 1};
+        std::vector<double> result;
+
+        lp.populate(A, b, c);
+        CHECK(lp.solve(result));
+        CHECK(result == std::vector<double>{1, 0, 1});
+
+        A.extend_rows(1);
+        A.extend_columns({{1, 1}, {3, 1}, {4, -2}});
+        c.emplace_back(1);
+        b = {1, 0, 2, 3, -4};
+
+        SUBCASE("Extended LinProg matches a fresh one") {
+            lp.populate(A, b, c);
+            CHECK(lp.solve(result));
+
+            LinProg fresh_lp;
+            std::vector<double> fresh_result;
+            fresh_lp.populate(A, b, c);
+            CHECK(fresh_lp.solve(fresh_result));
+            CHECK(result == fresh_result);
+            CHECK(result == std::vector<double>{1, 0, 1, 2});
+        }
+        SUBCASE("Reset LinProg can be repopulated") {
+            lp.reset();
+            lp.populate(A, b, c);
+            CHECK(lp.solve(result));
+            CHECK(result == std::vector<double>{1, 0, 1, 2});
+        }
+    }
 }
\ No newline at end of file
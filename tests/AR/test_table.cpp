@@ -51,4 +51,45 @@ TEST_SUITE("Table") {
         }
         CHECK(g2 == g2_copy);
     }
-}
\ No newline at end of file
+
+    TEST_CASE("generate_all_eqs") {
+        // Adds the i-th batch of equalities to the table
+        auto add_batch = [](Table& t, int i) {
+            if (i == 0) {
+                t.add_eq_2(1, 2, 1, 1, nullptr);
+                t.add_eq_3(3, 4, 0.5f, 1, 2, nullptr);
+                t.add_eq_4(5, 6, 7, 8, nullptr);
+            } else {
+                t.add_eq_2(2, 3, 1, 1, nullptr);
+                t.add_eq_2(9, 10, 1, 1, nullptr);
+                t.add_eq_3(8, 10, 0.25f, 1, 4, nullptr);
+                t.add_eq_4(1, 9, 11, 12, nullptr);
+            }
+        };
+
+        // Equalities generated in between additions are the same as those of a fresh table
+        Table incremental;
+        add_batch(incremental, 0);
+        incremental.generate_all_eqs();
+        add_batch(incremental, 1);
+        incremental.generate_all_eqs();
+
+        Table fresh;
+        add_batch(fresh, 0);
+        add_batch(fresh, 1);
+        fresh.generate_all_eqs();
+
+        CHECK(incremental.eq_2s == fresh.eq_2s);
+        CHECK(incremental.eq_3s == fresh.eq_3s);
+        CHECK(incremental.eq_4s == fresh.eq_4s);
+        CHECK_FALSE(fresh.eq_2s.empty());
+        CHECK_FALSE(fresh.eq_3s.empty());
+        CHECK_FALSE(fresh.eq_4s.empty());
+
+        // Generating again without additions changes nothing
+        incremental.generate_all_eqs();
+        CHECK(incremental.eq_2s == fresh.eq_2s);
+        CHECK(incremental.eq_3s == fresh.eq_3s);
+        CHECK(incremental.eq_4s == fresh.eq_4s);
+    }
+}
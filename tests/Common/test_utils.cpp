@@ -2,6 +2,9 @@
 #include "doctest.h"
 
 #include "Common/Utils.hh"
+#include "Common/NumUtils.hh"
+#include "Geometry/Node.hh"
+#include "Geometry/Object.hh"
 
 TEST_SUITE("Utils") {
     TEST_CASE("Set intersection") {
@@ -29,4 +32,53 @@ TEST_SUITE("Utils") {
         CHECK(set1 == expected_union);
         CHECK(set2 == set2_copy);
     }
-}
\ No newline at end of file
+}
+
+TEST_SUITE("NumUtils") {
+    TEST_CASE("Seed mixing") {
+        CHECK(NumUtils::mix_seed(42, 0) == NumUtils::mix_seed(42, 0));
+        CHECK(NumUtils::mix_seed(42, 0) != NumUtils::mix_seed(42, 1));
+        CHECK(NumUtils::mix_seed(42, 0) != NumUtils::mix_seed(43, 0));
+        CHECK(NumUtils::mix_seed(42, "110-1") == NumUtils::mix_seed(42, "110-1"));
+        CHECK(NumUtils::mix_seed(42, "110-1") != NumUtils::mix_seed(42, "110-10"));
+
+        std::mt19937 gen1(NumUtils::mix_seed(7, "imo-2000-p1")), gen2(NumUtils::mix_seed(7, "imo-2000-p1"));
+        for (int i = 0; i < 10; i++) {
+            CHECK(NumUtils::urand(gen1, -1, 1) == NumUtils::urand(gen2, -1, 1));
+        }
+    }
+}
+TEST_SUITE("NodeUtils") {
+    TEST_CASE("Ordered tuples") {
+        std::vector<std::unique_ptr<Point>> pts;
+        std::set<Point*, NodeOrder> s;
+        for (std::string name : {"a", "b", "c", "d", "e"}) {
+            pts.emplace_back(std::make_unique<Point>(name));
+            s.insert(pts.back().get());
+        }
+
+        std::vector<std::pair<Point*, Point*>> pairs, pairs_gen;
+        for (auto [p1, p2] : NodeUtils::ordered_pairs(s)) pairs.push_back({p1, p2});
+        auto gen_pairs = NodeUtils::all_pairs_ordered(s);
+        while (gen_pairs) pairs_gen.push_back(gen_pairs());
+        CHECK(pairs.size() == 20);
+        CHECK(pairs == pairs_gen);
+
+        std::vector<std::tuple<Point*, Point*, Point*>> triples, triples_gen;
+        for (auto [p1, p2, p3] : NodeUtils::ordered_triples(s)) triples.push_back({p1, p2, p3});
+        auto gen_triples = NodeUtils::all_triples_ordered(s);
+        while (gen_triples) triples_gen.push_back(gen_triples());
+        CHECK(triples.size() == 60);
+        CHECK(triples == triples_gen);
+
+        std::vector<std::tuple<Point*, Point*, Point*, Point*>> quads, quads_gen;
+        for (auto [p1, p2, p3, p4] : NodeUtils::ordered_quads(s)) quads.push_back({p1, p2, p3, p4});
+        auto gen_quads = NodeUtils::all_quads_ordered(s);
+        while (gen_quads) quads_gen.push_back(gen_quads());
+        CHECK(quads.size() == 120);
+        CHECK(quads == quads_gen);
+
+        std::set<Point*, NodeOrder> small{pts[0].get(), pts[1].get()};
+        CHECK(NodeUtils::ordered_triples(small).begin() == NodeUtils::ordered_triples(small).end());
+    }
+}
@@ -0,0 +1,63 @@
+#include <doctest.h>
+
+#include "DD/DDEngine.hh"
+#include "DD/Theorem.hh"
+#include "Geometry/GeometricGraph.hh"
+
+TEST_SUITE("DDEngine: query planner") {
+    TEST_CASE("Join order and re-planning") {
+        GeometricGraph ggraph;
+        DDEngine dd;
+        AREngine ar;
+        TracebackEngine tr;
+        ggraph.tr = &tr;
+        Predicate* base_pred = dd.base_pred.get();
+
+        // Six collinear points, and no parallel lines
+        std::vector<Point*> ps;
+        for (int i = 0; i < 6; i++) {
+            ps.emplace_back(ggraph.__add_new_point(std::string(1, 'a' + i)));
+            ggraph.__set_point_numeric(ps.back(), {(double)i, 0});
+        }
+        ggraph.get_or_add_line(ps[0], ps[1], dd);
+        for (int i = 2; i < 6; i++) ggraph.__make_coll(ps[0], ps[1], ps[i], base_pred, dd, ar);
+
+        std::map<pred_t, double> candidates;
+        for (pred_t name : {pred_t::COLL, pred_t::PARA}) candidates[name] = dd.__count_candidates(name, ggraph);
+        REQUIRE(candidates[pred_t::COLL] == 6 * 5 * 4);
+        REQUIRE(candidates[pred_t::PARA] == 0);
+
+        Theorem thr("A B C D : coll A B C, para A B C D, diff A D => coll A B D");
+        DDEngine::JoinPlan plan = dd.__compile_theorem(&thr);
+        auto names = [](const std::vector<DDEngine::JoinStep>& steps) {
+            std::vector<pred_t> names;
+            for (const DDEngine::JoinStep& step : steps) names.push_back(step.pred_template->name);
+            return names;
+        };
+
+        SUBCASE("Without candidate counts the original order is kept") {
+            REQUIRE(names(plan.full) == std::vector<pred_t>{pred_t::COLL, pred_t::PARA, pred_t::DIFF});
+        }
+        SUBCASE("The precondition with fewer candidates is matched first") {
+            REQUIRE(DDEngine::__refresh_plans(plan, candidates));
+            // The diff is checked as soon as A and D are bound
+            REQUIRE(names(plan.full) == std::vector<pred_t>{pred_t::PARA, pred_t::DIFF, pred_t::COLL});
+            // The semi-naive plan pivoting on coll still matches it first
+            REQUIRE(plan.delta.size() == 2);
+            REQUIRE(names(plan.delta[0]) == std::vector<pred_t>{pred_t::COLL, pred_t::PARA, pred_t::DIFF});
+        }
+        SUBCASE("Plans are kept until the candidate counts drift by more than PLAN_REORDER_GAIN") {
+            REQUIRE(DDEngine::__refresh_plans(plan, candidates));
+            REQUIRE_FALSE(DDEngine::__refresh_plans(plan, candidates));
+            candidates[pred_t::PARA] = Constants::PLAN_REORDER_GAIN;
+            candidates[pred_t::COLL] *= 2;
+            REQUIRE_FALSE(DDEngine::__refresh_plans(plan, candidates));
+            REQUIRE(names(plan.full) == std::vector<pred_t>{pred_t::PARA, pred_t::DIFF, pred_t::COLL});
+
+            // Now coll is the precondition with fewer candidates
+            candidates[pred_t::PARA] = 1e6;
+            REQUIRE(DDEngine::__refresh_plans(plan, candidates));
+            REQUIRE(names(plan.full) == std::vector<pred_t>{pred_t::COLL, pred_t::PARA, pred_t::DIFF});
+        }
+    }
+}
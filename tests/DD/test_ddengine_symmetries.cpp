@@ -0,0 +1,61 @@
+#include <doctest.h>
+
+#include "DD/DDEngine.hh"
+#include "DD/Theorem.hh"
+#include "Geometry/GeometricGraph.hh"
+
+TEST_SUITE("DDEngine: theorem symmetries") {
+    TEST_CASE("Symmetries of predicate arguments") {
+        CHECK(DDEngine::__arg_symmetries(pred_t::COLL, 3).size() == 6);
+        CHECK(DDEngine::__arg_symmetries(pred_t::MIDP, 3) == std::vector<std::vector<int>>{{0, 1, 2}, {0, 2, 1}});
+        CHECK(DDEngine::__arg_symmetries(pred_t::PARA, 4).size() == 8);
+        CHECK(DDEngine::__arg_symmetries(pred_t::EQRATIO, 8).size() == 32);
+        // Predicates without known symmetries only have the identity
+        CHECK(DDEngine::__arg_symmetries(pred_t::CONSTANGLE, 5) == std::vector<std::vector<int>>{{0, 1, 2, 3, 4}});
+    }
+
+    TEST_CASE("Symmetries of theorems") {
+        // B and C can be swapped
+        Theorem thr1("A B C : para A B A C, diff B C => coll A B C");
+        CHECK(DDEngine::__theorem_symmetries(&thr1) == std::vector<std::vector<int>>{{0, 2, 1}});
+
+        Theorem thr2("A B C : midp A B C => cong A B A C");
+        CHECK(DDEngine::__theorem_symmetries(&thr2) == std::vector<std::vector<int>>{{0, 2, 1}});
+
+        // A and B can be swapped, but C and D are only symmetric in the first precondition
+        Theorem thr3("A B C D : para A B C D, coll A B C => coll A B D");
+        CHECK(DDEngine::__theorem_symmetries(&thr3) == std::vector<std::vector<int>>{{1, 0, 2, 3}});
+
+        Theorem thr4("A B C D : para A B C D, perp A B A C => perp C D A C");
+        CHECK(DDEngine::__theorem_symmetries(&thr4).empty());
+
+        // The two triangles can be swapped, but their vertices cannot be permuted independently
+        Theorem thr5("A B C P Q R : simtri A B C P Q R => eqratio A B A C P Q P R");
+        CHECK(DDEngine::__theorem_symmetries(&thr5) == std::vector<std::vector<int>>{{3, 4, 5, 0, 1, 2}});
+    }
+
+    TEST_CASE("Bindings breaking a symmetry") {
+        GeometricGraph ggraph;
+        Point* a = ggraph.__add_new_point("a");
+        Point* b = ggraph.__add_new_point("b");
+        Point* c = ggraph.__add_new_point("c");
+
+        Theorem thr("A B C : para A B A C, diff B C => coll A B C");
+        auto symmetries = DDEngine::__theorem_symmetries(&thr);
+
+        // Partial bindings cannot be told apart yet
+        thr.args[0]->set(a);
+        CHECK_FALSE(DDEngine::__breaks_symmetry(&thr, symmetries));
+        thr.args[1]->set(c);
+        CHECK_FALSE(DDEngine::__breaks_symmetry(&thr, symmetries));
+
+        // Of the bindings (a, b, c) and (a, c, b), only the least by point id is kept
+        thr.args[2]->set(b);
+        CHECK(DDEngine::__breaks_symmetry(&thr, symmetries));
+        thr.__clear_args();
+        thr.args[0]->set(a);
+        thr.args[1]->set(b);
+        thr.args[2]->set(c);
+        CHECK_FALSE(DDEngine::__breaks_symmetry(&thr, symmetries));
+    }
+}
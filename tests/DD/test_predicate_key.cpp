@@ -0,0 +1,66 @@
+#include <doctest.h>
+
+#include "DD/Predicate.hh"
+#include "Geometry/GeometricGraph.hh"
+
+TEST_SUITE("PredKey") {
+    TEST_CASE("Canonical argument order") {
+        GeometricGraph ggraph;
+        Point* a = ggraph.__add_new_point("a");
+        Point* b = ggraph.__add_new_point("b");
+        Point* c = ggraph.__add_new_point("c");
+        Point* d = ggraph.__add_new_point("d");
+        Point* e = ggraph.__add_new_point("e");
+        Point* f = ggraph.__add_new_point("f");
+        Point* g = ggraph.__add_new_point("g");
+        Point* h = ggraph.__add_new_point("h");
+
+        auto key = [](pred_t name, std::vector<Node*> nodes, Frac fr = Frac()) {
+            return PredKey(name, nodes.data(), nodes.size(), fr);
+        };
+
+        SUBCASE("Symmetries share a key") {
+            CHECK(key(pred_t::COLL, {a, b, c}) == key(pred_t::COLL, {c, a, b}));
+            CHECK(key(pred_t::CYCLIC, {a, b, c, d}) == key(pred_t::CYCLIC, {d, c, b, a}));
+            CHECK(key(pred_t::DIFF, {a, b}) == key(pred_t::DIFF, {b, a}));
+            CHECK(key(pred_t::NCOLL, {a, b, c}) == key(pred_t::NCOLL, {b, c, a}));
+            CHECK(key(pred_t::CIRCLE, {a, b, c, d}) == key(pred_t::CIRCLE, {a, d, c, b}));
+            CHECK(key(pred_t::MIDP, {a, b, c}) == key(pred_t::MIDP, {a, c, b}));
+            for (pred_t name : {pred_t::PARA, pred_t::PERP, pred_t::CONG, pred_t::NPARA, pred_t::NPERP, pred_t::NCONG}) {
+                CHECK(key(name, {a, b, c, d}) == key(name, {b, a, c, d}));
+                CHECK(key(name, {a, b, c, d}) == key(name, {a, b, d, c}));
+                CHECK(key(name, {a, b, c, d}) == key(name, {d, c, b, a}));
+            }
+            for (pred_t name : {pred_t::EQANGLE, pred_t::EQRATIO}) {
+                CHECK(key(name, {a, b, c, d, e, f, g, h}) == key(name, {b, a, d, c, f, e, h, g}));
+                CHECK(key(name, {a, b, c, d, e, f, g, h}) == key(name, {e, f, g, h, a, b, c, d}));
+                CHECK(key(name, {a, b, c, d, e, f, g, h}) == key(name, {f, e, g, h, b, a, d, c}));
+            }
+            CHECK(key(pred_t::CONSTANGLE, {a, b, c, d}, Frac(1, 3)) == key(pred_t::CONSTANGLE, {b, a, d, c}, Frac(1, 3)));
+            CHECK(key(pred_t::CONSTRATIO, {a, b, c, d}, Frac(2)) == key(pred_t::CONSTRATIO, {b, a, c, d}, Frac(2)));
+            for (pred_t name : {pred_t::CONTRI, pred_t::SIMTRI}) {
+                CHECK(key(name, {a, b, c, d, e, f}) == key(name, {d, e, f, a, b, c}));
+            }
+        }
+
+        SUBCASE("Other permutations have different keys") {
+            CHECK_FALSE(key(pred_t::CIRCLE, {a, b, c, d}) == key(pred_t::CIRCLE, {b, a, c, d}));
+            CHECK_FALSE(key(pred_t::MIDP, {a, b, c}) == key(pred_t::MIDP, {b, a, c}));
+            for (pred_t name : {pred_t::PARA, pred_t::PERP, pred_t::CONG}) {
+                CHECK_FALSE(key(name, {a, b, c, d}) == key(name, {a, c, b, d}));
+            }
+            for (pred_t name : {pred_t::EQANGLE, pred_t::EQRATIO}) {
+                CHECK_FALSE(key(name, {a, b, c, d, e, f, g, h}) == key(name, {a, b, g, h, e, f, c, d}));
+                CHECK_FALSE(key(name, {a, b, c, d, e, f, g, h}) == key(name, {a, b, e, f, c, d, g, h}));
+            }
+            // The two lines of a constangle are ordered, and so are the two segments of a constratio
+            CHECK_FALSE(key(pred_t::CONSTANGLE, {a, b, c, d}, Frac(1, 3)) == key(pred_t::CONSTANGLE, {c, d, a, b}, Frac(1, 3)));
+            CHECK_FALSE(key(pred_t::CONSTRATIO, {a, b, c, d}, Frac(2)) == key(pred_t::CONSTRATIO, {c, d, a, b}, Frac(2)));
+            CHECK_FALSE(key(pred_t::CONSTANGLE, {a, b, c, d}, Frac(1, 3)) == key(pred_t::CONSTANGLE, {a, b, c, d}, Frac(2, 3)));
+            for (pred_t name : {pred_t::CONTRI, pred_t::SIMTRI}) {
+                CHECK_FALSE(key(name, {a, b, c, d, e, f}) == key(name, {a, b, c, d, f, e}));
+            }
+            CHECK_FALSE(key(pred_t::COLL, {a, b, c}) == key(pred_t::NCOLL, {a, b, c}));
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#include <doctest.h>
+
+#include "DD/Predicate.hh"
+
+TEST_SUITE("PredSetPool") {
+    TEST_CASE("Interning and eviction") {
+        PredSetPool pool;
+        pool.activate();
+        Predicate p1, p2, p3;
+
+        PredSet a{&p1, &p2};
+        PredSet b{&p2, &p1, &p2};
+        CHECK(a == b);
+        CHECK(pool.size() == 1);
+
+        {
+            PredSet d(&p3);
+            PredSet c = a + d;
+            CHECK(c.size() == 3);
+            CHECK(pool.size() == 3);
+        }
+        // Sets no PredSet holds anymore are evicted
+        CHECK(pool.size() == 1);
+
+        a = PredSet();
+        b = PredSet();
+        CHECK(pool.size() == 0);
+        pool.deactivate();
+    }
+
+    TEST_CASE("Levels are cached per pool") {
+        PredSetPool pool, other;
+        Predicate p1, p2;
+        p1.set_level(1);
+        p2.set_level(2);
+
+        pool.activate();
+        PredSet a{&p1, &p2};
+        CHECK(a.level() == 2);
+        CHECK(a.lsum() == 3);
+
+        // Setting a level under another pool keeps the level cached under this one
+        other.activate();
+        p2.set_level(5);
+        pool.activate();
+        CHECK(a.level() == 2);
+        other.activate();
+        CHECK(a.level() == 5);
+        pool.activate();
+        PredSet::invalidate_levels();
+        CHECK(a.level() == 5);
+        CHECK(a.lsum() == 6);
+
+        a.set_level(3);
+        CHECK(p2.get_level() == 3);
+        CHECK(a.level() == 3);
+        // Setting a level under the current pool invalidates its cached levels
+        p1.set_level(0);
+        CHECK(a.lsum() == 3);
+        pool.deactivate();
+    }
+}
@@ -0,0 +1,57 @@
+#include <doctest.h>
+#include <iostream>
+
+#include "Geometry/GeometricGraph.hh"
+#include "Common/Exceptions.hh"
+#include "Geometry/Node.hh"
+
+TEST_SUITE("GeometricGraph: Change tracking") {
+    TEST_CASE("Collecting changed nodes") {
+        GeometricGraph ggraph;
+        DDEngine dd;
+        AREngine ar;
+        TracebackEngine tr;
+        ggraph.tr = &tr;
+        Predicate* base_pred = dd.base_pred.get();
+
+        Point* a = ggraph.__add_new_point("a");
+        Point* b = ggraph.__add_new_point("b");
+        Point* c = ggraph.__add_new_point("c");
+        Point* d = ggraph.__add_new_point("d");
+        ggraph.__set_point_numeric(a, {0, 0});
+        ggraph.__set_point_numeric(b, {1, 0});
+        ggraph.__set_point_numeric(c, {0, 1});
+        ggraph.__set_point_numeric(d, {1, 1});
+
+        Line* ab = ggraph.get_or_add_line(a, b, dd);
+        Line* cd = ggraph.get_or_add_line(c, d, dd);
+        ggraph.collect_changes();
+
+        SUBCASE("New nodes are collected") {
+            auto &s = ggraph.delta_lines;
+            REQUIRE((s.size() == 2 && s.contains(ab) && s.contains(cd)));
+            REQUIRE(ggraph.delta_directions.empty());
+        }
+        SUBCASE("Changes are cleared once collected") {
+            ggraph.collect_changes();
+            REQUIRE(ggraph.delta_lines.empty());
+            REQUIRE(ggraph.delta_directions.empty());
+        }
+        SUBCASE("Changes propagate to root nodes only") {
+            ggraph.__make_para(a, b, c, d, base_pred, dd, ar);
+            ggraph.collect_changes();
+
+            REQUIRE(ggraph.delta_lines.empty());
+            auto &s = ggraph.delta_directions;
+            REQUIRE((s.size() == 1 && s.contains(ab->get_direction()) && s.contains(cd->get_direction())));
+        }
+        SUBCASE("Merged points mark their lines") {
+            ggraph.__set_point_numeric(d, {1, 0});
+            ggraph.merge_points(b, d, base_pred, dd, ar);
+            ggraph.collect_changes();
+
+            auto &s = ggraph.delta_lines;
+            REQUIRE((s.size() == 2 && s.contains(NodeUtils::get_root(ab)) && s.contains(NodeUtils::get_root(cd))));
+        }
+    }
+}
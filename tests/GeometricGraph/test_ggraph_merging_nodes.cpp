@@ -598,5 +598,45 @@ TEST_SUITE("GeometricGraph: Node merging") {
         }
     }
 
+    TEST_CASE("Union-find roots") {
+        GeometricGraph ggraph;
+        DDEngine dd;
+        Predicate* base_pred = dd.base_pred.get();
+
+        Point* a = ggraph.__add_new_point("a");
+        Point* b = ggraph.__add_new_point("b");
+        Point* c = ggraph.__add_new_point("c");
+        Point* d = ggraph.__add_new_point("d");
+        Point* e = ggraph.__add_new_point("e");
+
+        a->merge(b, base_pred);
+        c->merge(d, base_pred);
+        a->merge(c, base_pred);
+        Node* big = Node::find(a);
+        REQUIRE(big->rank == 2);
+        REQUIRE(e->rank == 0);
+
+        // Merging the higher-rank set into the lower-rank one keeps the union-find root of the higher-rank
+        // set, but the explanation root is the node merged into
+        e->merge(a, base_pred);
+        CHECK(Node::find(e) == big);
+        CHECK(big->leader == e);
+        for (Point* p : {a, b, c, d, e}) {
+            CHECK(NodeUtils::get_root(p) == e);
+            CHECK(p->root == e);
+        }
+        CHECK(e->is_root());
+        CHECK_FALSE(a->is_root());
+
+        // Parent chains used by traceback are those of the merges
+        CHECK(e->parent == nullptr);
+        CHECK(a->parent == e);
+        CHECK(b->parent == a);
+        CHECK(c->parent == a);
+        CHECK(d->parent == c);
+        CHECK(e->children == std::vector<Node*>{a});
+        CHECK(a->children == std::vector<Node*>{b, c});
+    }
+
     // Triangle congruence and similarity tests in `test_ggraph_triangles.cpp`
 }
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include <doctest.h>
+
+#include <vector>
+
+#include "Geometry/GeometricGraph.hh"
+#include "Common/Exceptions.hh"
+#include "Geometry/Node.hh"
+
+TEST_SUITE("GeometricGraph: Node storage") {
+    TEST_CASE("NodeArena") {
+        NodeArena<Point> points;
+        Point* a = points.emplace("a");
+        Point* b = points.emplace("b");
+        Point* c = points.emplace("c");
+
+        SUBCASE("Nodes are numbered densely in creation order") {
+            REQUIRE((a->id == 0 && b->id == 1 && c->id == 2));
+            REQUIRE(points.size() == 3);
+            REQUIRE((points[0] == a && points[1] == b && points[2] == c));
+        }
+        SUBCASE("Nodes can be looked up by name") {
+            REQUIRE((points.contains("b") && points.find("b") == b));
+            REQUIRE((!points.contains("d") && points.find("d") == nullptr));
+        }
+        SUBCASE("Clearing releases nodes and names") {
+            points.clear();
+            REQUIRE(points.size() == 0);
+            REQUIRE(!points.contains("a"));
+            Point* d = points.emplace("d");
+            REQUIRE((d->id == 0 && points.find("d") == d));
+        }
+    }
+
+    TEST_CASE("NodeSet") {
+        NodeArena<Point> points;
+        std::vector<Point*> ps;
+        for (std::string name : {"a", "b", "c", "d", "e"}) {
+            ps.emplace_back(points.emplace(name));
+        }
+        NodeSet<Point> s;
+
+        SUBCASE("Insertion, erasure and membership") {
+            REQUIRE(s.empty());
+            REQUIRE(s.insert(ps[3]));
+            REQUIRE(s.insert(ps[1]));
+            REQUIRE(!s.insert(ps[3]));
+            REQUIRE((s.size() == 2 && s.contains(ps[1]) && s.contains(ps[3]) && !s.contains(ps[0])));
+            REQUIRE(s.erase(ps[3]) == 1);
+            REQUIRE(s.erase(ps[3]) == 0);
+            REQUIRE((s.size() == 1 && !s.contains(ps[3])));
+            // Nodes past the end of the slots are not members
+            REQUIRE(!s.contains(ps[4]));
+        }
+        SUBCASE("Iteration visits nodes in id order") {
+            for (int i : {4, 0, 2}) s.insert(ps[i]);
+            std::vector<Point*> visited(s.begin(), s.end());
+            REQUIRE(visited == std::vector<Point*>{ps[0], ps[2], ps[4]});
+        }
+        SUBCASE("Nodes inserted during iteration with a larger id are visited") {
+            s.insert(ps[0]);
+            std::vector<Point*> visited;
+            for (Point* p : s) {
+                visited.emplace_back(p);
+                if (p == ps[0]) s.insert(ps[3]);
+                if (p == ps[3]) s.erase(ps[0]);
+            }
+            REQUIRE(visited == std::vector<Point*>{ps[0], ps[3]});
+            REQUIRE((s.size() == 1 && s.contains(ps[3])));
+        }
+    }
+
+    TEST_CASE("NodeOrder") {
+        NodeArena<Point> points;
+        Point* b = points.emplace("b");
+        Point* a = points.emplace("a");
+        std::set<Point*, NodeOrder> s{a, b, nullptr};
+        REQUIRE(std::vector<Point*>(s.begin(), s.end()) == std::vector<Point*>{nullptr, b, a});
+        std::set<std::pair<Point*, Point*>, NodeOrder> pairs{{a, b}, {b, a}, {b, b}};
+        REQUIRE(*pairs.begin() == std::make_pair(b, b));
+        REQUIRE(*pairs.rbegin() == std::make_pair(a, b));
+    }
+
+    TEST_CASE("Nodes with the same name are rejected") {
+        GeometricGraph ggraph;
+        DDEngine dd;
+        TracebackEngine tr;
+        ggraph.tr = &tr;
+        Predicate* base_pred = dd.base_pred.get();
+
+        Point* a = ggraph.__add_new_point("a");
+        Point* b = ggraph.__add_new_point("b");
+        ggraph.__set_point_numeric(a, {0, 0});
+        ggraph.__set_point_numeric(b, {1, 0});
+
+        REQUIRE_THROWS_AS(ggraph.__add_new_point("a"), GGraphInternalError);
+
+        Line* ab = ggraph.__add_new_line(a, b, base_pred);
+        REQUIRE(ggraph.lines.find("l_a_b") == ab);
+        REQUIRE_THROWS_AS(ggraph.__add_new_line(b, a, base_pred), GGraphInternalError);
+        REQUIRE(ggraph.lines.size() == 1);
+
+        Direction* d_ab = ggraph.__add_new_direction(ab, base_pred);
+        REQUIRE(ggraph.directions.find("d_l_a_b") == d_ab);
+        REQUIRE_THROWS_AS(ggraph.__add_new_direction(ab, base_pred), GGraphInternalError);
+    }
+}
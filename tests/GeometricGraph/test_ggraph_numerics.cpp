@@ -0,0 +1,128 @@
+#include <doctest.h>
+#include <limits>
+
+#include "Geometry/GeometricGraph.hh"
+
+TEST_SUITE("GeometricGraph: Point numerics") {
+    TEST_CASE("Finding equal points") {
+        GeometricGraph ggraph;
+        Point* a = ggraph.__add_new_point("a", {-2e-10, 1});
+        Point* b = ggraph.__add_new_point("b", {2e-10, 1});
+        Point* c = ggraph.__add_new_point("c", {1 - 3e-10, 1 + 3e-10});
+        Point* d = ggraph.__add_new_point("d", {1 + 3e-10, 1 - 3e-10});
+        Point* e = ggraph.__add_new_point("e", {5e-9, 1});
+        PointNumerics& nums = ggraph.point_nums;
+
+        SUBCASE("Points within TOL of each other in different cells") {
+            CHECK(nums.find_equal(nums.at(a)) == std::vector<Point*>{a, b});
+            CHECK(nums.find_equal(nums.at(b)) == std::vector<Point*>{a, b});
+            CHECK(nums.find_equal(nums.at(c)) == std::vector<Point*>{c, d});
+            CHECK(nums.find_equal(nums.at(e)) == std::vector<Point*>{e});
+            CHECK(nums.find_equal({0, 0}).empty());
+        }
+
+        SUBCASE("Moving a point") {
+            ggraph.__set_point_numeric(e, {1, 1});
+            CHECK(nums.find_equal(nums.at(a)) == std::vector<Point*>{a, b});
+            CHECK(nums.find_equal({1, 1}) == std::vector<Point*>{c, d, e});
+            CHECK(nums.find_equal({5e-9, 1}).empty());
+        }
+
+        SUBCASE("Points off the grid") {
+            Point* f = ggraph.__add_new_point("f", {3e10, 1});
+            Point* g = ggraph.__add_new_point("g", {-1e300, 1e300});
+            Point* h = ggraph.__add_new_point("h", {std::numeric_limits<double>::quiet_NaN(), 0});
+            CHECK(nums.find_equal({3e10, 1}) == std::vector<Point*>{f});
+            CHECK(nums.find_equal({-1e300, 1e300}) == std::vector<Point*>{g});
+            CHECK(nums.find_equal(nums.at(h)).empty());
+            CHECK(nums.find_equal(nums.at(a)) == std::vector<Point*>{a, b});
+
+            // Points leave the fallback scan when they move onto the grid
+            ggraph.__set_point_numeric(f, {0, 1});
+            CHECK(nums.find_equal({3e10, 1}).empty());
+            CHECK(nums.find_equal({0, 1}) == std::vector<Point*>{a, b, f});
+        }
+    }
+
+    TEST_CASE("Memoised checks on point triples") {
+        GeometricGraph ggraph;
+        std::vector<Point*> pts = {
+            ggraph.__add_new_point("a", {0, 0}),
+            ggraph.__add_new_point("b", {1, 0}),
+            ggraph.__add_new_point("c", {2, 0}),
+            ggraph.__add_new_point("d", {0, 1}),
+            ggraph.__add_new_point("e", {1, 1}),
+            ggraph.__add_new_point("f", {-1, 3}),
+            ggraph.__add_new_point("g", {0.5, -2})
+        };
+        ggraph.point_triples.reset(ggraph.points.size());
+        PointNumerics& nums = ggraph.point_nums;
+
+        SUBCASE("Cached results are those of the direct checks") {
+            bool all_pass = true;
+            Point *a = pts[0], *b = pts[4], *c = pts[6];
+            bool abc = Cartesian::orientation_of(nums.at(a), nums.at(b), nums.at(c));
+            // Every check is made twice, once filling the table and once reading from it
+            for (int pass = 0; pass < 2; pass++) {
+                for (Point* x : pts) for (Point* y : pts) for (Point* z : pts) {
+                    if (x == y || y == z || x == z) continue;
+                    bool xyz = Cartesian::orientation_of(nums.at(x), nums.at(y), nums.at(z));
+                    all_pass = all_pass 
+                        && ggraph.num_check_coll(x, y, z) == Cartesian::is_coll(nums.at(x), nums.at(y), nums.at(z))
+                        && ggraph.num_check_sameside(x, y, z) == Cartesian::acute_angle(nums.at(x), nums.at(y), nums.at(z))
+                        && ggraph.check_same_orientation(a, b, c, x, y, z) == (abc == xyz);
+                }
+            }
+            CHECK(all_pass);
+            CHECK(ggraph.num_check_coll(pts[0], pts[1], pts[2]));
+            CHECK_FALSE(ggraph.num_check_coll(pts[0], pts[1], pts[3]));
+        }
+
+        SUBCASE("Points outside the table are checked directly") {
+            PointTripleTable table;
+            int computed = 0;
+            auto compute = [&]() { computed++; return true; };
+
+            table.reset(3);
+            CHECK(table.get(pts[0], pts[1], pts[2], PointTripleTable::COLL, compute));
+            CHECK(table.get(pts[0], pts[1], pts[2], PointTripleTable::COLL, compute));
+            CHECK(computed == 1);
+            // Different kinds of checks are memoised separately
+            table.get(pts[0], pts[1], pts[2], PointTripleTable::ACUTE, compute);
+            CHECK(computed == 2);
+            // `pts[3]` has an id beyond the table
+            table.get(pts[0], pts[1], pts[3], PointTripleTable::COLL, compute);
+            table.get(pts[0], pts[1], pts[3], PointTripleTable::COLL, compute);
+            CHECK(computed == 4);
+
+            // Tables for more than `MAX_POINTS` points are not allocated
+            computed = 0;
+            table.reset(PointTripleTable::MAX_POINTS + 1);
+            table.get(pts[0], pts[1], pts[2], PointTripleTable::COLL, compute);
+            table.get(pts[0], pts[1], pts[2], PointTripleTable::COLL, compute);
+            CHECK(computed == 2);
+
+            // Points with ids of at least `MAX_POINTS` are always checked directly
+            Point* far = nullptr;
+            for (std::size_t i = ggraph.points.size(); i <= PointTripleTable::MAX_POINTS; i++) {
+                far = ggraph.__add_new_point("p" + std::to_string(i), {0, 0});
+            }
+            REQUIRE(far->id >= PointTripleTable::MAX_POINTS);
+            computed = 0;
+            table.reset(PointTripleTable::MAX_POINTS);
+            table.get(pts[0], pts[1], far, PointTripleTable::COLL, compute);
+            table.get(pts[0], pts[1], far, PointTripleTable::COLL, compute);
+            table.get(pts[0], pts[1], pts[2], PointTripleTable::COLL, compute);
+            table.get(pts[0], pts[1], pts[2], PointTripleTable::COLL, compute);
+            CHECK(computed == 3);
+        }
+
+        SUBCASE("Moving a point clears the table") {
+            Point *a = pts[0], *b = pts[1], *c = pts[2];
+            CHECK(ggraph.num_check_coll(a, b, c));
+            ggraph.__set_point_numeric(c, {2, 1});
+            CHECK_FALSE(ggraph.num_check_coll(a, b, c));
+            CHECK(ggraph.num_check_sameside(c, a, b) == Cartesian::acute_angle(nums.at(c), nums.at(a), nums.at(b)));
+        }
+    }
+}
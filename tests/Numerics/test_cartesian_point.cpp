@@ -161,7 +161,8 @@ TEST_SUITE("CartesianPoint") {
         double ang_dab = Cartesian::angle_between(d, a, b);
         std::array<double, 4> angles = {ang_abc, ang_bcd, ang_cda, ang_dab};
 
-        Cartesian::random_affine(a, b, c, d);
+        std::mt19937 gen;
+        Cartesian::random_affine(gen, a, b, c, d);
         double ab2 = Cartesian::distance(a, b);
         double bc2 = Cartesian::distance(b, c);
         double cd2 = Cartesian::distance(c, d);
@@ -204,5 +205,28 @@ TEST_SUITE("CartesianPoint") {
         CHECK(Cartesian::acute_angle(a, c, e));
         CHECK_FALSE(Cartesian::acute_angle(c, a, e));
     }
-}
 
+    TEST_CASE("Batch kernels") {
+        CartesianPoint p1(0, 0);
+        CartesianPoint p2(1, 1);
+        std::vector<CartesianPoint> pts = {
+            {2, 2}, {2, 2 + 1e-5}, {-3.5, -3.5}, {1, 0}, {1 + 1e-10, 1 - 1e-10}, {0, 0}, {5, 5}
+        };
+        std::vector<double> xs, ys;
+        for (auto& p : pts) {
+            xs.emplace_back(p.x);
+            ys.emplace_back(p.y);
+        }
+        std::vector<std::uint8_t> coll(pts.size()), same(pts.size());
+        Cartesian::batch_is_coll(xs.data(), ys.data(), pts.size(), p1, p2, coll.data());
+        Cartesian::batch_is_same(xs.data(), ys.data(), pts.size(), p2, same.data());
+        for (std::size_t i = 0; i < pts.size(); i++) {
+            CHECK(bool(coll[i]) == Cartesian::is_coll(p1, p2, pts[i]));
+            CHECK(bool(same[i]) == (pts[i] == p2));
+        }
+        CHECK(coll[0]);
+        CHECK_FALSE(coll[1]);
+        CHECK(same[4]);
+        CHECK_FALSE(same[0]);
+    }
+}
@@ -42,8 +42,9 @@ TEST_SUITE("CartesianRay") {
         CartesianPoint head(4.0, 4.0);
         CartesianRay r(start, head);
 
+        std::mt19937 gen;
         for (int i = 0; i < 10; ++i) {
-            double rand = NumUtils::urand(0.0, 10.0);
+            double rand = NumUtils::urand(gen, 0.0, 10.0);
             CartesianPoint p = Cartesian::get_random_point_on_ray(r, rand, {0,0}, 10.0);
             CHECK(r.contains(p));
             CHECK((p.x > 1 && p.y > 1));
@@ -140,8 +141,9 @@ TEST_SUITE("CartesianRay") {
 
         SUBCASE("Counterclockwise addition of vectors; Convex polygon") {
             std::array<CartesianPoint, 12> pts;
+            std::mt19937 gen;
             for (int i=0; i<10; i++) {
-                double e = NumUtils::urand(0, 0.05);
+                double e = NumUtils::urand(gen, 0, 0.05);
                 double angle = i * M_PI / 5 + e;
                 pts[i] = Cartesian::from_polar(1.0, angle);
             }
@@ -2,6 +2,7 @@
 #include <doctest.h>
 #include <memory>
 #include <iostream>
+#include <thread>
 
 #include "Common/NumUtils.hh"
 #include "Numerics/Cartesian.hh"
@@ -694,4 +695,34 @@ TEST_SUITE("NumEngine Computation") {
                 inst.point_to_coords[k].empty() && inst.point_to_coords[l].empty()));
         }
     }
+
+    TEST_CASE("Drawing instances") {
+        std::map<std::string, std::unique_ptr<Point>> point_map;
+        for (char pt_ = 'a'; pt_ <= 'd'; pt_++) {
+            std::string pt(1, pt_);
+            point_map[pt] = std::make_unique<Point>(pt);
+        }
+        int hw_threads = std::max(1u, std::thread::hardware_concurrency());
+
+        // D cannot be the midpoint of both AB and AC, so no draw is valid and all of them are made
+        auto draw = [&](int num_jobs) {
+            NumEngine ne;
+            ne.seed = 42;
+            ne.num_draws = 8;
+            ne.num_jobs = num_jobs;
+            ne.insert_numeric(std::make_unique<Numeric>("a b c = triangle", point_map));
+            ne.insert_numeric(std::make_unique<Numeric>("d = midpoint a b", point_map));
+            ne.insert_numeric(std::make_unique<Numeric>("d = midpoint a c", point_map));
+            CHECK_FALSE(ne.first_draw());
+            CHECK(ne.instances.size() == 8);
+            return std::make_pair(ne.final_inst.loss, ne.get_cartesian(point_map["a"].get()));
+        };
+
+        // With as many jobs as hardware threads, the draws are made one by one on the calling thread
+        auto [single_loss, single_a] = draw(hw_threads);
+        auto [loss, a] = draw(1);
+        CHECK(std::isfinite(single_loss));
+        CHECK(loss == single_loss);
+        CHECK(a == single_a);
+    }
 }
\ No newline at end of file
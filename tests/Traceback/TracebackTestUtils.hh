@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+#include "Geometry/GeometricGraph.hh"
+#include "DD/DDEngine.hh"
+
+/* Fetches a derived predicate and lists its points in the order given by `pred_string`. Permutations of a
+predicate share a key, so the derived predicate may list its points in another order. */
+inline Predicate* force_order(DDEngine& dd, GeometricGraph& ggraph, std::string pred_string) {
+    Predicate* pred = dd.get_predicate(pred_string, ggraph.points_by_name);
+    pred->rewrite_args(Predicate::from_global_point_map(pred_string, ggraph.points_by_name)->args);
+    return pred;
+}
@@ -3,6 +3,7 @@
 
 #include "Geometry/GeometricGraph.hh"
 #include "Traceback/TracebackEngine.hh"
+#include "Traceback/TracebackTestUtils.hh"
 
 TEST_SUITE("TracebackEngine: why_() functions") {
     TEST_CASE("why_cong() and why_midp()") {
@@ -137,10 +138,10 @@ TEST_SUITE("TracebackEngine: why_() functions") {
         ));
 
         ar.derive(ggraph, dd, profiler);
-        dd.recent_predicates.emplace_front(dd.predicates["cong f g g h"].get());
+        dd.recent_predicates.emplace_front(force_order(dd, ggraph, "cong f g g h"));
         ggraph.synthesise_ar_preds(dd);
         // 8 predicates get synthesised, including some eqratios and constratios
-        preds.emplace_back(dd.predicates["cong f g g h"].get());
+        preds.emplace_back(dd.get_predicate("cong f g g h", ggraph.points_by_name));
 
         /*
         4 - cong F H G I
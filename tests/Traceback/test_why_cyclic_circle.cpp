@@ -162,8 +162,8 @@ TEST_SUITE("TracebackEngine: why_() functions") {
             abcdhij->get_center() == w
         ));
 
-        Predicate* diff_a_b = dd.predicates["diff a b"].get();
-        Predicate* diff_b_d = dd.predicates["diff b d"].get();
+        Predicate* diff_a_b = dd.get_predicate("diff a b", ggraph.points_by_name);
+        Predicate* diff_b_d = dd.get_predicate("diff b d", ggraph.points_by_name);
 
         PredSet why_on_i_bhd = tr.why_on(i, bhd);
         REQUIRE((
@@ -327,8 +327,8 @@ TEST_SUITE("TracebackEngine: why_() functions") {
             NodeUtils::get_root(x) == center
         ));
 
-        Predicate* diff_b_i = dd.predicates["diff b i"].get();
-        Predicate* diff_f_i = dd.predicates["diff f i"].get();
+        Predicate* diff_b_i = dd.get_predicate("diff b i", ggraph.points_by_name);
+        Predicate* diff_f_i = dd.get_predicate("diff f i", ggraph.points_by_name);
 
         PredSet why_eq_y_x = TracebackUtils::why_ancestor(x, y);
         REQUIRE((
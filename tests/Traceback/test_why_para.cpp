@@ -3,6 +3,7 @@
 
 #include "Geometry/GeometricGraph.hh"
 #include "Traceback/TracebackEngine.hh"
+#include "Traceback/TracebackTestUtils.hh"
 
 TEST_SUITE("TracebackEngine: why_() functions") {
     TEST_CASE("why_para()") {
@@ -120,10 +121,10 @@ TEST_SUITE("TracebackEngine: why_() functions") {
             (dd.recent_predicates[0]->to_string() == "coll h g k")
         ));
         // We "hack" the system to force coll H K G
-        dd.recent_predicates.emplace_front(dd.predicates["coll h k g"].get());
+        dd.recent_predicates.emplace_front(force_order(dd, ggraph, "coll h k g"));
         REQUIRE(ggraph.synthesise_preds(dd, ar) == 1);
 
-        preds.emplace_back(dd.predicates["coll h k g"].get());
+        preds.emplace_back(dd.get_predicate("coll h k g", ggraph.points_by_name));
 
         preds.emplace_back(dd.insert_new_predicate(
             std::make_unique<Predicate>(
@@ -140,10 +141,10 @@ TEST_SUITE("TracebackEngine: why_() functions") {
             (dd.recent_predicates[0]->to_string() == "coll i g j")
         ));
         // We "hack" the system to force coll I J H
-        dd.recent_predicates.emplace_front(dd.predicates["coll i j h"].get());
+        dd.recent_predicates.emplace_front(force_order(dd, ggraph, "coll i j h"));
         REQUIRE(ggraph.synthesise_preds(dd, ar) == 1);
 
-        preds.emplace_back(dd.predicates["coll i j h"].get());
+        preds.emplace_back(dd.get_predicate("coll i j h", ggraph.points_by_name));
 
         Line* ghij = NodeUtils::get_root(gh);
         Direction* dir2 = ghij->get_direction();    // dir2 == d_ij
@@ -217,20 +218,18 @@ TEST_SUITE("TracebackEngine: why_() functions") {
         ggraph.synthesise_preds(dd, ar);
 
         dd.search(ggraph, profiler);  // apply para M L M N => coll M N L and para O L O P => coll O L P
+        // Both orders of each coll share a key, so there are only two recent predicates
         REQUIRE((
-            (dd.recent_predicates[0]->to_string() == "coll m n l" || dd.recent_predicates[1]->to_string() == "coll m n l") ||
-            (dd.recent_predicates[2]->to_string() == "coll m n l" || dd.recent_predicates[3]->to_string() == "coll m n l")
-        ));
-        REQUIRE((
-            (dd.recent_predicates[0]->to_string() == "coll o p l" || dd.recent_predicates[1]->to_string() == "coll o p l") ||
-            (dd.recent_predicates[2]->to_string() == "coll o p l" || dd.recent_predicates[3]->to_string() == "coll o p l")
+            dd.recent_predicates.size() == 2 &&
+            std::ranges::find(dd.recent_predicates, dd.get_predicate("coll m n l", ggraph.points_by_name)) != dd.recent_predicates.end() &&
+            std::ranges::find(dd.recent_predicates, dd.get_predicate("coll o p l", ggraph.points_by_name)) != dd.recent_predicates.end()
         ));
         // We "hack" the system to force coll M N L and coll O P L to be synthesised in this order
-        dd.recent_predicates.emplace_front(dd.predicates["coll o p l"].get());
-        dd.recent_predicates.emplace_front(dd.predicates["coll m n l"].get());    // extract the correct coll predicates
+        dd.recent_predicates.emplace_front(force_order(dd, ggraph, "coll o p l"));
+        dd.recent_predicates.emplace_front(force_order(dd, ggraph, "coll m n l"));    // extract the correct coll predicates
         REQUIRE(ggraph.synthesise_preds(dd, ar) == 2);
-        preds.emplace_back(dd.predicates["coll m n l"].get());
-        preds.emplace_back(dd.predicates["coll o p l"].get());
+        preds.emplace_back(dd.get_predicate("coll m n l", ggraph.points_by_name));
+        preds.emplace_back(dd.get_predicate("coll o p l", ggraph.points_by_name));
 
         preds.emplace_back(dd.insert_new_predicate(
             std::make_unique<Predicate>(
@@ -280,24 +279,24 @@ TEST_SUITE("TracebackEngine: why_() functions") {
         Whichever line gets merged into RT first will take priority in tr.direction_line_root_map.
         For example, if RT <- QT first, then { QT, d } will appear in the root_map. */
         REQUIRE((
-            std::ranges::find(dd.recent_predicates, dd.predicates["coll l o n"].get()) != dd.recent_predicates.end() &&
-            std::ranges::find(dd.recent_predicates, dd.predicates["coll r s q"].get()) != dd.recent_predicates.end() &&
-            std::ranges::find(dd.recent_predicates, dd.predicates["coll s r t"].get()) != dd.recent_predicates.end()
+            std::ranges::find(dd.recent_predicates, dd.get_predicate("coll l o n", ggraph.points_by_name)) != dd.recent_predicates.end() &&
+            std::ranges::find(dd.recent_predicates, dd.get_predicate("coll r s q", ggraph.points_by_name)) != dd.recent_predicates.end() &&
+            std::ranges::find(dd.recent_predicates, dd.get_predicate("coll s r t", ggraph.points_by_name)) != dd.recent_predicates.end()
         ));
-        dd.recent_predicates.emplace_front(dd.predicates["coll s r t"].get());
-        dd.recent_predicates.emplace_front(dd.predicates["coll r s q"].get());
-        dd.recent_predicates.emplace_front(dd.predicates["coll l o n"].get());
+        dd.recent_predicates.emplace_front(force_order(dd, ggraph, "coll s r t"));
+        dd.recent_predicates.emplace_front(force_order(dd, ggraph, "coll r s q"));
+        dd.recent_predicates.emplace_front(force_order(dd, ggraph, "coll l o n"));
         REQUIRE(ggraph.synthesise_preds(dd, ar) == 3);
-        preds.emplace_back(dd.predicates["coll l o n"].get());
-        preds.emplace_back(dd.predicates["coll r s q"].get());
-        preds.emplace_back(dd.predicates["coll s r t"].get());
+        preds.emplace_back(dd.get_predicate("coll l o n", ggraph.points_by_name));
+        preds.emplace_back(dd.get_predicate("coll r s q", ggraph.points_by_name));
+        preds.emplace_back(dd.get_predicate("coll s r t", ggraph.points_by_name));
 
         dd.search(ggraph, profiler);
         REQUIRE(ggraph.synthesise_preds(dd, ar) == 0);
 
-        Predicate* diff_t_q = dd.predicates["diff t q"].get();
+        Predicate* diff_t_q = dd.get_predicate("diff t q", ggraph.points_by_name);
         if (!diff_t_q) {
-            diff_t_q = dd.predicates["diff q t"].get();
+            diff_t_q = dd.get_predicate("diff q t", ggraph.points_by_name);
         }
 
         /* 
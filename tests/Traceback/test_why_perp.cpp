@@ -3,6 +3,7 @@
 
 #include "Geometry/GeometricGraph.hh"
 #include "Traceback/TracebackEngine.hh"
+#include "Traceback/TracebackTestUtils.hh"
 
 TEST_SUITE("TracebackEngine: why_() functions") {
     TEST_CASE("why_perp()") {
@@ -95,11 +96,11 @@ TEST_SUITE("TracebackEngine: why_() functions") {
         dd.search(ggraph, profiler);  // apply para C D C E => coll C D E and para F I F J => coll F I J
         
         // We "hack" the system to force coll C E D and coll F I J
-        dd.recent_predicates.emplace_front(dd.predicates["coll f i j"].get());
-        dd.recent_predicates.emplace_front(dd.predicates["coll c e d"].get());
+        dd.recent_predicates.emplace_front(force_order(dd, ggraph, "coll f i j"));
+        dd.recent_predicates.emplace_front(force_order(dd, ggraph, "coll c e d"));
         REQUIRE(ggraph.synthesise_preds(dd, ar) == 2);
-        preds.emplace_back(dd.predicates["coll c e d"].get());
-        preds.emplace_back(dd.predicates["coll f i j"].get());
+        preds.emplace_back(dd.get_predicate("coll c e d", ggraph.points_by_name));
+        preds.emplace_back(dd.get_predicate("coll f i j", ggraph.points_by_name));
 
         /*
         2 - para A B C E
@@ -196,9 +197,9 @@ TEST_SUITE("TracebackEngine: why_() functions") {
         dd.search(ggraph, profiler);  // apply para D K D G => coll D K G
 
         // We "hack" the system to force coll D K G
-        dd.recent_predicates.emplace_front(dd.predicates["coll d k g"].get());
+        dd.recent_predicates.emplace_front(force_order(dd, ggraph, "coll d k g"));
         REQUIRE(ggraph.synthesise_preds(dd, ar) == 1);
-        preds.emplace_back(dd.predicates["coll d k g"].get());
+        preds.emplace_back(dd.get_predicate("coll d k g", ggraph.points_by_name));
 
         REQUIRE((
             NodeUtils::same_as(dk, gm) &&
@@ -1,6 +1,2 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
-#include "doctest.h"
-#include <random>
-
-std::random_device rd = std::random_device();
-std::mt19937 gen(rd());
\ No newline at end of file
+#include "doctest.h"
\ No newline at end of file